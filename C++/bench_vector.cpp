@@ -0,0 +1,352 @@
+// Benchmarks for Vector and SmallVector. Build with optimizations, for example
+//   g++ -std=c++20 -O2 bench_vector.cpp -o bench_vector
+// and run ./bench_vector [name-filter] to run only the benchmarks whose name contains the filter.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "vector.cpp"
+#include "small_vector.cpp"
+#include "shared_pointer/shared_pointer.hpp"
+
+namespace {
+
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs body(iterations) until it takes at least 0.2 s and prints the time per operation.
+// ops_per_iteration and bytes_per_iteration turn the timing into per-op and GB/s figures.
+template <typename Body>
+void Measure(const char* name, size_t ops_per_iteration, size_t bytes_per_iteration, Body body) {
+  using Clock = std::chrono::steady_clock;
+  size_t iterations = 1;
+  double seconds = 0;
+  while (true) {
+    auto start = Clock::now();
+    body(iterations);
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds >= 0.2 || iterations >= (size_t(1) << 40)) break;
+    iterations *= seconds < 0.02 ? 10 : 2;
+  }
+  double ops = static_cast<double>(iterations) * ops_per_iteration;
+  std::printf("%-48s %12.2f ns/op", name, seconds * 1e9 / ops);
+  if (bytes_per_iteration != 0)
+    std::printf(" %10.2f GB/s", static_cast<double>(iterations) * bytes_per_iteration / seconds / 1e9);
+  std::printf("\n");
+}
+
+std::mt19937_64& Rng() {
+  static std::mt19937_64 rng(42);
+  return rng;
+}
+
+std::string RandomText(size_t size) {
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::string text(size, ' ');
+  for (auto& symbol : text) symbol = static_cast<char>(letter(Rng()));
+  return text;
+}
+
+// The same element without the IsTriviallyRelocatable opt-in (and not trivially copyable even
+// for int): Vector moves it element by element.
+template <typename T>
+struct Unmarked {
+  T value;
+
+  Unmarked(const T& v) : value(v) {}
+  Unmarked(const Unmarked&) = default;
+  Unmarked(Unmarked&& other) noexcept : value(std::move(other.value)) {}
+  ~Unmarked() {}
+};
+
+// Growth cost: a million push_backs from empty, and a vector of 100000 elements relocated twice
+// (Reserve to twice the size, then ShrinkToFit back), small enough to stay in cache.
+template <typename T>
+void MeasureGrowth(const char* type, const T& prototype) {
+  const size_t kCount = 1'000'000;
+  char name[64];
+  std::snprintf(name, sizeof(name), "vector/push/%s/Vector", type);
+  Measure(name, kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<T> values;
+      for (size_t i = 0; i < kCount; ++i) values.PushBack(prototype);
+      DoNotOptimize(values.Data());
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/push/%s/Vector-unmarked", type);
+  Measure(name, kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<Unmarked<T>> values;
+      for (size_t i = 0; i < kCount; ++i) values.PushBack(Unmarked<T> {prototype});
+      DoNotOptimize(values.Data());
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/push/%s/std::vector", type);
+  Measure(name, kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::vector<T> values;
+      for (size_t i = 0; i < kCount; ++i) values.push_back(prototype);
+      DoNotOptimize(values.data());
+    }
+  });
+
+  const size_t kRelocated = 100'000;
+  Vector<T> vector(kRelocated, prototype);
+  Vector<Unmarked<T>> unmarked(kRelocated, Unmarked<T> {prototype});
+  std::vector<T> standard(kRelocated, prototype);
+  std::snprintf(name, sizeof(name), "vector/relocate/%s/Vector", type);
+  Measure(name, 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      vector.Reserve(2 * kRelocated);
+      vector.ShrinkToFit();
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/relocate/%s/Vector-unmarked", type);
+  Measure(name, 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      unmarked.Reserve(2 * kRelocated);
+      unmarked.ShrinkToFit();
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/relocate/%s/std::vector", type);
+  Measure(name, 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      standard.reserve(2 * kRelocated);
+      standard.shrink_to_fit();
+    }
+  });
+}
+
+// std::string is not marked trivially relocatable, so its Vector row moves element by element like
+// the unmarked one; bench_str vector measures String, which opts in.
+void BenchVector() {
+  MeasureGrowth<int>("int", 42);
+  MeasureGrowth<std::string>("std::string", std::string("not inline: longer than fifteen"));
+  MeasureGrowth<SharedPtr<int>>("SharedPtr", SharedPtr<int>(new int(42)));
+}
+
+// Standard algorithms over the iterators of Vector and of std::vector; with contiguous iterators
+// both should compile to the same pointer loops.
+template <typename Container>
+void MeasureAlgorithms(const char* container, const std::vector<int>& source) {
+  const size_t size = source.size();
+  Container values(source.begin(), source.end());
+  Container sorted(source.begin(), source.end());
+  std::sort(sorted.begin(), sorted.end());
+  Container out(source.begin(), source.end());
+  char name[64];
+
+  std::snprintf(name, sizeof(name), "vector/algo/sort/%s", container);
+  Measure(name, size, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::copy(values.begin(), values.end(), out.begin());
+      std::sort(out.begin(), out.end());
+      DoNotOptimize(out[0]);
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/algo/copy/%s", container);
+  Measure(name, size, size * sizeof(int), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::copy(values.begin(), values.end(), out.begin());
+      DoNotOptimize(out[0]);
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/algo/lower_bound/%s", container);
+  Measure(name, size, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t found = 0;
+      for (int value : values) found += std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin();
+      DoNotOptimize(found);
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/algo/reduce/%s", container);
+  Measure(name, size, size * sizeof(int), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(std::reduce(values.begin(), values.end(), int64_t(0)));
+  });
+  std::snprintf(name, sizeof(name), "vector/algo/ranges::count/%s", container);
+  Measure(name, size, size * sizeof(int), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(std::ranges::count(values, 12345));
+  });
+}
+
+void BenchVectorAlgorithms() {
+  std::vector<int> source(1 << 20);
+  for (auto& value : source) value = static_cast<int>(Rng()() % 1'000'000);
+  MeasureAlgorithms<Vector<int>>("Vector", source);
+  MeasureAlgorithms<std::vector<int>>("std::vector", source);
+}
+
+// Ingests batches of a source into one container: element by element, with one range call per
+// batch, and with std::vector::insert.
+template <typename T>
+void MeasureBatches(const char* type, const std::vector<T>& batch) {
+  const size_t kBatches = 1024;
+  const size_t size = batch.size();
+  char name[64];
+  std::snprintf(name, sizeof(name), "vector/batch/%s/PushBack", type);
+  Measure(name, kBatches * size, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<T> values;
+      for (size_t b = 0; b < kBatches; ++b)
+        for (const T& value : batch) values.PushBack(value);
+      DoNotOptimize(values.Data());
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/batch/%s/Append", type);
+  Measure(name, kBatches * size, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<T> values;
+      for (size_t b = 0; b < kBatches; ++b) values.Append(batch);
+      DoNotOptimize(values.Data());
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/batch/%s/std::vector", type);
+  Measure(name, kBatches * size, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::vector<T> values;
+      for (size_t b = 0; b < kBatches; ++b) values.insert(values.end(), batch.begin(), batch.end());
+      DoNotOptimize(values.data());
+    }
+  });
+
+  // A batch inserted at the front of 64K elements and erased again: every element moves twice.
+  const size_t kResident = 1 << 16;
+  Vector<T> vector;
+  std::vector<T> standard;
+  vector.Reserve(kResident + size);
+  standard.reserve(kResident + size);
+  vector.Insert(vector.end(), kResident, batch[0]);
+  standard.insert(standard.end(), kResident, batch[0]);
+  std::snprintf(name, sizeof(name), "vector/batch/%s/Insert-front", type);
+  Measure(name, kResident, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      vector.Insert(vector.begin(), batch.begin(), batch.end());
+      vector.Erase(vector.begin(), vector.begin() + size);
+    }
+  });
+  std::snprintf(name, sizeof(name), "vector/batch/%s/std::vector-front", type);
+  Measure(name, kResident, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      standard.insert(standard.begin(), batch.begin(), batch.end());
+      standard.erase(standard.begin(), standard.begin() + size);
+    }
+  });
+}
+
+void BenchVectorBatches() {
+  std::vector<int> numbers(1000);
+  for (auto& value : numbers) value = static_cast<int>(Rng()());
+  MeasureBatches<int>("int", numbers);
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < 1000; ++i) strings.push_back(RandomText(8 + i % 32));
+  MeasureBatches<std::string>("std::string", strings);
+}
+
+// One request: many short-lived vectors, each filled element by element, read and dropped.
+template <typename Container, typename... Alloc>
+int64_t HandleVectorRequest(const std::vector<uint32_t>& lengths, const Alloc&... alloc) {
+  int64_t total = 0;
+  for (uint32_t length : lengths) {
+    Container values(alloc...);
+    for (uint32_t i = 0; i < length; ++i) values.PushBack(static_cast<int>(i * length));
+    for (int value : values) total += value;
+  }
+  return total;
+}
+
+// std::vector spelled the way HandleVectorRequest fills it.
+template <typename T>
+struct StdPmrVector : std::pmr::vector<T> {
+  using std::pmr::vector<T>::vector;
+  void PushBack(const T& value) { this->push_back(value); }
+};
+
+void BenchVectorArena() {
+  const size_t kVectors = 1000;
+  std::vector<uint32_t> lengths(kVectors);
+  std::uniform_int_distribution<uint32_t> length(1, 64);
+  for (auto& value : lengths) value = length(Rng());
+
+  Measure("vector/arena/request/Vector-global-heap", kVectors, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(HandleVectorRequest<Vector<int>>(lengths));
+  });
+  Measure("vector/arena/request/PmrVector-new_delete", kVectors, 0, [&](size_t n) {
+    std::pmr::polymorphic_allocator<int> alloc(std::pmr::new_delete_resource());
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(HandleVectorRequest<PmrVector<int>>(lengths, alloc));
+  });
+  // The arena buffer is reused from request to request; dropping the arena is the only free.
+  static char buffer[1 << 20];
+  Measure("vector/arena/request/PmrVector-monotonic", kVectors, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+      std::pmr::polymorphic_allocator<int> alloc(&arena);
+      DoNotOptimize(HandleVectorRequest<PmrVector<int>>(lengths, alloc));
+    }
+  });
+  Measure("vector/arena/request/std::pmr::vector-monotonic", kVectors, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+      std::pmr::polymorphic_allocator<int> alloc(&arena);
+      DoNotOptimize(HandleVectorRequest<StdPmrVector<int>>(lengths, alloc));
+    }
+  });
+}
+
+// A short-lived collection per request: fill it with count fields, read them and drop it.
+template <typename Container>
+size_t CollectFields(const std::vector<std::string_view>& fields, size_t count) {
+  Container collected;
+  for (size_t i = 0; i < count; ++i) collected.PushBack(fields[i]);
+  size_t total = 0;
+  for (std::string_view field : collected) total += field.size();
+  return total;
+}
+
+void BenchSmallVector() {
+  std::vector<std::string> texts;
+  std::vector<std::string_view> fields;
+  for (size_t i = 0; i < 16; ++i) texts.push_back(RandomText(4 + i));
+  for (const auto& text : texts) fields.push_back(text);
+
+  for (size_t count : {size_t(1), size_t(4), size_t(8), size_t(16)}) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "small-vector/%zu/Vector", count);
+    Measure(name, 1, 0, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(CollectFields<Vector<std::string_view>>(fields, count));
+    });
+    std::snprintf(name, sizeof(name), "small-vector/%zu/SmallVector<8>", count);
+    Measure(name, 1, 0, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(CollectFields<SmallVector<std::string_view, 8>>(fields, count));
+    });
+  }
+}
+
+struct Benchmark {
+  const char* name;
+  void (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+    {"vector", BenchVector},
+    {"vector-algo", BenchVectorAlgorithms},
+    {"vector-batch", BenchVectorBatches},
+    {"vector-arena", BenchVectorArena},
+    {"small-vector", BenchSmallVector},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  for (const auto& benchmark : kBenchmarks)
+    if (std::strstr(benchmark.name, filter) != nullptr) benchmark.run();
+  return 0;
+}
@@ -202,4 +202,14 @@ public:
             cptr = nullptr;
         }
     }
-};
\ No newline at end of file
+};
+
+// Declared with Vector (../vector.cpp).
+template <typename T>
+struct IsTriviallyRelocatable;
+
+// Both hold only a pointer to the control block, so Vector moves them with memcpy.
+template <typename T>
+struct IsTriviallyRelocatable<SharedPtr<T>> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable<WeakPtr<T>> : std::true_type {};
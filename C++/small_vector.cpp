@@ -0,0 +1,394 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector.cpp"
+
+// Vector with room for N elements inside the object: a SmallVector that never holds more than N
+// elements never touches the heap. Past N it moves its elements to a heap buffer and from then on
+// grows like Vector. The interface is that of Vector, range operations included, except that the
+// heap buffers always come from std::allocator: there is no allocator parameter.
+// Unlike with Vector, moving a SmallVector whose elements are inline moves them one by one, and
+// iterators and references are invalidated by a move or Swap of the container.
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+    T* data = InlineData();
+    size_t size = 0;
+    size_t capacity = N;
+    alignas(T) unsigned char storage[N * sizeof(T)];
+
+public:
+    using ValueType = T;
+    using Pointer = T*;
+    using ConstPointer = const T*;
+    using Reference = T&;
+    using ConstReference = const T&;
+    using SizeType = size_t;
+
+    template <bool IsConst>
+    using UniversalIterator = vector_detail::ContiguousIterator<T, IsConst>;
+
+    using Iterator = UniversalIterator<false>;
+    using ConstIterator = UniversalIterator<true>;
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+    using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+    static constexpr size_t InlineCapacity = N;
+
+    ConstIterator begin() const { return ConstIterator(data); }
+    ConstIterator end() const { return ConstIterator(data + size); }
+    Iterator begin() { return Iterator(data); }
+    Iterator end() { return Iterator(data + size); }
+    ConstIterator cbegin() const { return ConstIterator(data); }
+    ConstIterator cend() const { return ConstIterator(data + size); }
+
+    ConstReverseIterator rbegin() const { return ConstReverseIterator(end()); }
+    ConstReverseIterator rend() const { return ConstReverseIterator(begin()); }
+    ReverseIterator rbegin() { return ReverseIterator(end()); }
+    ReverseIterator rend() { return ReverseIterator(begin()); }
+    ConstReverseIterator crbegin() const { return ConstReverseIterator(end()); }
+    ConstReverseIterator crend() const { return ConstReverseIterator(begin()); }
+
+    SmallVector() {}
+    // The constructors below delegate to the default one, so that the destructor cleans up
+    // after an element constructor that throws.
+    template <std::input_iterator Iter>
+    SmallVector(Iter start, Iter end): SmallVector() {
+        if constexpr (std::forward_iterator<Iter>) Reserve(std::ranges::distance(start, end));
+        for (; start != end; ++start) EmplaceBack(*start);
+    }
+    explicit SmallVector(size_t num): SmallVector() {
+        Reserve(num);
+        for (size_t index = 0; index < num; ++index) EmplaceBack();
+    }
+    SmallVector(size_t num, const T& object): SmallVector() {
+        Reserve(num);
+        for (size_t index = 0; index < num; ++index) EmplaceBack(object);
+    }
+    SmallVector(std::initializer_list<T> init_list): SmallVector(init_list.begin(), init_list.end()) {}
+    SmallVector(const SmallVector& other): SmallVector(other.begin(), other.end()) {}
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>): SmallVector() {
+        Steal(other);
+    }
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            SmallVector copy = other;
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            Clear();
+            FreeHeap();
+            Steal(other);
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) {
+        SmallVector moved = std::move(other);
+        other = std::move(*this);
+        *this = std::move(moved);
+    }
+    size_t Size() const { return size; }
+    size_t Capacity() const { return capacity; }
+    T* Data() { return data; }
+    const T* Data() const { return data; }
+    bool Empty() const { return size == 0; }
+    // True while the elements live inside the object.
+    bool IsInline() const { return data == InlineData(); }
+    const T& Back() const { return data[size - 1]; }
+    T& Back() { return data[size - 1]; }
+    const T& Front() const { return data[0]; }
+    T& Front() { return data[0]; }
+    const T& At(size_t index) const {
+        if (index >= size)
+            throw std::out_of_range("Wrong index");
+        return data[index];
+    }
+    T& At(size_t index) {
+        if (index >= size)
+            throw std::out_of_range("Wrong index");
+        return data[index];
+    }
+    const T& operator[](size_t index) const { return data[index]; }
+    T& operator[](size_t index) { return data[index]; }
+
+    void Clear() {
+        for (size_t index = 0; index < size; ++index)
+            data[index].~T();
+        size = 0;
+    }
+    void Resize(size_t count, T value = T()) {
+        if (count <= size) {
+            for (size_t index = count; index < size; ++index)
+                data[index].~T();
+            size = count;
+            return;
+        }
+        Reserve(count);
+        for (size_t index = size; index < count; ++index) {
+            new(data + index) T(value);
+            ++size;
+        }
+    }
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity) MoveTo(Allocate(new_capacity), new_capacity);
+    }
+    // Back to the inline storage when the elements fit there, to an exact heap buffer otherwise.
+    void ShrinkToFit() {
+        if (IsInline() || size == capacity) return;
+        if (size <= N)
+            MoveTo(InlineData(), N);
+        else
+            MoveTo(Allocate(size), size);
+    }
+
+    void PushBack(const T& value) { EmplaceBack(value); }
+    void PushBack(T&& value) { EmplaceBack(std::move(value)); }
+    void PopBack() {
+        data[size - 1].~T();
+        --size;
+    }
+    template<typename ...Args>
+    void EmplaceBack(Args&& ...args) {
+        if (size >= capacity) {
+            GrowAndEmplace(std::forward<Args>(args)...);
+            return;
+        }
+        new(data + size) T(std::forward<Args>(args)...);
+        ++size;
+    }
+
+    // The range operations work as Vector's do: the buffer grows at most once, trivially
+    // relocatable elements move with memmove, the inserted elements may come from this vector,
+    // and an element constructor that throws leaves the vector as it was.
+    // Returns an iterator to the first inserted element.
+    template <std::input_iterator Iter>
+    Iterator Insert(ConstIterator pos, Iter first, Iter last) {
+        size_t index = pos - cbegin();
+        if constexpr (!std::forward_iterator<Iter>) {
+            // One pass only: the elements are collected first to learn how many there are.
+            SmallVector buffered;
+            for (; first != last; ++first) buffered.EmplaceBack(*first);
+            return InsertWith(index, buffered.size, false, [&](T* to) {
+                vector_detail::MoveIfNoexcept(buffered.data, buffered.size, to);
+            });
+        } else if constexpr (std::contiguous_iterator<Iter> && std::is_same_v<std::iter_value_t<Iter>, T>) {
+            size_t count = std::ranges::distance(first, last);
+            const T* source = std::to_address(first);
+            return InsertWith(index, count, Overlaps(source, source + count), [&](T* to) {
+                std::uninitialized_copy(source, source + count, to);
+            });
+        } else {
+            return InsertWith(index, std::ranges::distance(first, last), true, [&](T* to) {
+                std::uninitialized_copy(first, last, to);
+            });
+        }
+    }
+    Iterator Insert(ConstIterator pos, size_t count, const T& value) {
+        return InsertWith(pos - cbegin(), count, Overlaps(&value, &value + 1), [&](T* to) {
+            std::uninitialized_fill_n(to, count, value);
+        });
+    }
+    Iterator Insert(ConstIterator pos, const T& value) { return Insert(pos, 1, value); }
+
+    // Returns an iterator to the element that followed the erased ones.
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        size_t from = first - cbegin(), to = last - cbegin();
+        if (from == to) return Iterator(data + from);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            for (size_t index = from; index < to; ++index) data[index].~T();
+            if (to != size) std::memmove(static_cast<void*>(data + from), static_cast<const void*>(data + to), sizeof(T) * (size - to));
+        } else {
+            T* end = std::move(data + to, data + size, data + from);
+            for (; end != data + size; ++end) end->~T();
+        }
+        size -= to - from;
+        return Iterator(data + from);
+    }
+    Iterator Erase(ConstIterator pos) { return Erase(pos, pos + 1); }
+
+    template <std::ranges::input_range Range>
+    void Append(Range&& range) {
+        if constexpr (std::ranges::common_range<Range>) {
+            Insert(cend(), std::ranges::begin(range), std::ranges::end(range));
+        } else {
+            auto common = std::views::common(range);
+            Insert(cend(), common.begin(), common.end());
+        }
+    }
+    // Replaces the elements with the ones of range: a trivially copyable range that fits in the
+    // capacity with one memmove, anything else built aside and moved in. Moving inline elements in
+    // can only throw, leaving the vector empty, if T has a throwing move.
+    template <std::ranges::input_range Range>
+    void Assign(Range&& range) {
+        // Measured through the iterators, as in Vector: the members size and data hide the
+        // std::ranges customization points here.
+        using Iter = std::ranges::iterator_t<Range>;
+        if constexpr (std::is_trivially_copyable_v<T> && std::ranges::contiguous_range<Range> &&
+                      std::sized_sentinel_for<std::ranges::sentinel_t<Range>, Iter> &&
+                      std::is_same_v<std::ranges::range_value_t<Range>, T>) {
+            Iter first = std::ranges::begin(range);
+            size_t count = std::ranges::end(range) - first;
+            if (count <= capacity) {
+                if (count != 0) std::memmove(static_cast<void*>(data), static_cast<const void*>(std::to_address(first)), sizeof(T) * count);
+                size = count;
+                return;
+            }
+        }
+        SmallVector assigned;
+        assigned.Append(std::forward<Range>(range));
+        *this = std::move(assigned);
+    }
+
+    ~SmallVector() {
+        Clear();
+        FreeHeap();
+    }
+
+private:
+    T* InlineData() { return reinterpret_cast<T*>(storage); }
+    const T* InlineData() const { return reinterpret_cast<const T*>(storage); }
+
+    // Heap buffers come from std::allocator, which aligns them for T as the inline storage is and
+    // throws std::bad_array_new_length when count elements would not fit in a size_t.
+    static T* Allocate(size_t count) { return std::allocator<T>().allocate(count); }
+    static void Deallocate(T* buffer, size_t count) { std::allocator<T>().deallocate(buffer, count); }
+
+    void FreeHeap() {
+        if (!IsInline()) Deallocate(data, capacity);
+        data = InlineData();
+        capacity = N;
+    }
+
+    // Moves the elements to new_data, which holds new_capacity of them, and frees the old buffer.
+    void MoveTo(T* new_data, size_t new_capacity) {
+        try {
+            vector_detail::Relocate(data, size, new_data);
+        } catch (...) {
+            if (new_data != InlineData()) Deallocate(new_data, new_capacity);
+            throw;
+        }
+        if (!IsInline()) Deallocate(data, capacity);
+        data = new_data;
+        capacity = new_capacity;
+    }
+
+    // Takes other's heap buffer, or moves its inline elements into this one; other is left empty.
+    // This object is empty and inline.
+    void Steal(SmallVector& other) {
+        if (other.IsInline()) {
+            vector_detail::Relocate(other.data, other.size, data);
+        } else {
+            data = other.data;
+            capacity = other.capacity;
+            other.data = other.InlineData();
+            other.capacity = N;
+        }
+        size = other.size;
+        other.size = 0;
+    }
+
+    // Whether [first, last) shares memory with the elements.
+    bool Overlaps(const T* first, const T* last) const {
+        return first != last && std::less<const T*>()(first, data + size) && std::less<const T*>()(data, last);
+    }
+
+    // Opens a gap of count elements at index and has construct(to) build them in the raw memory at
+    // to, as Vector::InsertWith does; past the capacity the elements go to a heap buffer.
+    template <typename Construct>
+    Iterator InsertWith(size_t index, size_t count, bool may_alias, Construct construct) {
+        if (count == 0) return Iterator(data + index);
+        if (size + count <= capacity) {
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                if (!may_alias) {
+                    size_t tail = sizeof(T) * (size - index);
+                    std::memmove(static_cast<void*>(data + index + count), static_cast<const void*>(data + index), tail);
+                    try {
+                        construct(data + index);
+                    } catch (...) {
+                        std::memmove(static_cast<void*>(data + index), static_cast<const void*>(data + index + count), tail);
+                        throw;
+                    }
+                    size += count;
+                    return Iterator(data + index);
+                }
+            }
+            // Built past the end, then rotated into place: the rotation cannot throw.
+            if (index == size || (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)) {
+                construct(data + size);
+                size += count;
+                std::rotate(data + index, data + size - count, data + size);
+                return Iterator(data + index);
+            }
+        }
+        // A heap buffer, also when moving the elements in place could throw halfway.
+        size_t new_capacity = size + count <= capacity ? capacity : std::max(size + count, capacity * 2);
+        T* new_data = Allocate(new_capacity);
+        try {
+            construct(new_data + index);
+        } catch (...) {
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        if constexpr (IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>) {
+            vector_detail::Relocate(data, index, new_data);
+            vector_detail::Relocate(data + index, size - index, new_data + index + count);
+        } else {
+            // Copied, both halves before any old element is destroyed.
+            size_t built = 0;
+            try {
+                vector_detail::MoveIfNoexcept(data, index, new_data);
+                built = index;
+                vector_detail::MoveIfNoexcept(data + index, size - index, new_data + index + count);
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) new_data[i].~T();
+                for (size_t i = index; i < index + count; ++i) new_data[i].~T();
+                Deallocate(new_data, new_capacity);
+                throw;
+            }
+            for (size_t i = 0; i < size; ++i) data[i].~T();
+        }
+        if (!IsInline()) Deallocate(data, capacity);
+        data = new_data;
+        size += count;
+        capacity = new_capacity;
+        return Iterator(data + index);
+    }
+
+    // The new element is constructed before the old ones move, since args may refer to one of them.
+    template<typename ...Args>
+    void GrowAndEmplace(Args&& ...args) {
+        size_t new_capacity = capacity * 2;
+        T* new_data = Allocate(new_capacity);
+        try {
+            new(new_data + size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        try {
+            vector_detail::Relocate(data, size, new_data);
+        } catch (...) {
+            new_data[size].~T();
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        if (!IsInline()) Deallocate(data, capacity);
+        data = new_data;
+        capacity = new_capacity;
+        ++size;
+    }
+};
@@ -0,0 +1,1205 @@
+// Benchmarks for String. Build with optimizations, for example
+//   g++ -std=c++20 -O2 $(ls *.cpp | grep -v test_) ../thread_pool/thread_pool.cpp -o bench_str
+// and run ./bench_str [name-filter] to run only the benchmarks whose name contains the filter.
+// STR_SIMD_NO_AVX2=1 in the environment measures the SSE2 kernels instead of the AVX2 ones.
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "str.hpp"
+#include "pattern_matcher.hpp"
+#include "split.hpp"
+#include "string_pool.hpp"
+#include "string_builder.hpp"
+#include "mapped_file.hpp"
+#include "format.hpp"
+#include "shared_string.hpp"
+#include "string_column.hpp"
+#include "string_sort.hpp"
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+// The format benchmark compares with std::format, or with {fmt}, the library it was standardized
+// from, where the standard library does not have it yet (libstdc++ before 13).
+#if __has_include(<format>) && __cplusplus >= 202002L
+#include <format>
+#define STR_BENCH_FORMAT "std::format"
+namespace bench_format = std;
+#elif __has_include(<fmt/format.h>)
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+#define STR_BENCH_FORMAT "fmt::format"
+namespace bench_format = fmt;
+#endif
+
+namespace {
+
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs body(iterations) until it takes at least 0.2 s and prints the time per operation.
+// ops_per_iteration and bytes_per_iteration turn the timing into per-op and GB/s figures.
+template <typename Body>
+void Measure(const char* name, size_t ops_per_iteration, size_t bytes_per_iteration, Body body) {
+  using Clock = std::chrono::steady_clock;
+  size_t iterations = 1;
+  double seconds = 0;
+  while (true) {
+    auto start = Clock::now();
+    body(iterations);
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds >= 0.2 || iterations >= (size_t(1) << 40)) break;
+    iterations *= seconds < 0.02 ? 10 : 2;
+  }
+  double ops = static_cast<double>(iterations) * ops_per_iteration;
+  std::printf("%-48s %12.2f ns/op", name, seconds * 1e9 / ops);
+  if (bytes_per_iteration != 0)
+    std::printf(" %10.2f GB/s", static_cast<double>(iterations) * bytes_per_iteration / seconds / 1e9);
+  std::printf("\n");
+}
+
+std::mt19937_64& Rng() {
+  static std::mt19937_64 rng(42);
+  return rng;
+}
+
+std::string RandomText(size_t size) {
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::string text(size, ' ');
+  for (auto& symbol : text) symbol = static_cast<char>(letter(Rng()));
+  return text;
+}
+
+// The byte loop operator<=> used before the SIMD kernels, kept as the baseline.
+int ScalarCompare(const String& lhs, const String& rhs) {
+  size_t nCompared = std::min(rhs.Size(), lhs.Size());
+  for (size_t i = 0; i < nCompared; i++) {
+    if (lhs[i] < rhs[i])
+      return -1;
+    else if (lhs[i] > rhs[i])
+      return 1;
+  }
+  if (lhs.Size() < rhs.Size()) return -1;
+  if (lhs.Size() > rhs.Size()) return 1;
+  return 0;
+}
+
+void BenchCompare() {
+  const size_t kPairs = 256;
+  for (size_t size : {8, 32, 256, 4096, 65536}) {
+    // Pairs differ only in the last byte, so every comparison reads both strings in full.
+    std::vector<String> lhs, rhs;
+    std::vector<std::string> std_lhs, std_rhs;
+    for (size_t i = 0; i < kPairs; ++i) {
+      std::string text = RandomText(size);
+      std_lhs.push_back(text);
+      text.back() = 'z' + 1;
+      std_rhs.push_back(text);
+      lhs.emplace_back(std_lhs.back().data(), size);
+      rhs.emplace_back(std_rhs.back().data(), size);
+    }
+    size_t bytes = kPairs * size * 2;
+    char name[64];
+
+    std::snprintf(name, sizeof(name), "compare/%zu/scalar-loop", size);
+    Measure(name, kPairs, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kPairs; ++i) DoNotOptimize(ScalarCompare(lhs[i], rhs[i]));
+    });
+    std::snprintf(name, sizeof(name), "compare/%zu/String<=>", size);
+    Measure(name, kPairs, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kPairs; ++i) DoNotOptimize(lhs[i] <=> rhs[i]);
+    });
+    std::snprintf(name, sizeof(name), "compare/%zu/std::string::compare", size);
+    Measure(name, kPairs, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kPairs; ++i) DoNotOptimize(std_lhs[i].compare(std_rhs[i]));
+    });
+    std::snprintf(name, sizeof(name), "equal/%zu/String==", size);
+    Measure(name, kPairs, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kPairs; ++i) DoNotOptimize(lhs[i] == rhs[i]);
+    });
+    std::snprintf(name, sizeof(name), "equal/%zu/std::string==", size);
+    Measure(name, kPairs, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kPairs; ++i) DoNotOptimize(std_lhs[i] == std_rhs[i]);
+    });
+  }
+}
+
+// Haystacks of random words from 16 B to 64 MiB with the needle only at the far end,
+// so every search scans the whole haystack.
+void BenchFind() {
+  std::string corpus;
+  const char* words[] = {"alpha", "beta", "gamma", "delta", "status", "request", "host", "metric", "user", "agent"};
+  std::uniform_int_distribution<size_t> word(0, std::size(words) - 1);
+  while (corpus.size() < (size_t(64) << 20)) {
+    corpus += words[word(Rng())];
+    corpus += ' ';
+  }
+
+  const std::string short_needle = "needle!";
+  const std::string long_needle = "status request " + std::string(80, 'x') + " needle!";
+  for (size_t size : {size_t(16), size_t(256), size_t(4) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20,
+                      size_t(64) << 20}) {
+    for (const std::string* needle : {&short_needle, &long_needle}) {
+      if (needle->size() > size) continue;
+      std::string haystack = corpus.substr(0, size - needle->size()) + *needle;
+      const String str(haystack.data(), haystack.size());
+      const String pattern(needle->data(), needle->size());
+      char name[64];
+
+      std::snprintf(name, sizeof(name), "find/%zu/needle-%zu/String::Find", size, needle->size());
+      Measure(name, 1, size, [&](size_t n) {
+        for (size_t it = 0; it < n; ++it) DoNotOptimize(str.Find(pattern));
+      });
+      std::snprintf(name, sizeof(name), "find/%zu/needle-%zu/std::string::find", size, needle->size());
+      Measure(name, 1, size, [&](size_t n) {
+        for (size_t it = 0; it < n; ++it) DoNotOptimize(haystack.find(*needle));
+      });
+
+      // The same haystack searched from the back with the needle moved to the front.
+      std::string reversed = *needle + corpus.substr(0, size - needle->size());
+      const String rstr(reversed.data(), reversed.size());
+      std::snprintf(name, sizeof(name), "rfind/%zu/needle-%zu/String::RFind", size, needle->size());
+      Measure(name, 1, size, [&](size_t n) {
+        for (size_t it = 0; it < n; ++it) DoNotOptimize(rstr.RFind(pattern));
+      });
+      std::snprintf(name, sizeof(name), "rfind/%zu/needle-%zu/std::string::rfind", size, needle->size());
+      Measure(name, 1, size, [&](size_t n) {
+        for (size_t it = 0; it < n; ++it) DoNotOptimize(reversed.rfind(*needle));
+      });
+    }
+  }
+}
+
+// Log-like text scanned for N random blocklisted tokens: throughput of the compiled matcher
+// should stay flat as N grows, while one Find pass per token degrades linearly.
+void BenchPatternMatcher() {
+  const size_t kTextSize = size_t(16) << 20;
+  std::string text;
+  while (text.size() < kTextSize) {
+    text += "GET /api/v1/items?id=" + std::to_string(Rng()() % 100000) + " host=" + RandomText(8) + " ua=Mozilla/5.0\n";
+  }
+  const String str(text.data(), text.size());
+
+  for (size_t count : {1, 10, 100, 500, 2000}) {
+    Vector<String> patterns;
+    std::uniform_int_distribution<size_t> length(6, 16);
+    for (size_t p = 0; p < count; ++p) {
+      std::string token = RandomText(length(Rng()));
+      patterns.PushBack(String(token.data(), token.size()));
+    }
+    const PatternMatcher matcher(patterns);
+    char name[64];
+
+    std::snprintf(name, sizeof(name), "matcher/%zu-patterns/PatternMatcher::Scan", count);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        size_t matches = 0;
+        matcher.Scan(str, [&](const PatternMatcher::Match&) { ++matches; });
+        DoNotOptimize(matches);
+      }
+    });
+    if (count > 100) continue;
+    std::snprintf(name, sizeof(name), "matcher/%zu-patterns/Find-per-pattern", count);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t p = 0; p < patterns.Size(); ++p) DoNotOptimize(str.Contains(patterns[p]));
+    });
+  }
+}
+
+// CSV-like lines split into fields: the views from Split against std::string::find + substr,
+// which allocates one std::string per field longer than its SSO buffer.
+void BenchSplit() {
+  std::string text;
+  size_t lines = 0;
+  std::uniform_int_distribution<size_t> length(0, 24);
+  while (text.size() < (size_t(16) << 20)) {
+    for (int field = 0; field < 12; ++field) {
+      if (field != 0) text += ',';
+      text += RandomText(length(Rng()));
+    }
+    text += '\n';
+    ++lines;
+  }
+  const String str(text.data(), text.size());
+  size_t fields = 0;
+  for (StringView line : Split(str, '\n'))
+    for (StringView field : Split(line, ',')) DoNotOptimize(field), ++fields;
+
+  Measure("split/csv/Split-views", fields, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (StringView line : Split(str, '\n'))
+        for (StringView field : Split(line, ',')) DoNotOptimize(field);
+  });
+  Measure("split/csv/Tokenize-views", fields, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (StringView field : Tokenize(str, ",\n")) DoNotOptimize(field);
+  });
+  Measure("split/csv/std::string::find+substr", fields, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t line_begin = 0;
+      while (line_begin < text.size()) {
+        size_t line_end = text.find('\n', line_begin);
+        if (line_end == std::string::npos) line_end = text.size();
+        std::string line = text.substr(line_begin, line_end - line_begin);
+        size_t begin = 0;
+        while (true) {
+          size_t end = line.find(',', begin);
+          std::string field = line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+          DoNotOptimize(field);
+          if (end == std::string::npos) break;
+          begin = end + 1;
+        }
+        line_begin = line_end + 1;
+      }
+    }
+  });
+
+  Vector<StringView> parts = Split(str, ',').ToVector();
+  Measure("split/csv/Join", 1, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(Join(parts, ";"));
+  });
+}
+
+// Ten million identifiers drawn from a few thousand distinct host and metric names: memory held
+// as separate Strings against one pool, Intern() throughput, and hash map lookups keyed by
+// interned handles against std::string keys.
+void BenchIntern() {
+  const size_t kDistinct = 5000, kCount = 10000000;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < kDistinct; ++i)
+    names.push_back((i % 2 == 0 ? "host-" : "metric.http.requests.") + RandomText(12) + ".example.com");
+  std::uniform_int_distribution<size_t> pick(0, kDistinct - 1);
+  std::vector<uint32_t> stream(kCount);
+  for (auto& index : stream) index = static_cast<uint32_t>(pick(Rng()));
+
+  size_t string_bytes = 0;
+  {
+    std::vector<String> copies;
+    copies.reserve(kCount);
+    for (uint32_t index : stream) {
+      copies.emplace_back(names[index].data(), names[index].size());
+      string_bytes += sizeof(String) + (copies.back().Size() > String::InlineCapacity ? copies.back().Capacity() + 1 : 0);
+    }
+    DoNotOptimize(copies.back());
+  }
+  StringPool pool;
+  std::vector<InternedString> handles;
+  handles.reserve(kCount);
+  for (uint32_t index : stream) handles.push_back(pool.Intern(StringView(names[index].data(), names[index].size())));
+  size_t pool_bytes = pool.MemoryUsage() + handles.size() * sizeof(InternedString);
+  std::printf("%-48s %12.1f MiB\n", "intern/memory/String-per-copy", string_bytes / 1048576.0);
+  std::printf("%-48s %12.1f MiB\n", "intern/memory/StringPool+handles", pool_bytes / 1048576.0);
+
+  const size_t kBatch = 100000;
+  Measure("intern/StringPool::Intern", kBatch, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (size_t i = 0; i < kBatch; ++i) {
+        const std::string& name = names[stream[i]];
+        DoNotOptimize(pool.Intern(StringView(name.data(), name.size())));
+      }
+  });
+
+  std::unordered_map<InternedString, size_t> interned_counts;
+  std::unordered_map<std::string, size_t> std_counts;
+  for (size_t i = 0; i < kDistinct; ++i) {
+    interned_counts[pool.Intern(StringView(names[i].data(), names[i].size()))] = i;
+    std_counts[names[i]] = i;
+  }
+  std::vector<std::string> std_keys;
+  for (size_t i = 0; i < kBatch; ++i) std_keys.push_back(names[stream[i]]);
+  Measure("intern/map-lookup/InternedString-key", kBatch, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (size_t i = 0; i < kBatch; ++i) DoNotOptimize(interned_counts.find(handles[i])->second);
+  });
+  Measure("intern/map-lookup/std::string-key", kBatch, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (size_t i = 0; i < kBatch; ++i) DoNotOptimize(std_counts.find(std_keys[i])->second);
+  });
+}
+
+// FNV-1a, the byte-at-a-time hash a wrapper would typically use, kept as the baseline.
+uint64_t Fnv1a(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Short keys hashed back to back (latency of the whole call, keys of mixed contents), then bulk
+// buffers for throughput.
+void BenchHash() {
+  const size_t kKeys = 4096;
+  for (size_t size : {8, 12, 16, 24, 32}) {
+    std::vector<String> keys;
+    std::vector<std::string> std_keys;
+    for (size_t i = 0; i < kKeys; ++i) {
+      std_keys.push_back(RandomText(size));
+      keys.emplace_back(std_keys.back().data(), size);
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "hash/%zu/String::Hash", size);
+    Measure(name, kKeys, kKeys * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kKeys; ++i) DoNotOptimize(keys[i].Hash());
+    });
+    std::snprintf(name, sizeof(name), "hash/%zu/std::hash<std::string>", size);
+    Measure(name, kKeys, kKeys * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kKeys; ++i) DoNotOptimize(std::hash<std::string>()(std_keys[i]));
+    });
+    std::snprintf(name, sizeof(name), "hash/%zu/fnv1a-loop", size);
+    Measure(name, kKeys, kKeys * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < kKeys; ++i) DoNotOptimize(Fnv1a(keys[i].Data(), keys[i].Size()));
+    });
+  }
+
+  for (size_t size : {size_t(256), size_t(4) << 10, size_t(1) << 20, size_t(64) << 20}) {
+    const std::string buffer = RandomText(size);
+    char name[64];
+    std::snprintf(name, sizeof(name), "hash/%zu/HashBytes", size);
+    Measure(name, 1, size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(HashBytes(buffer.data(), size));
+    });
+    std::snprintf(name, sizeof(name), "hash/%zu/std::hash<std::string_view>", size);
+    Measure(name, 1, size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(std::hash<std::string_view>()(buffer));
+    });
+    if (size > (size_t(1) << 20)) continue;
+    std::snprintf(name, sizeof(name), "hash/%zu/fnv1a-loop", size);
+    Measure(name, 1, size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(Fnv1a(buffer.data(), size));
+    });
+  }
+}
+
+// A response assembled from small pieces (16-64 B) up to the target size. "exact-growth" reserves
+// exactly the new size before every append, which is what operator+= used to do.
+void BenchBuild() {
+  std::vector<std::string> pieces;
+  std::uniform_int_distribution<size_t> length(16, 64);
+  for (size_t i = 0; i < 1024; ++i) pieces.push_back(RandomText(length(Rng())));
+
+  for (size_t target : {size_t(64) << 10, size_t(1) << 20, size_t(16) << 20}) {
+    size_t count = 0, bytes = 0;
+    while (bytes < target) bytes += pieces[count++ % pieces.size()].size();
+    char name[64];
+
+    std::snprintf(name, sizeof(name), "build/%zu/StringBuilder+ToString", target);
+    Measure(name, count, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        StringBuilder builder;
+        for (size_t i = 0; i < count; ++i) {
+          const std::string& piece = pieces[i % pieces.size()];
+          builder.Append(StringView(piece.data(), piece.size()));
+        }
+        DoNotOptimize(builder.ToString());
+      }
+    });
+    std::snprintf(name, sizeof(name), "build/%zu/StringBuilder-chunks-only", target);
+    Measure(name, count, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        StringBuilder builder;
+        for (size_t i = 0; i < count; ++i) {
+          const std::string& piece = pieces[i % pieces.size()];
+          builder.Append(StringView(piece.data(), piece.size()));
+        }
+        DoNotOptimize(builder.Chunks());
+      }
+    });
+    std::snprintf(name, sizeof(name), "build/%zu/String+=", target);
+    Measure(name, count, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        String str;
+        for (size_t i = 0; i < count; ++i) {
+          const std::string& piece = pieces[i % pieces.size()];
+          str.Append(StringView(piece.data(), piece.size()));
+        }
+        DoNotOptimize(str);
+      }
+    });
+    std::snprintf(name, sizeof(name), "build/%zu/std::string+=", target);
+    Measure(name, count, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        std::string str;
+        for (size_t i = 0; i < count; ++i) str += pieces[i % pieces.size()];
+        DoNotOptimize(str);
+      }
+    });
+    if (target > (size_t(1) << 20)) continue;
+    std::snprintf(name, sizeof(name), "build/%zu/String+=exact-growth", target);
+    Measure(name, count, bytes, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        String str;
+        for (size_t i = 0; i < count; ++i) {
+          const std::string& piece = pieces[i % pieces.size()];
+          str.Reserve(str.Size() + piece.size());
+          str.Append(StringView(piece.data(), piece.size()));
+        }
+        DoNotOptimize(str);
+      }
+    });
+  }
+}
+
+// The per-character operator<< that String used to have, kept as the baseline.
+void WritePerChar(std::ostream& stream, const String& str) {
+  for (size_t i = 0; i < str.Size(); i++) stream << str[i];
+}
+
+// Text export and import through string streams: words of 2-24 characters, ten to a line.
+void BenchStreamIo() {
+  const size_t kWords = 200000;
+  std::vector<String> words;
+  std::vector<std::string> std_words;
+  std::uniform_int_distribution<size_t> length(2, 24);
+  std::string text;
+  for (size_t i = 0; i < kWords; ++i) {
+    std_words.push_back(RandomText(length(Rng())));
+    words.emplace_back(std_words.back().data(), std_words.back().size());
+    text += std_words.back();
+    text += i % 10 == 9 ? '\n' : ' ';
+  }
+  const size_t lines = kWords / 10;
+
+  Measure("io/write/String<<per-char", kWords, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::ostringstream out;
+      for (const String& word : words) WritePerChar(out, word), out << ' ';
+      DoNotOptimize(out.tellp());
+    }
+  });
+  Measure("io/write/String<<", kWords, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::ostringstream out;
+      for (const String& word : words) out << word << ' ';
+      DoNotOptimize(out.tellp());
+    }
+  });
+  Measure("io/write/std::string<<", kWords, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::ostringstream out;
+      for (const std::string& word : std_words) out << word << ' ';
+      DoNotOptimize(out.tellp());
+    }
+  });
+
+  Measure("io/read-tokens/String>>", kWords, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      String word;
+      while (in >> word) DoNotOptimize(word);
+    }
+  });
+  Measure("io/read-tokens/std::string>>", kWords, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      std::string word;
+      while (in >> word) DoNotOptimize(word);
+    }
+  });
+  Measure("io/read-lines/GetLine", lines, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      String line;
+      while (GetLine(in, line)) DoNotOptimize(line);
+    }
+  });
+  Measure("io/read-lines/std::getline", lines, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      std::string line;
+      while (std::getline(in, line)) DoNotOptimize(line);
+    }
+  });
+  Measure("io/read-all/ReadAll", 1, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      DoNotOptimize(ReadAll(in));
+    }
+  });
+  Measure("io/read-all/istreambuf_iterator", 1, text.size(), [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::istringstream in(text);
+      DoNotOptimize(std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+    }
+  });
+}
+
+// Loading a 256 MiB dictionary file (warm page cache) and scanning it once, so that every
+// variant touches every byte: stream reads copy it twice, FromFile once, the mapping not at all.
+void BenchLoad() {
+  const size_t kSize = size_t(256) << 20;
+  const std::string path = (std::filesystem::temp_directory_path() / "bench_str_load.txt").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    std::string line;
+    for (size_t written = 0; written < kSize; written += line.size()) {
+      line = RandomText(8 + Rng()() % 24) + '\n';
+      out << line;
+    }
+  }
+  const size_t size = std::filesystem::file_size(path);
+  const StringView needle("not in the file");
+
+  Measure("load/ifstream+istreambuf_iterator", 1, size, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::ifstream in(path, std::ios::binary);
+      std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      DoNotOptimize(std::string_view(text).find("not in the file"));
+    }
+  });
+  Measure("load/ifstream+ReadAll", 1, size, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::ifstream in(path, std::ios::binary);
+      DoNotOptimize(ReadAll(in).Find(needle));
+    }
+  });
+  Measure("load/String::FromFile", 1, size, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(String::FromFile(path.c_str()).Find(needle));
+  });
+  Measure("load/MappedFile", 1, size, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(StringView(MappedFile(path.c_str())).Find(needle));
+  });
+  std::filesystem::remove(path);
+}
+
+// One simulated request: parse 48 header-like fields out of a raw request, normalize them into
+// new strings grown piece by piece, and drop everything at the end.
+template <typename StringType, typename... Alloc>
+size_t HandleRequest(const std::vector<std::string>& fields, const Alloc&... alloc) {
+  std::vector<StringType> owned;
+  owned.reserve(fields.size());
+  size_t total = 0;
+  for (const std::string& field : fields) {
+    StringType value(alloc...);
+    for (size_t i = 0; i < field.size(); i += 8)
+      value.Append(StringView(field.data() + i, std::min<size_t>(8, field.size() - i)));
+    value.PushBack(';');
+    total += value.Size();
+    owned.push_back(std::move(value));
+  }
+  return total;
+}
+
+void BenchArena() {
+  std::vector<std::string> fields;
+  std::uniform_int_distribution<size_t> length(8, 160);
+  for (size_t i = 0; i < 48; ++i) fields.push_back(RandomText(length(Rng())));
+
+  Measure("arena/request/String-global-heap", 1, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(HandleRequest<String>(fields));
+  });
+  Measure("arena/request/PmrString-new_delete", 1, 0, [&](size_t n) {
+    std::pmr::polymorphic_allocator<char> alloc(std::pmr::new_delete_resource());
+    for (size_t it = 0; it < n; ++it) DoNotOptimize(HandleRequest<PmrString>(fields, alloc));
+  });
+  Measure("arena/request/PmrString-monotonic", 1, 0, [&](size_t n) {
+    // The arena buffer is reused from request to request; release() is the only free.
+    static char buffer[64 << 10];
+    for (size_t it = 0; it < n; ++it) {
+      std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+      DoNotOptimize(HandleRequest<PmrString>(fields, std::pmr::polymorphic_allocator<char>(&arena)));
+    }
+  });
+}
+
+// Validation one decoded sequence at a time, the way a straightforward loop does it.
+bool ScalarValidUtf8(const std::string& text) {
+  const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+  for (size_t i = 0, length; i < text.size(); i += length)
+    if ((length = Utf8SequenceLength(p + i, text.size() - i)) == 0) return false;
+  return true;
+}
+
+size_t ScalarCountCodePoints(const std::string& text) {
+  size_t count = 0;
+  for (char symbol : text) count += (static_cast<unsigned char>(symbol) & 0xC0) != 0x80;
+  return count;
+}
+
+void BenchUtf8() {
+  const size_t kSize = size_t(1) << 20;
+  // Mostly Latin with some accents, Cyrillic, CJK and emoji: every block has multibyte sequences.
+  const char* words[] = {"text ", "caf\xC3\xA9 ", "\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 ",
+                         "\xE4\xB8\x96\xE7\x95\x8C ", "\xF0\x9F\x98\x80 ", "string "};
+  std::string mixed;
+  std::uniform_int_distribution<size_t> word(0, std::size(words) - 1);
+  while (mixed.size() < kSize) mixed += words[word(Rng())];
+  const std::pair<const char*, std::string> inputs[] = {{"ascii", RandomText(kSize)}, {"mixed", mixed}};
+
+  for (const auto& [kind, text] : inputs) {
+    const StringView view(text.data(), text.size());
+    std::vector<char16_t> utf16(text.size());
+    char name[64];
+    std::snprintf(name, sizeof(name), "utf8/%s/validate/scalar-loop", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(ScalarValidUtf8(text));
+    });
+    std::snprintf(name, sizeof(name), "utf8/%s/validate/IsValidUtf8", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(view.IsValidUtf8());
+    });
+    std::snprintf(name, sizeof(name), "utf8/%s/count/scalar-loop", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(ScalarCountCodePoints(text));
+    });
+    std::snprintf(name, sizeof(name), "utf8/%s/count/CodePointCount", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(view.CodePointCount());
+    });
+    std::snprintf(name, sizeof(name), "utf8/%s/iterate/CodePoints", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) {
+        char32_t sum = 0;
+        for (char32_t code_point : view.CodePoints()) sum += code_point;
+        DoNotOptimize(sum);
+      }
+    });
+    std::snprintf(name, sizeof(name), "utf8/%s/transcode/Utf8ToUtf16", kind);
+    Measure(name, 1, text.size(), [&](size_t n) {
+      for (size_t it = 0; it < n; ++it) DoNotOptimize(Utf8ToUtf16(text.data(), text.size(), utf16.data()));
+    });
+  }
+}
+
+// Formats kNumbers values into metric lines "requests <value>\n", flushing the line buffer
+// every 64 KiB the way a writer would, and returns the total length written.
+constexpr size_t kNumbers = 100'000'000;
+
+template <typename Number, typename AppendNumber>
+size_t FormatLines(const std::vector<Number>& values, AppendNumber append) {
+  String lines;
+  lines.Reserve(64 << 10);
+  size_t total = 0;
+  for (size_t i = 0; i < kNumbers; ++i) {
+    lines += "requests ";
+    append(lines, values[i & (values.size() - 1)]);
+    lines.PushBack('\n');
+    if (lines.Size() > (63 << 10)) {
+      total += lines.Size();
+      lines.Clear();
+    }
+  }
+  return total + lines.Size();
+}
+
+void BenchNumbers() {
+  std::vector<int64_t> integers(4096);
+  std::vector<double> doubles(4096);
+  for (size_t i = 0; i < integers.size(); ++i) {
+    // A spread of magnitudes, from single digits to 19 digits.
+    integers[i] = static_cast<int64_t>(Rng()() >> (Rng()() % 64));
+    doubles[i] = std::uniform_real_distribution<double>(-1e6, 1e6)(Rng());
+  }
+
+  Measure("numbers/int/std::to_string", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(integers, [](String& out, int64_t value) {
+        std::string text = std::to_string(value);
+        out.Append(StringView(text.data(), text.size()));
+      }));
+  });
+  Measure("numbers/int/snprintf", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(integers, [](String& out, int64_t value) {
+        char buffer[24];
+        out.Append(StringView(buffer, std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value))));
+      }));
+  });
+  Measure("numbers/int/AppendInt", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(integers, [](String& out, int64_t value) { out.AppendInt(value); }));
+  });
+  Measure("numbers/hex/AppendHex", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(integers, [](String& out, int64_t value) { out.AppendHex(value); }));
+  });
+  Measure("numbers/double/std::to_string", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(doubles, [](String& out, double value) {
+        std::string text = std::to_string(value);
+        out.Append(StringView(text.data(), text.size()));
+      }));
+  });
+  Measure("numbers/double/snprintf-%.17g", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(doubles, [](String& out, double value) {
+        char buffer[32];
+        out.Append(StringView(buffer, std::snprintf(buffer, sizeof(buffer), "%.17g", value)));
+      }));
+  });
+  Measure("numbers/double/AppendDouble", kNumbers, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      DoNotOptimize(FormatLines(doubles, [](String& out, double value) { out.AppendDouble(value); }));
+  });
+
+  // Parsing the numbers back out of a view, against strtoll on a NUL-terminated copy.
+  String text;
+  for (int64_t value : integers) text.AppendInt(value).PushBack(' ');
+  const Vector<StringView> fields = Split(text, ' ').ToVector();
+  Measure("numbers/parse-int/strtoll-copy", fields.Size(), 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (size_t i = 0; i < fields.Size(); ++i)
+        DoNotOptimize(std::strtoll(std::string(fields[i].Data(), fields[i].Size()).c_str(), nullptr, 10));
+  });
+  Measure("numbers/parse-int/ParseInt", fields.Size(), 0, [&](size_t n) {
+    int64_t value = 0;
+    for (size_t it = 0; it < n; ++it)
+      for (size_t i = 0; i < fields.Size(); ++i) DoNotOptimize(ParseInt(fields[i], value));
+  });
+}
+
+// The byte-at-a-time helpers header normalization used before the SIMD kernels.
+void ScalarToLower(String& str) {
+  for (size_t i = 0; i < str.Size(); ++i)
+    if (str[i] >= 'A' && str[i] <= 'Z') str[i] = static_cast<char>(str[i] + 32);
+}
+
+bool ScalarEqualsIgnoreCase(StringView lhs, StringView rhs) {
+  if (lhs.Size() != rhs.Size()) return false;
+  for (size_t i = 0; i < lhs.Size(); ++i)
+    if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i]))) return false;
+  return true;
+}
+
+StringView ScalarTrim(StringView view) {
+  size_t begin = 0, end = view.Size();
+  while (begin < end && std::isspace(static_cast<unsigned char>(view[begin]))) ++begin;
+  while (end > begin && std::isspace(static_cast<unsigned char>(view[end - 1]))) --end;
+  return view.Substr(begin, end - begin);
+}
+
+void BenchCase() {
+  const size_t kStrings = 4096;
+  for (size_t size : {size_t(12), size_t(40), size_t(4096)}) {
+    std::vector<String> originals, uppers;
+    for (size_t i = 0; i < kStrings; ++i) {
+      std::string text = RandomText(size);
+      for (size_t k = 0; k < size; k += 3) text[k] = static_cast<char>(text[k] - 32);
+      originals.emplace_back(text.data(), text.size());
+      uppers.push_back(ToUpper(originals.back()));
+    }
+    std::vector<String> work = originals;
+    const size_t strings = size > 1000 ? 256 : kStrings;
+    char name[64];
+
+    std::snprintf(name, sizeof(name), "case/%zu/lower/scalar-loop", size);
+    Measure(name, strings, strings * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) {
+          ScalarToLower(work[i]);
+          DoNotOptimize(work[i]);
+        }
+    });
+    std::snprintf(name, sizeof(name), "case/%zu/lower/ToLower", size);
+    Measure(name, strings, strings * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) DoNotOptimize(work[i].ToLower());
+    });
+    std::snprintf(name, sizeof(name), "case/%zu/equals/scalar-tolower", size);
+    Measure(name, strings, strings * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) DoNotOptimize(ScalarEqualsIgnoreCase(originals[i], uppers[i]));
+    });
+    std::snprintf(name, sizeof(name), "case/%zu/equals/EqualsIgnoreCase", size);
+    Measure(name, strings, strings * size, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) DoNotOptimize(originals[i].EqualsIgnoreCase(uppers[i]));
+    });
+
+    // Header values padded with a few spaces, and long runs of indentation.
+    std::vector<String> padded;
+    for (size_t i = 0; i < strings; ++i) {
+      size_t pad = size > 1000 ? size / 2 : 1 + i % 3;
+      padded.push_back(String(std::string(pad, ' ').c_str()) + originals[i] + String(std::string(pad, '	').c_str()));
+    }
+    std::snprintf(name, sizeof(name), "case/%zu/trim/scalar-isspace", size);
+    Measure(name, strings, 0, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) DoNotOptimize(ScalarTrim(padded[i]));
+    });
+    std::snprintf(name, sizeof(name), "case/%zu/trim/Trim", size);
+    Measure(name, strings, 0, [&](size_t n) {
+      for (size_t it = 0; it < n; ++it)
+        for (size_t i = 0; i < strings; ++i) DoNotOptimize(StringView(padded[i]).Trim());
+    });
+  }
+}
+
+// A message whose fields are passed by value through three layers and kept at the end, the way
+// a pipeline hands records from stage to stage.
+template <typename StringType>
+struct Message {
+  StringType key, value, source;
+};
+
+template <typename StringType>
+[[gnu::noinline]] Message<StringType> Route(Message<StringType> message) { return message; }
+
+template <typename StringType>
+[[gnu::noinline]] Message<StringType> Enrich(Message<StringType> message) { return Route(message); }
+
+template <typename StringType>
+[[gnu::noinline]] void Store(std::vector<Message<StringType>>& sink, Message<StringType> message) {
+  sink.push_back(Enrich(message));
+}
+
+template <typename StringType>
+void RunPipeline(const char* name, size_t size) {
+  std::vector<Message<StringType>> inputs;
+  for (size_t i = 0; i < 256; ++i) {
+    std::string text = RandomText(size);
+    inputs.push_back({StringType(text.c_str()), StringType(text.c_str()), StringType(text.c_str())});
+  }
+  std::vector<Message<StringType>> sink;
+  sink.reserve(inputs.size());
+  Measure(name, inputs.size(), 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      for (const auto& message : inputs) Store(sink, message);
+      DoNotOptimize(sink.data());
+      sink.clear();
+    }
+  });
+}
+
+void BenchCopyOnWrite() {
+  for (size_t size : {size_t(8), size_t(64), size_t(1024)}) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "cow/%zu/pipeline/String", size);
+    RunPipeline<String>(name, size);
+    std::snprintf(name, sizeof(name), "cow/%zu/pipeline/SharedString", size);
+    RunPipeline<SharedString>(name, size);
+  }
+
+  // The cost of the first write to a copy: one allocation and copy, as an eager copy pays up front.
+  const std::string text = RandomText(64);
+  const String eager(text.c_str());
+  const SharedString shared(text.c_str());
+  Measure("cow/64/copy-then-write/String", 1, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      String copy = eager;
+      copy[0] = 'x';
+      DoNotOptimize(copy);
+    }
+  });
+  Measure("cow/64/copy-then-write/SharedString", 1, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      SharedString copy = shared;
+      copy[0] = 'x';
+      DoNotOptimize(copy);
+    }
+  });
+}
+
+struct MetricSample {
+  String name;
+  int64_t value;
+  double ratio;
+  uint64_t timestamp;
+};
+
+void BenchFormat() {
+  std::vector<MetricSample> samples(1024);
+  for (auto& sample : samples) {
+    const std::string name = "service." + RandomText(4 + Rng()() % 12);
+    sample = {String(name.data(), name.size()), static_cast<int64_t>(Rng()() % 10'000'000) - 5'000'000,
+              std::uniform_real_distribution<double>(0, 100)(Rng()), 1'700'000'000'000 + Rng()() % 100'000'000};
+  }
+  const size_t kSamples = samples.size();
+
+  Measure("format/line/snprintf", kSamples, 0, [&](size_t n) {
+    String out;
+    for (size_t it = 0; it < n; ++it) {
+      for (const auto& sample : samples) {
+        char buffer[128];
+        int size = std::snprintf(buffer, sizeof(buffer), "%s %lld %.17g %llu\n", sample.name.CStr(),
+                                 static_cast<long long>(sample.value), sample.ratio,
+                                 static_cast<unsigned long long>(sample.timestamp));
+        out.Append(StringView(buffer, size));
+      }
+      DoNotOptimize(out.Size());
+      out.Clear();
+    }
+  });
+#ifdef STR_BENCH_FORMAT
+  Measure("format/line/" STR_BENCH_FORMAT "_to", kSamples, 0, [&](size_t n) {
+    std::string out;
+    for (size_t it = 0; it < n; ++it) {
+      for (const auto& sample : samples)
+        bench_format::format_to(std::back_inserter(out), "{} {} {} {}\n",
+                                std::string_view(sample.name.CStr(), sample.name.Size()), sample.value, sample.ratio,
+                                sample.timestamp);
+      DoNotOptimize(out.size());
+      out.clear();
+    }
+  });
+#endif
+  Measure("format/line/FormatTo", kSamples, 0, [&](size_t n) {
+    String out;
+    for (size_t it = 0; it < n; ++it) {
+      for (const auto& sample : samples)
+        FormatTo<"{} {} {} {}\n">(out, sample.name, sample.value, sample.ratio, sample.timestamp);
+      DoNotOptimize(out.Size());
+      out.Clear();
+    }
+  });
+
+  // A new string per message, integers only.
+#ifdef STR_BENCH_FORMAT
+  Measure("format/new-string/" STR_BENCH_FORMAT, kSamples, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (const auto& sample : samples)
+        DoNotOptimize(bench_format::format("id={} value={} at {}", sample.timestamp % 100000, sample.value, sample.timestamp));
+  });
+#endif
+  Measure("format/new-string/Format", kSamples, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it)
+      for (const auto& sample : samples)
+        DoNotOptimize(Format<"id={} value={} at {}">(sample.timestamp % 100000, sample.value, sample.timestamp));
+  });
+}
+
+// A million short strings, 4 to 40 characters, as Vector<String> and as one StringColumn.
+void BenchColumn() {
+  const size_t kStrings = 1'000'000;
+  std::vector<std::string> source(kStrings);
+  size_t bytes = 0;
+  for (auto& str : source) {
+    str = RandomText(4 + Rng()() % 37);
+    bytes += str.size();
+  }
+
+  Measure("column/build/Vector<String>", kStrings, bytes, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<String> strings;
+      for (const auto& str : source) strings.PushBack(String(str.data(), str.size()));
+      DoNotOptimize(strings.Size());
+    }
+  });
+  Measure("column/build/StringColumn", kStrings, bytes, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      StringColumn column;
+      for (const auto& str : source) column.PushBack(StringView(str.data(), str.size()));
+      DoNotOptimize(column.Size());
+    }
+  });
+
+  Vector<String> strings;
+  StringColumn column;
+  for (const auto& str : source) {
+    strings.PushBack(String(str.data(), str.size()));
+    column.PushBack(StringView(str.data(), str.size()));
+  }
+
+  // Every string is read once: how many start with a given prefix.
+  const StringView prefix = "ab";
+  Measure("column/scan/Vector<String>", kStrings, bytes, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t found = 0;
+      for (const String& str : strings) found += str.StartsWith(prefix);
+      DoNotOptimize(found);
+    }
+  });
+  Measure("column/scan/StringColumn", kStrings, bytes, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t found = 0;
+      for (StringView str : column) found += str.StartsWith(prefix);
+      DoNotOptimize(found);
+    }
+  });
+
+  // Neighbours compared in order, as a check that the strings are sorted would.
+  Measure("column/compare/Vector<String>", kStrings - 1, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t ordered = 0;
+      for (size_t i = 1; i < strings.Size(); ++i) ordered += strings[i - 1] < strings[i];
+      DoNotOptimize(ordered);
+    }
+  });
+  Measure("column/compare/StringColumn", kStrings - 1, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      size_t ordered = 0;
+      for (size_t i = 1; i < column.Size(); ++i) ordered += column[i - 1] < column[i];
+      DoNotOptimize(ordered);
+    }
+  });
+
+  // Appending a whole column is one copy of the characters and a pass over the offsets.
+  StringColumn copy;
+  Measure("column/append/StringColumn", kStrings, bytes, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      copy.Clear();
+      copy.Append(column);
+      DoNotOptimize(copy.Size());
+    }
+  });
+
+  std::printf("%-48s %12zu bytes\n", "column/memory/Vector<String>",
+              strings.Capacity() * sizeof(String) + bytes);
+  std::printf("%-48s %12zu bytes\n", "column/memory/StringColumn", (column.Size() + 1) * sizeof(uint32_t) + bytes);
+}
+
+// Keys of one of the shapes the sort benchmark uses.
+String SortKey(bool urls) {
+  if (!urls) {
+    std::string text = RandomText(4 + Rng()() % 37);
+    return String(text.data(), text.size());
+  }
+  // Few distinct hosts and paths: long common prefixes, then a short distinguishing tail.
+  static const char* const kHosts[] = {"https://example.com/", "https://static.example.com/", "https://api.example.org/v2/"};
+  std::string text = kHosts[Rng()() % 3];
+  text += "items/" + std::to_string(Rng()() % 1000) + "/" + RandomText(6);
+  return String(text.data(), text.size());
+}
+
+// Sorting needs a fresh unsorted copy each time, so each sort is timed on its own, best of three.
+template <typename Sort>
+void MeasureSort(const char* name, const Vector<String>& keys, Sort sort) {
+  double best = 0;
+  for (int run = 0; run < 3; ++run) {
+    Vector<String> copy = keys;
+    auto start = std::chrono::steady_clock::now();
+    sort(copy);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    DoNotOptimize(copy[0]);
+    if (run == 0 || seconds < best) best = seconds;
+  }
+  std::printf("%-48s %12.2f ns/op %10.1f ms\n", name, best * 1e9 / keys.Size(), best * 1e3);
+}
+
+void BenchSort() {
+  for (bool urls : {false, true}) {
+    for (size_t size : {size_t(1'000'000), size_t(10'000'000)}) {
+      Vector<String> keys;
+      keys.Reserve(size);
+      for (size_t i = 0; i < size; ++i) keys.PushBack(SortKey(urls));
+      char name[64];
+      const char* shape = urls ? "urls" : "words";
+      std::snprintf(name, sizeof(name), "sort/%s/%zuM/std::sort", shape, size / 1'000'000);
+      MeasureSort(name, keys, [](Vector<String>& strings) { std::sort(strings.Data(), strings.Data() + strings.Size()); });
+      std::snprintf(name, sizeof(name), "sort/%s/%zuM/SortStrings", shape, size / 1'000'000);
+      MeasureSort(name, keys, [](Vector<String>& strings) { SortStrings(strings); });
+      std::snprintf(name, sizeof(name), "sort/%s/%zuM/ParallelSortStrings", shape, size / 1'000'000);
+      MeasureSort(name, keys, [](Vector<String>& strings) { ParallelSortStrings(strings); });
+    }
+  }
+}
+
+// The same element without the IsTriviallyRelocatable opt-in: Vector moves it element by element.
+struct UnmarkedString {
+  String value;
+
+  UnmarkedString(const String& v) : value(v) {}
+  UnmarkedString(const UnmarkedString&) = default;
+  UnmarkedString(UnmarkedString&& other) noexcept : value(std::move(other.value)) {}
+  ~UnmarkedString() {}
+};
+
+// Vector<String> growth with the memcpy relocation String opts in to, against the same strings
+// moved one by one and std::vector<String>; bench_vector has the int, std::string and SharedPtr
+// rows. A million push_backs from empty, and 100000 strings relocated twice (Reserve to twice the
+// size, then ShrinkToFit back).
+void BenchVector() {
+  const size_t kCount = 1'000'000;
+  const String prototype("inline");
+  Measure("vector/push/String/Vector", kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<String> values;
+      for (size_t i = 0; i < kCount; ++i) values.PushBack(prototype);
+      DoNotOptimize(values.Data());
+    }
+  });
+  Measure("vector/push/String/Vector-unmarked", kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      Vector<UnmarkedString> values;
+      for (size_t i = 0; i < kCount; ++i) values.PushBack(UnmarkedString {prototype});
+      DoNotOptimize(values.Data());
+    }
+  });
+  Measure("vector/push/String/std::vector", kCount, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      std::vector<String> values;
+      for (size_t i = 0; i < kCount; ++i) values.push_back(prototype);
+      DoNotOptimize(values.data());
+    }
+  });
+
+  const size_t kRelocated = 100'000;
+  Vector<String> vector(kRelocated, prototype);
+  Vector<UnmarkedString> unmarked(kRelocated, UnmarkedString {prototype});
+  std::vector<String> standard(kRelocated, prototype);
+  Measure("vector/relocate/String/Vector", 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      vector.Reserve(2 * kRelocated);
+      vector.ShrinkToFit();
+    }
+  });
+  Measure("vector/relocate/String/Vector-unmarked", 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      unmarked.Reserve(2 * kRelocated);
+      unmarked.ShrinkToFit();
+    }
+  });
+  Measure("vector/relocate/String/std::vector", 2 * kRelocated, 0, [&](size_t n) {
+    for (size_t it = 0; it < n; ++it) {
+      standard.reserve(2 * kRelocated);
+      standard.shrink_to_fit();
+    }
+  });
+}
+
+struct Benchmark {
+  const char* name;
+  void (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+    {"compare", BenchCompare},
+    {"find", BenchFind},
+    {"matcher", BenchPatternMatcher},
+    {"split", BenchSplit},
+    {"intern", BenchIntern},
+    {"hash", BenchHash},
+    {"build", BenchBuild},
+    {"io", BenchStreamIo},
+    {"load", BenchLoad},
+    {"arena", BenchArena},
+    {"utf8", BenchUtf8},
+    {"numbers", BenchNumbers},
+    {"format", BenchFormat},
+    {"case", BenchCase},
+    {"cow", BenchCopyOnWrite},
+    {"column", BenchColumn},
+    {"sort", BenchSort},
+    {"vector", BenchVector},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  for (const auto& benchmark : kBenchmarks)
+    if (std::strstr(benchmark.name, filter) != nullptr) benchmark.run();
+  return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cerrno>
+#include <unistd.h>
+
+// Owns a POSIX file descriptor and closes it on destruction, so that a throw between open() and
+// the last read leaves nothing open. Keeps errno intact: the error being reported is the one
+// that made the caller give up, not that of close().
+class FileDescriptor {
+public:
+	explicit FileDescriptor(int fd) : Fd_(fd) {};
+	FileDescriptor(const FileDescriptor&) = delete;
+	FileDescriptor& operator= (const FileDescriptor&) = delete;
+	~FileDescriptor() {
+		if (Fd_ < 0) return;
+		int error = errno;
+		close(Fd_);
+		errno = error;
+	};
+
+	int Get() const { return Fd_; };
+	bool Valid() const { return Fd_ >= 0; };
+
+private:
+	int Fd_;
+};
@@ -0,0 +1,207 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "str.hpp"
+
+// Building blocks of Format: the format string parsed at compile time and one piece per argument.
+namespace format_detail {
+
+// A string literal as a template argument: Format<"x = {}">.
+template <size_t N>
+struct FixedString {
+	char Text[N] {};
+	constexpr FixedString(const char (&text)[N]) {
+		for (size_t i = 0; i < N; ++i) Text[i] = text[i];
+	};
+};
+
+// Literal i is Literals[Bounds[i], Bounds[i + 1]) and is followed by argument i, formatted as Specs[i]
+// says; the last literal has no argument after it.
+template <size_t N>
+struct ParsedFormat {
+	char Literals[N] {};
+	size_t Bounds[N + 1] {};
+	char Specs[N] {};
+	size_t Arguments = 0;
+};
+
+// Not constexpr: a call reached while parsing at compile time is the compile error, and the
+// message shows the reason.
+inline void InvalidFormatString(const char *) {}
+
+template <size_t N>
+constexpr ParsedFormat<N> Parse(const FixedString<N>& format) {
+	ParsedFormat<N> parsed;
+	const char *text = format.Text;
+	size_t size = 0;
+	for (size_t i = 0; i + 1 < N; ++i) {
+		if (text[i] == '}') {
+			if (text[i + 1] != '}') InvalidFormatString("'}' has to be written as '}}'");
+			parsed.Literals[size++] = text[i++];
+			continue;
+		}
+		if (text[i] != '{') {
+			parsed.Literals[size++] = text[i];
+			continue;
+		}
+		if (text[i + 1] == '{') {
+			parsed.Literals[size++] = text[i++];
+			continue;
+		}
+		char spec = '\0';
+		if (text[i + 1] == ':') {
+			spec = text[i + 2];
+			if (spec != 'x') InvalidFormatString("the only format spec is {:x}");
+			i += 2;
+		}
+		if (text[i + 1] != '}') InvalidFormatString("'{' has to be closed by '}', or written as '{{'");
+		++i;
+		parsed.Specs[parsed.Arguments] = spec;
+		parsed.Bounds[++parsed.Arguments] = size;
+	}
+	parsed.Bounds[parsed.Arguments + 1] = size;
+	return parsed;
+}
+
+template <FixedString Text>
+inline constexpr ParsedFormat Parsed = Parse(Text);
+
+inline constexpr uint64_t PowersOf10[20] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+	10000000ull, 100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+	10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+	100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull};
+
+// Digits of value in base 10, from its bit length and one table lookup.
+inline size_t DecimalDigits(uint64_t value) {
+	value |= 1;
+	size_t guess = ((64 - __builtin_clzll(value)) * 1233) >> 12;
+	return guess + 1 - (value < PowersOf10[guess]);
+}
+
+// A piece knows its exact Size() before Write(out) puts it at out and returns the end of it,
+// so the whole result is measured, allocated once and written in one pass.
+struct TextPiece {
+	const char *Data;
+	size_t Length;
+	size_t Size() const { return Length; };
+	char *Write(char *out) const {
+		if (Length != 0) memcpy(out, Data, Length);
+		return out + Length;
+	};
+};
+
+struct CharPiece {
+	char Symbol;
+	size_t Size() const { return 1; };
+	char *Write(char *out) const {
+		*out = Symbol;
+		return out + 1;
+	};
+};
+
+template <typename Integer, int Base>
+struct IntegerPiece {
+	Integer Value;
+	size_t Length;
+	explicit IntegerPiece(Integer value) : Value(value) {
+		if constexpr (Base == 16)
+			Length = (67 - __builtin_clzll(value | 1)) / 4;
+		else if constexpr (std::is_signed_v<Integer>)
+			Length = value < 0 ? DecimalDigits(0 - static_cast<uint64_t>(value)) + 1 : DecimalDigits(value);
+		else
+			Length = DecimalDigits(value);
+	};
+	size_t Size() const { return Length; };
+	char *Write(char *out) const { return std::to_chars(out, out + Length, Value, Base).ptr; };
+};
+
+// The shortest form that reads back as the same value; its length is only known once it is
+// written, so it is written at once into the piece.
+template <typename Float>
+struct FloatPiece {
+	char Buffer[32];
+	size_t Length;
+	explicit FloatPiece(Float value) : Length(std::to_chars(Buffer, Buffer + sizeof(Buffer), value).ptr - Buffer) {};
+	size_t Size() const { return Length; };
+	char *Write(char *out) const {
+		memcpy(out, Buffer, Length);
+		return out + Length;
+	};
+};
+
+template <typename T>
+inline constexpr bool Unsupported = false;
+
+template <char Spec, typename T>
+auto MakePiece(const T& value) {
+	if constexpr (Spec == 'x') {
+		static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>,
+			"Format: {:x} takes an integer");
+		return IntegerPiece<uint64_t, 16>(static_cast<std::make_unsigned_t<T>>(value));
+	} else if constexpr (std::is_same_v<T, bool>) {
+		return value ? TextPiece {"true", 4} : TextPiece {"false", 5};
+	} else if constexpr (std::is_same_v<T, char>) {
+		return CharPiece {value};
+	} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+		return IntegerPiece<int64_t, 10>(value);
+	} else if constexpr (std::is_integral_v<T>) {
+		return IntegerPiece<uint64_t, 10>(value);
+	} else if constexpr (std::is_floating_point_v<T>) {
+		return FloatPiece<T>(value);
+	} else if constexpr (std::is_convertible_v<const T&, StringView>) {
+		StringView view = value;
+		return TextPiece {view.Data(), view.Size()};
+	} else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+		std::string_view view = value;
+		return TextPiece {view.data(), view.size()};
+	} else {
+		static_assert(Unsupported<T>, "Format: arguments are integers, floating point, char, bool and strings");
+	}
+}
+
+template <const auto& Format, size_t I>
+char *WriteLiteral(char *out) {
+	constexpr size_t begin = Format.Bounds[I], size = Format.Bounds[I + 1] - begin;
+	if constexpr (size != 0) memcpy(out, Format.Literals + begin, size);
+	return out + size;
+}
+
+}  // namespace format_detail
+
+// printf-style formatting into a String, with the format string parsed at compile time.
+// Every {} is replaced by the next argument: integers and floating point (in the shortest form
+// that reads back as the same value, like AppendDouble), char, bool ("true"/"false") and anything
+// that converts to StringView or std::string_view. {:x} writes an integer in lowercase hexadecimal
+// (negative values as their two's complement); {{ and }} stand for the braces themselves.
+//   FormatTo<"{} {} {}\n">(line, name, value, timestamp);
+// A malformed format string, a wrong number of arguments or an argument of another type does not
+// compile. The arguments are measured first, then the exact total is appended at once.
+template <format_detail::FixedString Text, typename Allocator, typename... Args>
+BasicString<Allocator>& FormatTo(BasicString<Allocator>& out, const Args&... args) {
+	using namespace format_detail;
+	constexpr const auto& parsed = Parsed<Text>;
+	static_assert(parsed.Arguments == sizeof...(Args), "Format: the number of {} differs from the number of arguments");
+
+	return [&]<size_t... I>(std::index_sequence<I...>) -> BasicString<Allocator>& {
+		std::tuple pieces {MakePiece<parsed.Specs[I]>(args)...};
+		size_t size = parsed.Bounds[sizeof...(Args) + 1] + (std::get<I>(pieces).Size() + ... + 0);
+		return out.AppendWith(size, [&](char *cursor) {
+			((cursor = WriteLiteral<Parsed<Text>, I>(cursor), cursor = std::get<I>(pieces).Write(cursor)), ...);
+			WriteLiteral<Parsed<Text>, sizeof...(Args)>(cursor);
+		});
+	}(std::index_sequence_for<Args...>());
+}
+
+// The same into a new String, allocated once.
+template <format_detail::FixedString Text, typename... Args>
+String Format(const Args&... args) {
+	String result;
+	FormatTo<Text>(result, args...);
+	return result;
+}
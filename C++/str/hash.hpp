@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Building blocks of HashBytes.
+namespace hash_detail {
+
+constexpr uint64_t Secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+                                0x4d5a2da51de1aa47ull};
+
+// Full 128-bit product of lhs and rhs: low half in lhs, high half in rhs.
+constexpr void Multiply(uint64_t &lhs, uint64_t &rhs) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+	lhs = static_cast<uint64_t>(product);
+	rhs = static_cast<uint64_t>(product >> 64);
+#else
+	uint64_t ha = lhs >> 32, hb = rhs >> 32, la = static_cast<uint32_t>(lhs), lb = static_cast<uint32_t>(rhs);
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+	uint64_t carry = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+	lhs = lo;
+	rhs = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+constexpr uint64_t Mix(uint64_t lhs, uint64_t rhs) {
+	Multiply(lhs, rhs);
+	return lhs ^ rhs;
+}
+
+inline uint64_t Read8(const unsigned char *p) {
+	uint64_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+inline uint64_t Read4(const unsigned char *p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+// 1 to 3 bytes: the first, the middle and the last one.
+inline uint64_t Read3(const unsigned char *p, size_t size) {
+	return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+}
+
+// The state before any byte, and the last multiply over the final two words a and b; constexpr
+// so that HashEmpty needs no code at run time.
+constexpr uint64_t Start(uint64_t seed) {
+	return seed ^ Mix(seed ^ Secret[0], Secret[1]);
+}
+
+constexpr uint64_t Finish(uint64_t a, uint64_t b, uint64_t seed, size_t size) {
+	a ^= Secret[1];
+	b ^= seed;
+	Multiply(a, b);
+	return Mix(a ^ Secret[0] ^ size, b ^ Secret[1]);
+}
+
+}  // namespace hash_detail
+
+// 64-bit non-cryptographic hash of size bytes at data (wyhash, final version 4).
+//
+// Keys of up to 16 bytes are hashed with two pairs of overlapping loads and one 64x64->128
+// multiply, without a loop; longer input is consumed 48 bytes per
+// iteration by three independent multiply chains. The function is inline so that hashing a
+// short key costs a handful of instructions at the call site. Not suitable against adversaries
+// who can choose keys: pick a random seed if they can.
+inline uint64_t HashBytes(const void *data, size_t size, uint64_t seed = 0) {
+	using namespace hash_detail;
+	const unsigned char *p = static_cast<const unsigned char *>(data);
+	seed = Start(seed);
+	uint64_t a, b;
+	if (size <= 16) {
+		if (size >= 4) {
+			a = (Read4(p) << 32) | Read4(p + ((size >> 3) << 2));
+			b = (Read4(p + size - 4) << 32) | Read4(p + size - 4 - ((size >> 3) << 2));
+		} else if (size > 0) {
+			a = Read3(p, size);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t left = size;
+		if (left >= 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+				see1 = Mix(Read8(p + 16) ^ Secret[2], Read8(p + 24) ^ see1);
+				see2 = Mix(Read8(p + 32) ^ Secret[3], Read8(p + 40) ^ see2);
+				p += 48;
+				left -= 48;
+			} while (left >= 48);
+			seed ^= see1 ^ see2;
+		}
+		while (left > 16) {
+			seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+			p += 16;
+			left -= 16;
+		}
+		// The last 16 bytes, overlapping what was already mixed when fewer are left.
+		a = Read8(p + left - 16);
+		b = Read8(p + left - 8);
+	}
+	return Finish(a, b, seed, size);
+}
+
+// HashBytes of no bytes as a constant expression, for hashes that have to be known before any
+// code runs (the empty InternedString).
+constexpr uint64_t HashEmpty(uint64_t seed = 0) {
+	return hash_detail::Finish(0, 0, hash_detail::Start(seed), 0);
+}
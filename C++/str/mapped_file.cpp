@@ -0,0 +1,77 @@
+#include "mapped_file.hpp"
+#include "file_descriptor.hpp"
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void ThrowErrno(const char *what, const char *path) {
+	throw std::system_error(errno, std::generic_category(), std::string(what) + " " + path);
+}
+
+int AdviceFlag(MappedFile::Advice advice) {
+	switch (advice) {
+		case MappedFile::Advice::Sequential: return MADV_SEQUENTIAL;
+		case MappedFile::Advice::Random: return MADV_RANDOM;
+		case MappedFile::Advice::WillNeed: return MADV_WILLNEED;
+		default: return MADV_NORMAL;
+	}
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const char *path, Advice advice) {
+	FileDescriptor fd(open(path, O_RDONLY | O_CLOEXEC));
+	if (!fd.Valid()) ThrowErrno("MappedFile: cannot open", path);
+
+	struct stat info;
+	if (fstat(fd.Get(), &info) != 0) ThrowErrno("MappedFile: cannot stat", path);
+	if (!S_ISREG(info.st_mode)) {
+		errno = EINVAL;
+		ThrowErrno("MappedFile: not a regular file", path);
+	}
+
+	// An empty file cannot be mapped; it stays an empty view.
+	if (info.st_size > 0) {
+		void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd.Get(), 0);
+		if (data == MAP_FAILED) ThrowErrno("MappedFile: cannot map", path);
+		Data_ = static_cast<const char *>(data);
+		Size_ = static_cast<size_t>(info.st_size);
+	}
+	// The mapping keeps its own reference to the file; fd is closed on return.
+
+	if (advice != Advice::Normal) Advise(advice);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: Data_(std::exchange(other.Data_, nullptr)), Size_(std::exchange(other.Size_, 0)) {}
+
+MappedFile& MappedFile::operator= (MappedFile&& other) noexcept {
+	if (this == &other)
+		return *this;
+
+	MappedFile moved = std::move(other);
+	std::swap(Data_, moved.Data_);
+	std::swap(Size_, moved.Size_);
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	if (Data_ != nullptr) munmap(const_cast<char *>(Data_), Size_);
+}
+
+void MappedFile::Advise(Advice advice, size_t offset, size_t size) const {
+	if (offset >= Size_) return;
+	if (size > Size_ - offset) size = Size_ - offset;
+	// madvise wants a page-aligned start; the mapping itself starts on a page boundary.
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t start = offset & ~(page - 1);
+	// Only a hint: a kernel that ignores it does not make the mapping unusable.
+	madvise(const_cast<char *>(Data_) + start, size + (offset - start), AdviceFlag(advice));
+}
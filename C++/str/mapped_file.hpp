@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include "string_view.hpp"
+
+// Read-only memory mapping of a whole file (POSIX mmap). The contents are read straight from
+// the page cache on first access, without copying them into a buffer, and stay valid until the
+// object is destroyed. Works anywhere a StringView does:
+//   MappedFile file("words.txt");
+//   for (StringView line : Split(file, '\n')) ...
+// Errors (missing file, not a regular file, failed mapping) throw std::system_error.
+class MappedFile {
+public:
+	// How the mapping is going to be read; passed to madvise.
+	enum class Advice {
+		Normal,
+		Sequential,  // read front to back: aggressive read-ahead, pages behind may be dropped
+		Random,      // scattered accesses: no read-ahead
+		WillNeed,    // start reading the range in now
+	};
+
+	MappedFile() {};
+	explicit MappedFile(const char *path, Advice advice = Advice::Sequential);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator= (MappedFile&& other) noexcept;
+	~MappedFile();
+
+	// Hints for bytes [offset, offset + size) of the file; the range is widened to whole pages.
+	void Advise(Advice advice, size_t offset = 0, size_t size = StringView::NPos) const;
+
+	const char *Data() const { return Data_; };
+	size_t Size() const { return Size_; };
+	bool Empty() const { return Size_ == 0; };
+	const char *begin() const { return Data_; };
+	const char *end() const { return Data_ + Size_; };
+
+	operator StringView() const { return StringView(Data_, Size_); };
+
+private:
+	const char *Data_ = nullptr;
+	size_t Size_ = 0;
+};
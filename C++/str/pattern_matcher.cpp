@@ -0,0 +1,94 @@
+#include "pattern_matcher.hpp"
+#include <limits>
+#include <stdexcept>
+
+PatternMatcher::PatternMatcher(const Vector<String>& patterns) {
+	// Column 0 stands for every byte that no pattern uses.
+	Columns_ = 1;
+	for (size_t p = 0; p < patterns.Size(); ++p)
+		for (size_t i = 0; i < patterns[p].Size(); ++i) {
+			uint32_t &column = Classes_[static_cast<unsigned char>(patterns[p][i])];
+			if (column == 0) column = Columns_++;
+		}
+
+	// Trie over columns; 0 marks a missing edge since the root is nobody's child.
+	std::vector<uint32_t> next(Columns_, 0);
+	std::vector<std::vector<uint32_t>> outputs(1);
+	Lengths_.reserve(patterns.Size());
+	for (size_t p = 0; p < patterns.Size(); ++p) {
+		const String& pattern = patterns[p];
+		Lengths_.push_back(static_cast<uint32_t>(pattern.Size()));
+		if (pattern.Empty()) continue;
+
+		size_t state = 0;
+		for (size_t i = 0; i < pattern.Size(); ++i) {
+			uint32_t column = Classes_[static_cast<unsigned char>(pattern[i])];
+			if (next[state * Columns_ + column] == 0) {
+				next[state * Columns_ + column] = static_cast<uint32_t>(outputs.size());
+				next.resize(next.size() + Columns_, 0);
+				outputs.emplace_back();
+			}
+			state = next[state * Columns_ + column];
+		}
+		outputs[state].push_back(static_cast<uint32_t>(p));
+	}
+
+	size_t states = outputs.size();
+	if (states * Columns_ > std::numeric_limits<uint32_t>::max())
+		throw std::length_error("PatternMatcher: too many patterns");
+
+	// Breadth-first pass: every missing edge becomes the edge of the failure state, which is
+	// shallower and therefore already complete, and every state inherits its failure state's outputs.
+	std::vector<uint32_t> fail(states, 0), order;
+	order.reserve(states);
+	order.push_back(0);
+	for (size_t head = 0; head < order.size(); ++head) {
+		uint32_t state = order[head];
+		for (uint32_t column = 0; column < Columns_; ++column) {
+			uint32_t &edge = next[state * Columns_ + column];
+			uint32_t fallback = state == 0 ? 0 : next[fail[state] * Columns_ + column];
+			if (edge == 0) {
+				edge = fallback;
+				continue;
+			}
+			fail[edge] = fallback;
+			// Longer patterns first: the child's own ones, then those inherited through its failure link.
+			outputs[edge].insert(outputs[edge].end(), outputs[fallback].begin(), outputs[fallback].end());
+			order.push_back(edge);
+		}
+	}
+
+	// Renumber so that states without outputs come first; the root keeps number 0.
+	std::vector<uint32_t> renamed(states);
+	uint32_t id = 0;
+	for (size_t state = 0; state < states; ++state)
+		if (outputs[state].empty()) renamed[state] = id++;
+	FirstOutput_ = id * Columns_;
+	OutputBegin_.push_back(0);
+	for (size_t state = 0; state < states; ++state)
+		if (!outputs[state].empty()) {
+			renamed[state] = id++;
+			Outputs_.insert(Outputs_.end(), outputs[state].begin(), outputs[state].end());
+			OutputBegin_.push_back(static_cast<uint32_t>(Outputs_.size()));
+		}
+
+	Transitions_.resize(states * Columns_);
+	for (size_t state = 0; state < states; ++state)
+		for (uint32_t column = 0; column < Columns_; ++column)
+			Transitions_[renamed[state] * Columns_ + column] = renamed[next[state * Columns_ + column]] * Columns_;
+}
+
+Vector<PatternMatcher::Match> PatternMatcher::FindAll(const String& text) const {
+	Vector<Match> matches;
+	Scan(text, [&](const Match& match) { matches.PushBack(match); });
+	return matches;
+}
+
+bool PatternMatcher::ContainsAny(const char *data, size_t size) const {
+	uint32_t state = 0;
+	for (size_t i = 0; i < size; ++i) {
+		state = Transitions_[state + Classes_[static_cast<unsigned char>(data[i])]];
+		if (state >= FirstOutput_) return true;
+	}
+	return false;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../vector.cpp"
+#include "str.hpp"
+
+// Finds every occurrence of a fixed set of patterns in one pass over the text (Aho-Corasick).
+//
+// The automaton is compiled into a dense transition table: bytes that occur in no pattern share
+// one column, every other byte gets its own, and each row already contains the failure
+// transitions, so a scan costs one table load per input byte however many patterns there are.
+// States that end a pattern are numbered last, so the per-byte match test is one comparison.
+class PatternMatcher {
+public:
+	struct Match {
+		size_t Pattern;   // index into the patterns the matcher was built from
+		size_t Position;  // offset of the first byte of the match in the text
+	};
+
+	// Empty patterns never match and are skipped.
+	explicit PatternMatcher(const Vector<String>& patterns);
+
+	// Calls on_match(Match) for every occurrence, ordered by the end of the match;
+	// patterns that end at the same byte are reported longest first.
+	template <typename OnMatch>
+	void Scan(const char *data, size_t size, OnMatch&& on_match) const {
+		uint32_t state = 0;
+		for (size_t i = 0; i < size; ++i) {
+			state = Transitions_[state + Classes_[static_cast<unsigned char>(data[i])]];
+			if (state >= FirstOutput_) {
+				size_t row = (state - FirstOutput_) / Columns_;
+				for (uint32_t k = OutputBegin_[row]; k < OutputBegin_[row + 1]; ++k)
+					on_match(Match{Outputs_[k], i + 1 - Lengths_[Outputs_[k]]});
+			}
+		}
+	};
+
+	template <typename OnMatch>
+	void Scan(const String& text, OnMatch&& on_match) const { Scan(text.Data(), text.Size(), on_match); };
+
+	Vector<Match> FindAll(const String& text) const;
+	// Stops at the first byte that completes any pattern.
+	bool ContainsAny(const char *data, size_t size) const;
+	bool ContainsAny(const String& text) const { return ContainsAny(text.Data(), text.Size()); };
+
+	size_t PatternCount() const { return Lengths_.size(); };
+	size_t StateCount() const { return Columns_ == 0 ? 0 : Transitions_.size() / Columns_; };
+
+private:
+	// Byte -> column of the transition table.
+	uint32_t Classes_[256] = {};
+	uint32_t Columns_ = 0;
+	// Row-major, Columns_ entries per state. States are stored as the offset of their row.
+	std::vector<uint32_t> Transitions_;
+	// Row offset of the first state that ends at least one pattern.
+	uint32_t FirstOutput_ = 0;
+	// Patterns ending in the i-th output state are Outputs_[OutputBegin_[i] .. OutputBegin_[i + 1]).
+	std::vector<uint32_t> OutputBegin_;
+	std::vector<uint32_t> Outputs_;
+	std::vector<uint32_t> Lengths_;
+};
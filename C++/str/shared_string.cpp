@@ -0,0 +1,71 @@
+#include "shared_string.hpp"
+#include <algorithm>
+#include <new>
+
+SharedString::SharedString(const char *data, size_t size) {
+	if (size == 0) return;
+	Block_ = NewBlock(size);
+	memcpy(Block_->Chars(), data, size);
+	SetSize(size);
+}
+
+SharedString::SharedString(const SharedString& other) : Block_(other.Block_) {
+	if (Block_ == nullptr) return;
+	if (!Block_->Unshareable) {
+		Acquire();
+		return;
+	}
+	Block_ = NewBlock(other.Size());
+	memcpy(Block_->Chars(), other.Data(), other.Size());
+	SetSize(other.Size());
+}
+
+SharedString::Block *SharedString::NewBlock(size_t capacity) {
+	void *memory = ::operator new(sizeof(Block) + capacity + 1);
+	Block *block = new (memory) Block {{1}, 0, capacity, false};
+	block->Chars()[0] = '\0';
+	return block;
+}
+
+// Copies what fits of the characters into a fresh buffer owned by this string alone.
+void SharedString::Detach(size_t capacity) {
+	// Growing at least doubles, so that a loop of PushBack or Append stays amortized O(1).
+	if (capacity > Capacity()) capacity = std::max(capacity, 2 * Capacity());
+	size_t kept = std::min(Size(), capacity);
+	Block *fresh = NewBlock(capacity);
+	if (kept != 0) memcpy(fresh->Chars(), Block_->Chars(), kept);
+	Release(Block_);
+	Block_ = fresh;
+	SetSize(kept);
+}
+
+SharedString& SharedString::Append(StringView view) {
+	if (view.Empty()) return *this;
+	size_t size = Size();
+	if (Unique() && Block_->Capacity >= size + view.Size()) {
+		// view may point into the buffer, but only below size.
+		memcpy(Block_->Chars() + size, view.Data(), view.Size());
+	} else {
+		// Holds the old buffer until view, which may point into it, has been copied; a copy of an
+		// unshareable string would not share it.
+		SharedString keep;
+		keep.Block_ = Block_;
+		Acquire();
+		Detach(size + view.Size());
+		memcpy(Block_->Chars() + size, view.Data(), view.Size());
+	}
+	SetSize(size + view.Size());
+	return *this;
+}
+
+void SharedString::Resize(size_t new_size, char symbol) {
+	size_t size = Size();
+	if (new_size == size) return;
+	Prepare(new_size);
+	if (new_size > size) memset(Block_->Chars() + size, symbol, new_size - size);
+	SetSize(new_size);
+}
+
+std::ostream& operator<< (std::ostream& stream, const SharedString& str) {
+	return stream.write(str.Data(), str.Size());
+}
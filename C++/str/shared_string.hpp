@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include "str.hpp"
+
+// Copy-on-write string: copies share one reference-counted buffer, so passing a SharedString
+// by value costs an atomic increment instead of an allocation and a memcpy. The buffer is
+// immutable while it is shared; the first mutation through a copy (non-const operator[],
+// PushBack, Append, Resize, ...) gives that copy a buffer of its own. The count is atomic, so
+// copies may be handed to and destroyed on other threads; one object is still not to be used
+// by two threads at once, as with any other type.
+//
+// Reads through a non-const object pick the mutable operator[] and detach. The reference it
+// returns may be written later, so it also makes the buffer unshareable: copies taken from then
+// on copy the characters at once, as std::string did when it was copy-on-write. A buffer stays
+// so until this string gets another one. Read shared strings through a const reference or View().
+class SharedString {
+public:
+	SharedString() {};
+	SharedString(const char *data, size_t size);
+	SharedString(const char *CStr) : SharedString(CStr, CStr == nullptr ? 0 : strlen(CStr)) {};
+	explicit SharedString(StringView view) : SharedString(view.Data(), view.Size()) {};
+
+	SharedString(const SharedString& other);
+	SharedString(SharedString&& other) noexcept : Block_(other.Block_) { other.Block_ = nullptr; };
+	SharedString& operator= (const SharedString& other) {
+		SharedString copy(other);
+		Swap(copy);
+		return *this;
+	};
+	SharedString& operator= (SharedString&& other) noexcept {
+		SharedString moved(std::move(other));
+		Swap(moved);
+		return *this;
+	};
+	~SharedString() { Release(Block_); };
+
+	void Swap(SharedString& other) noexcept { std::swap(Block_, other.Block_); };
+
+	size_t Size() const { return Block_ == nullptr ? 0 : Block_->Size; };
+	size_t Length() const { return Size(); };
+	bool Empty() const { return Size() == 0; };
+	size_t Capacity() const { return Block_ == nullptr ? 0 : Block_->Capacity; };
+	// Number of strings sharing the buffer; 0 for an empty string that has none.
+	size_t UseCount() const { return Block_ == nullptr ? 0 : Block_->Refs.load(std::memory_order_acquire); };
+
+	const char *Data() const { return Block_ == nullptr ? "" : Block_->Chars(); };
+	const char *CStr() const { return Data(); };
+	const char *begin() const { return Data(); };
+	const char *end() const { return Data() + Size(); };
+	StringView View() const { return StringView(Data(), Size()); };
+	operator StringView() const { return View(); };
+	// An independent String with the same characters.
+	String ToString() const { return String(Data(), Size()); };
+
+	const char& operator[] (size_t i) const { return Data()[i]; };
+	const char& Front() const { return Data()[0]; };
+	const char& Back() const { return Data()[Size() - 1]; };
+
+	// The mutators below detach a shared buffer first.
+	char& operator[] (size_t i) { return MutableData()[i]; };
+
+	void PushBack(char symbol) {
+		size_t size = Size();
+		Prepare(size + 1);
+		Block_->Chars()[size] = symbol;
+		SetSize(size + 1);
+	};
+	char PopBack() {
+		if (Empty()) return '\0';
+		char symbol = Back();
+		Resize(Size() - 1, '\0');
+		return symbol;
+	};
+	SharedString& Append(StringView view);
+	SharedString& operator+= (StringView view) { return Append(view); };
+	void Resize(size_t new_size, char symbol);
+	void Reserve(size_t new_capacity) {
+		if (Capacity() < new_capacity) Prepare(new_capacity);
+	};
+	// Drops this copy's reference; the others keep the characters.
+	void Clear() { SharedString().Swap(*this); };
+
+	uint64_t Hash(uint64_t seed = 0) const { return HashBytes(Data(), Size(), seed); };
+
+	friend bool operator== (const SharedString& lhs, const SharedString& rhs) {
+		return lhs.Block_ == rhs.Block_ || lhs.View() == rhs.View();
+	};
+	friend int operator<=> (const SharedString& lhs, const SharedString& rhs) { return lhs.View() <=> rhs.View(); };
+
+private:
+	// Header of a buffer; Capacity + 1 characters follow it.
+	struct Block {
+		std::atomic<size_t> Refs;
+		size_t Size;
+		size_t Capacity;
+		// A mutable reference into the characters has been handed out. Only set while Refs is 1,
+		// by the one owner, and read by that owner when it is copied.
+		bool Unshareable;
+
+		char *Chars() { return reinterpret_cast<char *>(this + 1); };
+	};
+
+	Block *Block_ = nullptr;
+
+	static Block *NewBlock(size_t capacity);
+
+	void Acquire() {
+		if (Block_ != nullptr) Block_->Refs.fetch_add(1, std::memory_order_relaxed);
+	};
+	// The release decrement orders this owner's writes before the free; the thread that frees
+	// synchronizes with every other owner's release.
+	static void Release(Block *block) {
+		if (block != nullptr && block->Refs.fetch_sub(1, std::memory_order_acq_rel) == 1) ::operator delete(block);
+	};
+
+	bool Unique() const { return Block_ != nullptr && Block_->Refs.load(std::memory_order_acquire) == 1; };
+
+	// Makes the buffer unshared with room for capacity characters.
+	void Prepare(size_t capacity) {
+		if (!Unique() || Block_->Capacity < capacity) Detach(capacity);
+	};
+	void Detach(size_t capacity);
+
+	char *MutableData() {
+		Prepare(Size());
+		Block_->Unshareable = true;
+		return Block_->Chars();
+	};
+
+	void SetSize(size_t size) {
+		Block_->Size = size;
+		Block_->Chars()[size] = '\0';
+	};
+};
+
+std::ostream& operator<< (std::ostream& stream, const SharedString& str);
+
+// One pointer to the shared block.
+template <>
+struct IsTriviallyRelocatable<SharedString> : std::true_type {};
+
+template <>
+struct std::hash<SharedString> {
+	size_t operator()(const SharedString& str) const { return str.Hash(); };
+};
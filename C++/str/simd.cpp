@@ -0,0 +1,313 @@
+#include "simd.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#define STR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#include "simd_kernels.hpp"
+
+namespace {
+
+// Needles up to this length are searched with the first/last byte filter; longer ones with
+// Two-Way, which stays linear in the haystack whatever the needle looks like.
+constexpr size_t FilterNeedleLimit = 64;
+
+// Byte access to the haystack and the needle, read forwards or back to front. Running Two-Way
+// over reversed bytes finds the last occurrence instead of the first.
+struct Forward {
+	const unsigned char *Data;
+	Forward(const char *data, size_t) : Data(reinterpret_cast<const unsigned char *>(data)) {};
+	unsigned char operator[](size_t i) const { return Data[i]; };
+};
+
+struct Backward {
+	const unsigned char *End;
+	Backward(const char *data, size_t size) : End(reinterpret_cast<const unsigned char *>(data) + size) {};
+	unsigned char operator[](size_t i) const { return End[-1 - static_cast<ptrdiff_t>(i)]; };
+};
+
+// Splits needle into u v with a maximal period, as in Crochemore and Perrin's Two-Way algorithm.
+template <typename Bytes>
+size_t CriticalFactorization(const Bytes& needle, size_t needle_size, size_t *period) {
+	size_t max_suffix = ~size_t(0), j = 0, k = 1, p = 1;
+	while (j + k < needle_size) {
+		unsigned char a = needle[j + k], b = needle[max_suffix + k];
+		if (a < b) { j += k; k = 1; p = j - max_suffix; }
+		else if (a == b) { if (k != p) ++k; else { j += p; k = 1; } }
+		else { max_suffix = j++; k = p = 1; }
+	}
+	*period = p;
+
+	size_t max_suffix_rev = ~size_t(0);
+	j = 0; k = p = 1;
+	while (j + k < needle_size) {
+		unsigned char a = needle[j + k], b = needle[max_suffix_rev + k];
+		if (b < a) { j += k; k = 1; p = j - max_suffix_rev; }
+		else if (a == b) { if (k != p) ++k; else { j += p; k = 1; } }
+		else { max_suffix_rev = j++; k = p = 1; }
+	}
+	if (max_suffix_rev + 1 < max_suffix + 1) return max_suffix + 1;
+	*period = p;
+	return max_suffix_rev + 1;
+}
+
+// Two-Way search with a bad-character shift on the last needle byte. Returns the offset of the
+// first match in the order Bytes reads, or size when there is none.
+template <typename Bytes>
+size_t TwoWay(const char *haystack_data, size_t size, const char *needle_data, size_t needle_size) {
+	Bytes haystack(haystack_data, size), needle(needle_data, needle_size);
+	size_t period;
+	size_t suffix = CriticalFactorization(needle, needle_size, &period);
+
+	size_t shift_table[256];
+	for (size_t &shift : shift_table) shift = needle_size;
+	for (size_t i = 0; i < needle_size; ++i) shift_table[needle[i]] = needle_size - i - 1;
+
+	bool periodic = true;
+	for (size_t i = 0; i < suffix && periodic; ++i) periodic = needle[i] == needle[i + period];
+	if (!periodic) period = (suffix > needle_size - suffix ? suffix : needle_size - suffix) + 1;
+
+	size_t memory = 0, j = 0;
+	while (j <= size - needle_size) {
+		size_t shift = shift_table[haystack[j + needle_size - 1]];
+		if (shift > 0) {
+			if (memory != 0 && shift < period) shift = needle_size - period;
+			memory = 0;
+			j += shift;
+			continue;
+		}
+
+		size_t i = suffix > memory ? suffix : memory;
+		while (i < needle_size - 1 && needle[i] == haystack[i + j]) ++i;
+		if (i < needle_size - 1) {
+			j += i - suffix + 1;
+			memory = 0;
+			continue;
+		}
+
+		i = suffix - 1;
+		while (memory < i + 1 && needle[i] == haystack[i + j]) --i;
+		if (i + 1 < memory + 1) return j;
+		j += period;
+		// Only a periodic needle may skip the prefix it has already matched.
+		memory = periodic ? needle_size - period : 0;
+	}
+	return size;
+}
+
+const char *FindLong(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	size_t offset = TwoWay<Forward>(haystack, size, needle, needle_size);
+	return offset == size ? nullptr : haystack + offset;
+}
+
+const char *RFindLong(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	size_t offset = TwoWay<Backward>(haystack, size, needle, needle_size);
+	return offset == size ? nullptr : haystack + size - offset - needle_size;
+}
+
+const char *FindFirstOfTable(const char *haystack, size_t size, const char *symbols, size_t symbols_size) {
+	bool table[256] = {};
+	for (size_t k = 0; k < symbols_size; ++k) table[static_cast<unsigned char>(symbols[k])] = true;
+	for (size_t i = 0; i < size; ++i)
+		if (table[static_cast<unsigned char>(haystack[i])]) return haystack + i;
+	return nullptr;
+}
+
+#ifndef STR_SIMD_X86
+
+bool EqualPortable(const char *lhs, const char *rhs, size_t size) {
+	return size == 0 || memcmp(lhs, rhs, size) == 0;
+}
+
+int ComparePortable(const char *lhs, const char *rhs, size_t size) {
+	int result = size == 0 ? 0 : memcmp(lhs, rhs, size);
+	return (result > 0) - (result < 0);
+}
+
+const char *RFindBytePortable(const char *haystack, size_t size, char symbol) {
+	while (size-- > 0)
+		if (haystack[size] == symbol) return haystack + size;
+	return nullptr;
+}
+
+bool ValidUtf8Portable(const char *data, size_t size) {
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+	for (size_t i = 0, length; i < size; i += length)
+		if ((length = Utf8SequenceLength(p + i, size - i)) == 0) return false;
+	return true;
+}
+
+size_t CountCodePointsPortable(const char *data, size_t size) {
+	size_t count = 0;
+	for (size_t i = 0; i < size; ++i) count += static_cast<signed char>(data[i]) >= -64;
+	return count;
+}
+
+#else
+
+struct Sse2Lanes {
+	static constexpr size_t Width = 16;
+	static constexpr unsigned FullMask = 0xFFFFu;
+	using Vector = __m128i;
+
+	static Vector Load(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+	static Vector Broadcast(char symbol) { return _mm_set1_epi8(symbol); }
+	static unsigned EqualMask(Vector a, Vector b) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+	}
+	static unsigned SignMask(Vector a) { return static_cast<unsigned>(_mm_movemask_epi8(a)); }
+	static unsigned LessMask(Vector a, Vector b) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(a, b)));
+	}
+	static void Store(char *p, Vector v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+	static Vector Add(Vector a, Vector b) { return _mm_add_epi8(a, b); }
+	static Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+	static Vector Xor(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+	static Vector Less(Vector a, Vector b) { return _mm_cmplt_epi8(a, b); }
+};
+
+// STR_SIMD_NO_AVX2 in the environment forces the SSE2 kernels, to test and benchmark them.
+bool HasAvx2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && getenv("STR_SIMD_NO_AVX2") == nullptr;
+}
+
+// STR_SIMD_NO_SSSE3 likewise leaves UTF-8 validation to the SSE2 decoder.
+bool HasSsse3() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3") && getenv("STR_SIMD_NO_SSSE3") == nullptr;
+}
+
+#endif
+
+// Names the AVX2, SSE2 and portable variants of a kernel; only the ones built for this
+// architecture are referenced.
+#ifdef STR_SIMD_X86
+#define STR_KERNEL(avx2, sse2, portable) (HasAvx2() ? avx2 : sse2)
+#else
+#define STR_KERNEL(avx2, sse2, portable) (portable)
+#endif
+
+using EqualKernel = bool(const char *, const char *, size_t);
+using CompareKernel = int(const char *, const char *, size_t);
+using FindKernel = const char *(const char *, size_t, const char *, size_t);
+using FindByteKernel = const char *(const char *, size_t, char);
+using ValidKernel = bool(const char *, size_t);
+using CountKernel = size_t(const char *, size_t);
+using MapKernel = void(const char *, size_t, char *);
+using SkipKernel = const char *(const char *, size_t);
+
+EqualKernel *ChooseEqual() { return STR_KERNEL(EqualAvx2, SimdEqual<Sse2Lanes>, EqualPortable); }
+CompareKernel *ChooseCompare() { return STR_KERNEL(CompareAvx2, SimdCompare<Sse2Lanes>, ComparePortable); }
+FindKernel *ChooseFind() { return STR_KERNEL(FindAvx2, SimdFind<Sse2Lanes>, FindLong); }
+FindKernel *ChooseRFind() { return STR_KERNEL(RFindAvx2, SimdRFind<Sse2Lanes>, RFindLong); }
+FindByteKernel *ChooseRFindByte() { return STR_KERNEL(RFindByteAvx2, SimdRFindByte<Sse2Lanes>, RFindBytePortable); }
+FindKernel *ChooseFindFirstOf() { return STR_KERNEL(FindFirstOfAvx2, SimdFindFirstOf<Sse2Lanes>, FindFirstOfTable); }
+ValidKernel *ChooseValidUtf8() {
+#ifdef STR_SIMD_X86
+	if (!HasAvx2() && HasSsse3()) return ValidUtf8Ssse3;
+#endif
+	return STR_KERNEL(ValidUtf8Avx2, SimdValidUtf8<Sse2Lanes>, ValidUtf8Portable);
+}
+CountKernel *ChooseCountCodePoints() {
+	return STR_KERNEL(CountCodePointsAvx2, SimdCountCodePoints<Sse2Lanes>, CountCodePointsPortable);
+}
+MapKernel *ChooseToLower() { return STR_KERNEL(ToLowerAvx2, (SimdMapCase<Sse2Lanes, 'A'>), (MapCaseWords<'A'>)); }
+MapKernel *ChooseToUpper() { return STR_KERNEL(ToUpperAvx2, (SimdMapCase<Sse2Lanes, 'a'>), (MapCaseWords<'a'>)); }
+EqualKernel *ChooseEqualIgnoreCase() {
+	return STR_KERNEL(EqualIgnoreCaseAvx2, SimdEqualIgnoreCase<Sse2Lanes>, EqualIgnoreCaseWords);
+}
+SkipKernel *ChooseSkipSpace() { return STR_KERNEL(SkipSpaceAvx2, SimdSkipSpace<Sse2Lanes>, SkipSpaceWords); }
+SkipKernel *ChooseRSkipSpace() { return STR_KERNEL(RSkipSpaceAvx2, SimdRSkipSpace<Sse2Lanes>, RSkipSpaceWords); }
+
+#undef STR_KERNEL
+
+// A kernel pointer that starts at Resolve, which installs Choose() on the first call,
+// so later calls cost one relaxed load and an indirect call.
+template <typename Signature, Signature *(*Choose)()>
+struct Dispatch;
+
+template <typename Result, typename... Args, Result (*(*Choose)())(Args...)>
+struct Dispatch<Result(Args...), Choose> {
+	static Result Resolve(Args... args) {
+		auto kernel = Choose();
+		Current.store(kernel, std::memory_order_relaxed);
+		return kernel(args...);
+	}
+
+	static inline std::atomic<Result (*)(Args...)> Current {Resolve};
+
+	static Result Call(Args... args) { return Current.load(std::memory_order_relaxed)(args...); }
+};
+
+}
+
+bool BytesEqual(const char *lhs, const char *rhs, size_t size) {
+	return Dispatch<EqualKernel, ChooseEqual>::Call(lhs, rhs, size);
+}
+
+int BytesCompare(const char *lhs, const char *rhs, size_t size) {
+	return Dispatch<CompareKernel, ChooseCompare>::Call(lhs, rhs, size);
+}
+
+const char *BytesFind(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	if (needle_size == 0) return haystack;
+	if (needle_size > size) return nullptr;
+	if (needle_size == 1) return static_cast<const char *>(memchr(haystack, needle[0], size));
+	if (needle_size <= FilterNeedleLimit)
+		return Dispatch<FindKernel, ChooseFind>::Call(haystack, size, needle, needle_size);
+	return FindLong(haystack, size, needle, needle_size);
+}
+
+const char *BytesRFind(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	if (needle_size == 0) return haystack + size;
+	if (needle_size > size) return nullptr;
+	if (needle_size == 1) return BytesRFindByte(haystack, size, needle[0]);
+	if (needle_size <= FilterNeedleLimit)
+		return Dispatch<FindKernel, ChooseRFind>::Call(haystack, size, needle, needle_size);
+	return RFindLong(haystack, size, needle, needle_size);
+}
+
+const char *BytesRFindByte(const char *haystack, size_t size, char symbol) {
+	return Dispatch<FindByteKernel, ChooseRFindByte>::Call(haystack, size, symbol);
+}
+
+const char *BytesFindFirstOf(const char *haystack, size_t size, const char *symbols, size_t symbols_size) {
+	if (symbols_size == 0) return nullptr;
+	if (symbols_size == 1) return static_cast<const char *>(memchr(haystack, symbols[0], size));
+	if (symbols_size <= MaxSimdSet)
+		return Dispatch<FindKernel, ChooseFindFirstOf>::Call(haystack, size, symbols, symbols_size);
+	return FindFirstOfTable(haystack, size, symbols, symbols_size);
+}
+
+bool BytesValidUtf8(const char *data, size_t size) {
+	return Dispatch<ValidKernel, ChooseValidUtf8>::Call(data, size);
+}
+
+size_t BytesCountCodePoints(const char *data, size_t size) {
+	return Dispatch<CountKernel, ChooseCountCodePoints>::Call(data, size);
+}
+
+void BytesToLower(const char *data, size_t size, char *out) {
+	Dispatch<MapKernel, ChooseToLower>::Call(data, size, out);
+}
+
+void BytesToUpper(const char *data, size_t size, char *out) {
+	Dispatch<MapKernel, ChooseToUpper>::Call(data, size, out);
+}
+
+bool BytesEqualIgnoreCase(const char *lhs, const char *rhs, size_t size) {
+	return Dispatch<EqualKernel, ChooseEqualIgnoreCase>::Call(lhs, rhs, size);
+}
+
+const char *BytesSkipSpace(const char *data, size_t size) {
+	return Dispatch<SkipKernel, ChooseSkipSpace>::Call(data, size);
+}
+
+const char *BytesRSkipSpace(const char *data, size_t size) {
+	return Dispatch<SkipKernel, ChooseRSkipSpace>::Call(data, size);
+}
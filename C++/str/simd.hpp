@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+
+// Byte kernels behind String. Each one picks an AVX2, SSE2 or portable implementation
+// on first use, based on what CPUID reports for the running machine.
+// simd.cpp, simd_ssse3.cpp and simd_avx2.cpp all have to be linked in.
+
+// true if the first size bytes of lhs and rhs are the same, embedded '\0' included.
+bool BytesEqual(const char *lhs, const char *rhs, size_t size);
+
+// Compares the first size bytes as unsigned char (like memcmp) and returns -1, 0 or 1.
+int BytesCompare(const char *lhs, const char *rhs, size_t size);
+
+// The searches return a pointer to the match inside haystack, or nullptr if there is none.
+// An empty needle matches at the start (BytesFind) or at the end (BytesRFind) of the haystack.
+const char *BytesFind(const char *haystack, size_t size, const char *needle, size_t needle_size);
+const char *BytesRFind(const char *haystack, size_t size, const char *needle, size_t needle_size);
+const char *BytesRFindByte(const char *haystack, size_t size, char symbol);
+// First byte of haystack that is one of symbols.
+const char *BytesFindFirstOf(const char *haystack, size_t size, const char *symbols, size_t symbols_size);
+
+// true if the bytes are well-formed UTF-8 (see utf8.hpp). AVX2 and SSSE3 run the lookup-table
+// validator of Keiser and Lemire, 32 and 16 bytes per step; SSE2 alone, without a byte shuffle,
+// skips ASCII blocks and decodes the rest.
+bool BytesValidUtf8(const char *data, size_t size);
+// Number of bytes that are not UTF-8 continuation bytes (10xxxxxx): the number of code points
+// in valid UTF-8.
+size_t BytesCountCodePoints(const char *data, size_t size);
+
+// ASCII case mapping and whitespace, byte by byte: bytes outside A-Z / a-z, UTF-8 sequences
+// included, are left alone. out may be data itself.
+void BytesToLower(const char *data, size_t size, char *out);
+void BytesToUpper(const char *data, size_t size, char *out);
+bool BytesEqualIgnoreCase(const char *lhs, const char *rhs, size_t size);
+// First byte that is not ASCII whitespace (space, \t, \n, \v, \f, \r), or data + size.
+const char *BytesSkipSpace(const char *data, size_t size);
+// End of the last byte that is not ASCII whitespace, or data.
+const char *BytesRSkipSpace(const char *data, size_t size);
@@ -0,0 +1,106 @@
+// AVX2 instantiations of the kernels in simd_kernels.hpp. Everything after the pragma is compiled
+// for AVX2, so the standard headers are included first and keep their default target.
+#include <cstddef>
+#include <cstring>
+#include "utf8.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+#pragma GCC target("avx2")
+#include "simd_kernels.hpp"
+
+namespace {
+
+struct Avx2Lanes {
+	static constexpr size_t Width = 32;
+	static constexpr unsigned FullMask = 0xFFFFFFFFu;
+	using Vector = __m256i;
+
+	static Vector Load(const char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+	static Vector Broadcast(char symbol) { return _mm256_set1_epi8(symbol); }
+	static unsigned EqualMask(Vector a, Vector b) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+	}
+	static unsigned SignMask(Vector a) { return static_cast<unsigned>(_mm256_movemask_epi8(a)); }
+	static unsigned LessMask(Vector a, Vector b) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(b, a)));
+	}
+	static void Store(char *p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+	static Vector Add(Vector a, Vector b) { return _mm256_add_epi8(a, b); }
+	static Vector And(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+	static Vector Xor(Vector a, Vector b) { return _mm256_xor_si256(a, b); }
+	static Vector Less(Vector a, Vector b) { return _mm256_cmpgt_epi8(b, a); }
+
+	static Vector Or(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+	static Vector Zero() { return _mm256_setzero_si256(); }
+	static Vector SubSaturate(Vector a, Vector b) { return _mm256_subs_epu8(a, b); }
+	static Vector HighNibble(Vector v) { return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)); }
+	static Vector Table(char b0, char b1, char b2, char b3, char b4, char b5, char b6, char b7,
+			char b8, char b9, char b10, char b11, char b12, char b13, char b14, char b15) {
+		return _mm256_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15,
+			b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15);
+	}
+	static Vector Lookup(Vector table, Vector v) { return _mm256_shuffle_epi8(table, v); }
+	template <int N>
+	static Vector Previous(Vector block, Vector previous) {
+		return _mm256_alignr_epi8(block, _mm256_permute2x128_si256(previous, block, 0x21), 16 - N);
+	}
+	static bool AnySet(Vector v) { return !_mm256_testz_si256(v, v); }
+};
+
+}
+
+bool EqualAvx2(const char *lhs, const char *rhs, size_t size) {
+	return SimdEqual<Avx2Lanes>(lhs, rhs, size);
+}
+
+int CompareAvx2(const char *lhs, const char *rhs, size_t size) {
+	return SimdCompare<Avx2Lanes>(lhs, rhs, size);
+}
+
+const char *FindAvx2(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	return SimdFind<Avx2Lanes>(haystack, size, needle, needle_size);
+}
+
+const char *RFindAvx2(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	return SimdRFind<Avx2Lanes>(haystack, size, needle, needle_size);
+}
+
+const char *RFindByteAvx2(const char *haystack, size_t size, char symbol) {
+	return SimdRFindByte<Avx2Lanes>(haystack, size, symbol);
+}
+
+const char *FindFirstOfAvx2(const char *haystack, size_t size, const char *symbols, size_t symbols_size) {
+	return SimdFindFirstOf<Avx2Lanes>(haystack, size, symbols, symbols_size);
+}
+
+bool ValidUtf8Avx2(const char *data, size_t size) {
+	return LookupValidUtf8<Avx2Lanes>(data, size);
+}
+
+size_t CountCodePointsAvx2(const char *data, size_t size) {
+	return SimdCountCodePoints<Avx2Lanes>(data, size);
+}
+
+void ToLowerAvx2(const char *data, size_t size, char *out) {
+	SimdMapCase<Avx2Lanes, 'A'>(data, size, out);
+}
+
+void ToUpperAvx2(const char *data, size_t size, char *out) {
+	SimdMapCase<Avx2Lanes, 'a'>(data, size, out);
+}
+
+bool EqualIgnoreCaseAvx2(const char *lhs, const char *rhs, size_t size) {
+	return SimdEqualIgnoreCase<Avx2Lanes>(lhs, rhs, size);
+}
+
+const char *SkipSpaceAvx2(const char *data, size_t size) {
+	return SimdSkipSpace<Avx2Lanes>(data, size);
+}
+
+const char *RSkipSpaceAvx2(const char *data, size_t size) {
+	return SimdRSkipSpace<Avx2Lanes>(data, size);
+}
+
+#endif
@@ -0,0 +1,529 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "utf8.hpp"
+
+// Lane-generic bodies of the kernels declared in simd.hpp. A Lanes type provides
+//   Width, Vector, Load(p), Broadcast(symbol) and EqualMask(a, b) (bit i set where byte i matches),
+//   SignMask(a) (bit i set where byte i is 0x80 or above) and LessMask(a, b) (a < b as signed bytes),
+//   and for kernels that produce bytes Store(p, v), Add, And, Xor and Less (0xFF where a < b, signed),
+// and each translation unit instantiates the bodies for its own instruction set: simd.cpp with SSE2,
+// simd_ssse3.cpp and simd_avx2.cpp under #pragma GCC target("ssse3") and ("avx2"). The anonymous
+// namespace keeps every instantiation local to its translation unit, so AVX2 code can never be
+// picked by the linker for the SSE2 path.
+
+namespace {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool BigEndian = true;
+#else
+constexpr bool BigEndian = false;
+#endif
+
+int CompareAt(const char *lhs, const char *rhs, size_t index) {
+	return static_cast<unsigned char>(lhs[index]) < static_cast<unsigned char>(rhs[index]) ? -1 : 1;
+}
+
+// Inputs shorter than a vector are compared through 8/4-byte words, the last one overlapping
+// its predecessor, instead of a byte loop.
+bool EqualShort(const char *lhs, const char *rhs, size_t size) {
+	if (size >= 8) {
+		unsigned long long a, b, differ = 0;
+		for (size_t i = 0; i + 8 < size; i += 8) {
+			memcpy(&a, lhs + i, 8);
+			memcpy(&b, rhs + i, 8);
+			differ |= a ^ b;
+		}
+		memcpy(&a, lhs + size - 8, 8);
+		memcpy(&b, rhs + size - 8, 8);
+		return (differ | (a ^ b)) == 0;
+	}
+	if (size >= 4) {
+		unsigned a, b, c, d;
+		memcpy(&a, lhs, 4);
+		memcpy(&b, rhs, 4);
+		memcpy(&c, lhs + size - 4, 4);
+		memcpy(&d, rhs + size - 4, 4);
+		return ((a ^ b) | (c ^ d)) == 0;
+	}
+	for (size_t i = 0; i < size; ++i)
+		if (lhs[i] != rhs[i]) return false;
+	return true;
+}
+
+// Big-endian words order the same way as their bytes do, so one integer compare decides;
+// little-endian loads are byte-swapped first.
+template <typename Word>
+int CompareWords(const char *lhs, const char *rhs) {
+	Word a, b;
+	memcpy(&a, lhs, sizeof(Word));
+	memcpy(&b, rhs, sizeof(Word));
+	if (a == b) return 0;
+	if constexpr (!BigEndian && sizeof(Word) == 8) {
+		a = __builtin_bswap64(a);
+		b = __builtin_bswap64(b);
+	} else if constexpr (!BigEndian) {
+		a = __builtin_bswap32(a);
+		b = __builtin_bswap32(b);
+	}
+	return a < b ? -1 : 1;
+}
+
+int CompareShort(const char *lhs, const char *rhs, size_t size) {
+	if (size >= 8) {
+		for (size_t i = 0; i + 8 < size; i += 8)
+			if (int result = CompareWords<unsigned long long>(lhs + i, rhs + i); result != 0) return result;
+		return CompareWords<unsigned long long>(lhs + size - 8, rhs + size - 8);
+	}
+	if (size >= 4) {
+		int result = CompareWords<unsigned>(lhs, rhs);
+		return result != 0 ? result : CompareWords<unsigned>(lhs + size - 4, rhs + size - 4);
+	}
+	for (size_t i = 0; i < size; ++i)
+		if (lhs[i] != rhs[i]) return CompareAt(lhs, rhs, i);
+	return 0;
+}
+
+template <typename Lanes>
+unsigned Mismatch(const char *lhs, const char *rhs) {
+	return ~Lanes::EqualMask(Lanes::Load(lhs), Lanes::Load(rhs)) & Lanes::FullMask;
+}
+
+template <typename Lanes>
+bool SimdEqual(const char *lhs, const char *rhs, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	if (size < W) return EqualShort(lhs, rhs, size);
+	size_t i = 0;
+	for (; i + W <= size; i += W)
+		if (Mismatch<Lanes>(lhs + i, rhs + i) != 0) return false;
+	// The last block overlaps bytes that were already checked instead of falling back to a loop.
+	return i == size || Mismatch<Lanes>(lhs + size - W, rhs + size - W) == 0;
+}
+
+template <typename Lanes>
+int SimdCompare(const char *lhs, const char *rhs, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	if (size < W) return CompareShort(lhs, rhs, size);
+	size_t i = 0;
+	for (; i + W <= size; i += W) {
+		unsigned mask = Mismatch<Lanes>(lhs + i, rhs + i);
+		if (mask != 0) return CompareAt(lhs, rhs, i + __builtin_ctz(mask));
+	}
+	if (i == size) return 0;
+	unsigned mask = Mismatch<Lanes>(lhs + size - W, rhs + size - W);
+	return mask == 0 ? 0 : CompareAt(lhs, rhs, size - W + __builtin_ctz(mask));
+}
+
+// Bit i is set where a match of needle may start at block + i: the first and the last
+// needle bytes both line up there. Only those candidates are verified with memcmp.
+template <typename Lanes>
+unsigned Candidates(const char *block, size_t needle_size,
+		typename Lanes::Vector first, typename Lanes::Vector last) {
+	return Lanes::EqualMask(Lanes::Load(block), first) &
+		Lanes::EqualMask(Lanes::Load(block + needle_size - 1), last);
+}
+
+// First occurrence of a needle of at least 2 bytes, or nullptr.
+template <typename Lanes>
+const char *SimdFind(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	constexpr size_t W = Lanes::Width;
+	size_t positions = size - needle_size + 1;
+	if (positions < W) {
+		for (size_t i = 0; i < positions; ++i)
+			if (haystack[i] == needle[0] && memcmp(haystack + i + 1, needle + 1, needle_size - 1) == 0)
+				return haystack + i;
+		return nullptr;
+	}
+
+	auto first = Lanes::Broadcast(needle[0]);
+	auto last = Lanes::Broadcast(needle[needle_size - 1]);
+	auto scan = [&](size_t block) -> const char * {
+		for (unsigned mask = Candidates<Lanes>(haystack + block, needle_size, first, last); mask != 0; mask &= mask - 1) {
+			size_t i = block + __builtin_ctz(mask);
+			if (memcmp(haystack + i + 1, needle + 1, needle_size - 2) == 0) return haystack + i;
+		}
+		return nullptr;
+	};
+	size_t block = 0;
+	for (; block + W <= positions; block += W)
+		if (const char *found = scan(block)) return found;
+	return block == positions ? nullptr : scan(positions - W);
+}
+
+// Last occurrence of a needle of at least 2 bytes, or nullptr.
+template <typename Lanes>
+const char *SimdRFind(const char *haystack, size_t size, const char *needle, size_t needle_size) {
+	constexpr size_t W = Lanes::Width;
+	size_t positions = size - needle_size + 1;
+	if (positions < W) {
+		for (size_t i = positions; i-- > 0;)
+			if (haystack[i] == needle[0] && memcmp(haystack + i + 1, needle + 1, needle_size - 1) == 0)
+				return haystack + i;
+		return nullptr;
+	}
+
+	auto first = Lanes::Broadcast(needle[0]);
+	auto last = Lanes::Broadcast(needle[needle_size - 1]);
+	auto scan = [&](size_t block) -> const char * {
+		unsigned mask = Candidates<Lanes>(haystack + block, needle_size, first, last);
+		while (mask != 0) {
+			unsigned bit = 31 - __builtin_clz(mask);
+			size_t i = block + bit;
+			if (memcmp(haystack + i + 1, needle + 1, needle_size - 2) == 0) return haystack + i;
+			mask &= ~(1u << bit);
+		}
+		return nullptr;
+	};
+	size_t end = positions;
+	for (; end >= W; end -= W)
+		if (const char *found = scan(end - W)) return found;
+	return end == 0 ? nullptr : scan(0);
+}
+
+template <typename Lanes>
+const char *SimdRFindByte(const char *haystack, size_t size, char symbol) {
+	constexpr size_t W = Lanes::Width;
+	auto target = Lanes::Broadcast(symbol);
+	size_t end = size;
+	for (; end >= W; end -= W) {
+		unsigned mask = Lanes::EqualMask(Lanes::Load(haystack + end - W), target);
+		if (mask != 0) return haystack + end - W + (31 - __builtin_clz(mask));
+	}
+	while (end-- > 0)
+		if (haystack[end] == symbol) return haystack + end;
+	return nullptr;
+}
+
+// First byte that belongs to a set of at most MaxSimdSet symbols, or nullptr.
+constexpr size_t MaxSimdSet = 16;
+
+template <typename Lanes>
+const char *SimdFindFirstOf(const char *haystack, size_t size, const char *symbols, size_t symbols_size) {
+	constexpr size_t W = Lanes::Width;
+	typename Lanes::Vector targets[MaxSimdSet];
+	for (size_t k = 0; k < symbols_size; ++k) targets[k] = Lanes::Broadcast(symbols[k]);
+
+	size_t i = 0;
+	for (; i + W <= size; i += W) {
+		auto block = Lanes::Load(haystack + i);
+		unsigned mask = 0;
+		for (size_t k = 0; k < symbols_size; ++k) mask |= Lanes::EqualMask(block, targets[k]);
+		if (mask != 0) return haystack + i + __builtin_ctz(mask);
+	}
+	for (; i < size; ++i)
+		if (memchr(symbols, haystack[i], symbols_size) != nullptr) return haystack + i;
+	return nullptr;
+}
+
+// Validates UTF-8 by decoding it, except for whole blocks of ASCII, which are skipped at once;
+// for CPUs without SSSE3, whose SSE2 has no byte shuffle for the lookup tables below.
+template <typename Lanes>
+bool SimdValidUtf8(const char *data, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+	size_t i = 0;
+	while (i < size) {
+		if (i + W <= size && Lanes::SignMask(Lanes::Load(data + i)) == 0) {
+			i += W;
+			continue;
+		}
+		// Decodes at least the block that had non-ASCII bytes, from a sequence boundary.
+		size_t end = i + W < size ? i + W : size;
+		while (i < end) {
+			size_t length = Utf8SequenceLength(p + i, size - i);
+			if (length == 0) return false;
+			i += length;
+		}
+	}
+	return true;
+}
+
+// UTF-8 validation with three table lookups per block, after Keiser and Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte" (2021). Every pair of adjacent bytes is classified
+// by the high nibble of the first, its low nibble and the high nibble of the second; each table
+// maps a nibble to the set of errors it is compatible with, and a pair is an error when all three
+// agree. Sequences of 3 and 4 bytes additionally need their 3rd and 4th bytes to be continuations.
+// Lanes for it also provide Or, Zero(), SubSaturate(a, b) (unsigned), HighNibble(v),
+// Table(b0, ..., b15) (the 16 bytes in every 128-bit lane), Lookup(table, v) (the table byte
+// that the low nibble of each byte selects, as pshufb does), Previous<N>(block, previous) (block
+// shifted by N bytes towards the end, the last N bytes of previous in front) and AnySet(v).
+namespace utf8_lookup {
+
+constexpr char TooShort = 1 << 0;    // lead byte followed by a non-continuation
+constexpr char TooLong = 1 << 1;     // ASCII followed by a continuation
+constexpr char Overlong3 = 1 << 2;
+constexpr char TooLarge = 1 << 3;
+constexpr char Surrogate = 1 << 4;
+constexpr char Overlong2 = 1 << 5;
+constexpr char TooLarge1000 = 1 << 6;
+constexpr char Overlong4 = 1 << 6;
+constexpr char TwoConts = char(1 << 7);  // two continuations in a row: fine only inside a 3-4 byte sequence
+constexpr char Carry = TooShort | TooLong | TwoConts;
+
+template <typename Lanes>
+typename Lanes::Vector PairErrors(typename Lanes::Vector block, typename Lanes::Vector previous1) {
+	auto byte1_high = Lanes::Lookup(Lanes::Table(
+		TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+		TwoConts, TwoConts, TwoConts, TwoConts,
+		TooShort | Overlong2,
+		TooShort,
+		TooShort | Overlong3 | Surrogate,
+		TooShort | TooLarge | TooLarge1000 | Overlong4), Lanes::HighNibble(previous1));
+	constexpr char Large = Carry | TooLarge | TooLarge1000;
+	auto byte1_low = Lanes::Lookup(Lanes::Table(
+		Carry | Overlong3 | Overlong2 | Overlong4,
+		Carry | Overlong2,
+		Carry,
+		Carry,
+		Carry | TooLarge,
+		Large, Large, Large, Large, Large, Large, Large, Large,
+		Large | Surrogate,
+		Large, Large), Lanes::And(previous1, Lanes::Broadcast(0x0F)));
+	auto byte2_high = Lanes::Lookup(Lanes::Table(
+		TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+		TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+		TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+		TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+		TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+		TooShort, TooShort, TooShort, TooShort), Lanes::HighNibble(block));
+	return Lanes::And(Lanes::And(byte1_high, byte1_low), byte2_high);
+}
+
+template <typename Lanes>
+typename Lanes::Vector BlockErrors(typename Lanes::Vector block, typename Lanes::Vector previous) {
+	auto errors = PairErrors<Lanes>(block, Lanes::template Previous<1>(block, previous));
+	// 0x80 where the byte is the 3rd of a sequence (two back is 111xxxxx) or the 4th (three back
+	// is 1111xxxx); those are exactly the places where TwoConts is expected.
+	auto third = Lanes::SubSaturate(Lanes::template Previous<2>(block, previous), Lanes::Broadcast(char(0xE0 - 0x80)));
+	auto fourth = Lanes::SubSaturate(Lanes::template Previous<3>(block, previous), Lanes::Broadcast(char(0xF0 - 0x80)));
+	auto expected = Lanes::And(Lanes::Or(third, fourth), Lanes::Broadcast(char(0x80)));
+	return Lanes::Xor(expected, errors);
+}
+
+// Subtracted from a block, leaves nonzero bytes where a sequence that starts in the last three
+// bytes runs past it.
+template <size_t W>
+constexpr auto IncompleteLimits = [] {
+	struct { char Bytes[W]; } limits {};
+	for (size_t i = 0; i < W - 3; ++i) limits.Bytes[i] = char(0xFF);
+	limits.Bytes[W - 3] = char(0xF0 - 1);
+	limits.Bytes[W - 2] = char(0xE0 - 1);
+	limits.Bytes[W - 1] = char(0xC0 - 1);
+	return limits;
+}();
+
+}
+
+template <typename Lanes>
+bool LookupValidUtf8(const char *data, size_t size) {
+	using namespace utf8_lookup;
+	constexpr size_t W = Lanes::Width;
+	const auto limits = Lanes::Load(IncompleteLimits<W>.Bytes);
+	auto errors = Lanes::Zero(), previous = Lanes::Zero(), incomplete = Lanes::Zero();
+	auto step = [&](typename Lanes::Vector block) {
+		if (Lanes::SignMask(block) == 0) {
+			// ASCII cannot continue a sequence from the previous block.
+			errors = Lanes::Or(errors, incomplete);
+			incomplete = Lanes::Zero();
+		} else {
+			errors = Lanes::Or(errors, BlockErrors<Lanes>(block, previous));
+			incomplete = Lanes::SubSaturate(block, limits);
+		}
+		previous = block;
+	};
+
+	size_t i = 0;
+	for (; i + W <= size; i += W) {
+		step(Lanes::Load(data + i));
+		// Invalid input stops within a few blocks instead of reading to the end.
+		if ((i & 1023) == 0 && Lanes::AnySet(errors)) return false;
+	}
+	if (i < size) {
+		// Zero padding is ASCII, so a sequence cut off at the end shows up as TooShort.
+		char tail[W] = {};
+		memcpy(tail, data + i, size - i);
+		step(Lanes::Load(tail));
+	}
+	return !Lanes::AnySet(Lanes::Or(errors, incomplete));
+}
+
+// Continuation bytes 0x80..0xBF are exactly the bytes below -64 when read as signed.
+template <typename Lanes>
+size_t SimdCountCodePoints(const char *data, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	auto limit = Lanes::Broadcast(-64);
+	size_t count = 0, i = 0;
+	for (; i + W <= size; i += W)
+		count += W - __builtin_popcount(Lanes::LessMask(Lanes::Load(data + i), limit));
+	for (; i < size; ++i) count += static_cast<signed char>(data[i]) >= -64;
+	return count;
+}
+
+// 0xFF in the bytes that lie in [first, first + count): shifted so that the range starts at -128,
+// one signed compare checks both ends.
+template <typename Lanes>
+typename Lanes::Vector InRange(typename Lanes::Vector v, char first, char count) {
+	return Lanes::Less(Lanes::Add(v, Lanes::Broadcast(static_cast<char>(0x80 - first))),
+		Lanes::Broadcast(static_cast<char>(-128 + count)));
+}
+
+template <typename Lanes>
+unsigned SpaceMask(typename Lanes::Vector v) {
+	return Lanes::EqualMask(v, Lanes::Broadcast(' ')) | Lanes::SignMask(InRange<Lanes>(v, '\t', 5));
+}
+
+// Flips bit 0x20 of the letters in [first, first + 26): 'A' lowers, 'a' uppers.
+template <typename Lanes>
+typename Lanes::Vector FlipCase(typename Lanes::Vector v, char first) {
+	return Lanes::Xor(v, Lanes::And(InRange<Lanes>(v, first, 26), Lanes::Broadcast(0x20)));
+}
+
+// Inputs shorter than a vector go through 8-byte words (SWAR), the last one overlapping its
+// predecessor, instead of a byte loop whose branches follow the letters. Each byte is checked on its
+// low 7 bits, so adding the offset cannot carry into the next byte; bytes 0x80 and above are excluded.
+constexpr uint64_t Ones = 0x0101010101010101ull;
+
+inline uint64_t InRangeWord(uint64_t word, char first, unsigned count) {
+	uint64_t low = word & (0x7F * Ones);
+	uint64_t from = low + (0x80 - first) * Ones, past = low + (0x80 - first - count) * Ones;
+	return (from ^ past) & ~word & (0x80 * Ones);
+}
+
+inline uint64_t FlipCaseWord(uint64_t word, char first) { return word ^ (InRangeWord(word, first, 26) >> 2); }
+
+inline uint64_t LoadWord(const char *p) {
+	uint64_t word;
+	memcpy(&word, p, 8);
+	return word;
+}
+
+inline uint64_t SpaceWord(uint64_t word) { return InRangeWord(word, '\t', 5) | InRangeWord(word, ' ', 1); }
+
+// The word as a little-endian load sees it, byte i of memory in bits [8i, 8i + 8), which the bit
+// scans below count positions by.
+inline uint64_t LittleEndianWord(uint64_t word) { return BigEndian ? __builtin_bswap64(word) : word; }
+
+// Bytes past the end read as 0 in the forward scan and as ' ' in the backward one, so that they
+// never stop it.
+inline const char *SkipSpaceWords(const char *data, size_t size) {
+	for (size_t i = 0; i < size; i += 8) {
+		uint64_t word = 0;
+		memcpy(&word, data + i, size - i < 8 ? size - i : 8);
+		uint64_t text = ~SpaceWord(LittleEndianWord(word)) & (0x80 * Ones);
+		if (text != 0) {
+			size_t found = i + __builtin_ctzll(text) / 8;
+			return data + (found < size ? found : size);
+		}
+	}
+	return data + size;
+}
+
+inline const char *RSkipSpaceWords(const char *data, size_t size) {
+	for (size_t end = size; end > 0;) {
+		size_t count = end < 8 ? end : 8;
+		uint64_t word = ' ' * Ones;
+		memcpy(reinterpret_cast<char *>(&word) + 8 - count, data + end - count, count);
+		uint64_t text = ~SpaceWord(LittleEndianWord(word)) & (0x80 * Ones);
+		if (text != 0) return data + (end + (64 - __builtin_clzll(text)) / 8 - 8);
+		end -= count;
+	}
+	return data;
+}
+
+template <char First>
+void MapCaseWords(const char *data, size_t size, char *out) {
+	if (size < 8) {
+		uint64_t word = 0;
+		memcpy(&word, data, size);
+		word = FlipCaseWord(word, First);
+		memcpy(out, &word, size);
+		return;
+	}
+	uint64_t last = FlipCaseWord(LoadWord(data + size - 8), First);
+	for (size_t i = 0; i + 8 < size; i += 8) {
+		uint64_t word = FlipCaseWord(LoadWord(data + i), First);
+		memcpy(out + i, &word, 8);
+	}
+	memcpy(out + size - 8, &last, 8);
+}
+
+inline bool EqualIgnoreCaseWords(const char *lhs, const char *rhs, size_t size) {
+	if (size < 8) {
+		uint64_t a = 0, b = 0;
+		memcpy(&a, lhs, size);
+		memcpy(&b, rhs, size);
+		return FlipCaseWord(a, 'A') == FlipCaseWord(b, 'A');
+	}
+	uint64_t differ = 0;
+	for (size_t i = 0; i + 8 < size; i += 8)
+		differ |= FlipCaseWord(LoadWord(lhs + i), 'A') ^ FlipCaseWord(LoadWord(rhs + i), 'A');
+	differ |= FlipCaseWord(LoadWord(lhs + size - 8), 'A') ^ FlipCaseWord(LoadWord(rhs + size - 8), 'A');
+	return differ == 0;
+}
+
+template <typename Lanes, char First>
+void SimdMapCase(const char *data, size_t size, char *out) {
+	constexpr size_t W = Lanes::Width;
+	if (size < W) return MapCaseWords<First>(data, size, out);
+	// The last block is loaded before any store: with out == data it would otherwise see bytes
+	// that are already mapped.
+	auto last = FlipCase<Lanes>(Lanes::Load(data + size - W), First);
+	for (size_t i = 0; i + W < size; i += W) Lanes::Store(out + i, FlipCase<Lanes>(Lanes::Load(data + i), First));
+	Lanes::Store(out + size - W, last);
+}
+
+template <typename Lanes>
+bool SimdEqualIgnoreCase(const char *lhs, const char *rhs, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	if (size < W) return EqualIgnoreCaseWords(lhs, rhs, size);
+	auto differ = [](const char *a, const char *b) {
+		auto lower_a = FlipCase<Lanes>(Lanes::Load(a), 'A'), lower_b = FlipCase<Lanes>(Lanes::Load(b), 'A');
+		return Lanes::EqualMask(lower_a, lower_b) != Lanes::FullMask;
+	};
+	for (size_t i = 0; i + W < size; i += W)
+		if (differ(lhs + i, rhs + i)) return false;
+	return !differ(lhs + size - W, rhs + size - W);
+}
+
+template <typename Lanes>
+const char *SimdSkipSpace(const char *data, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	size_t i = 0;
+	for (; i + W <= size; i += W) {
+		unsigned text = ~SpaceMask<Lanes>(Lanes::Load(data + i)) & Lanes::FullMask;
+		if (text != 0) return data + i + __builtin_ctz(text);
+	}
+	return SkipSpaceWords(data + i, size - i);
+}
+
+template <typename Lanes>
+const char *SimdRSkipSpace(const char *data, size_t size) {
+	constexpr size_t W = Lanes::Width;
+	size_t end = size;
+	for (; end >= W; end -= W) {
+		unsigned text = ~SpaceMask<Lanes>(Lanes::Load(data + end - W)) & Lanes::FullMask;
+		if (text != 0) return data + end - W + (32 - __builtin_clz(text));
+	}
+	return RSkipSpaceWords(data, end);
+}
+
+}
+
+// Entry points compiled for AVX2 in simd_avx2.cpp; only called when CPUID reports AVX2.
+bool EqualAvx2(const char *lhs, const char *rhs, size_t size);
+int CompareAvx2(const char *lhs, const char *rhs, size_t size);
+const char *FindAvx2(const char *haystack, size_t size, const char *needle, size_t needle_size);
+const char *RFindAvx2(const char *haystack, size_t size, const char *needle, size_t needle_size);
+const char *RFindByteAvx2(const char *haystack, size_t size, char symbol);
+const char *FindFirstOfAvx2(const char *haystack, size_t size, const char *symbols, size_t symbols_size);
+bool ValidUtf8Avx2(const char *data, size_t size);
+size_t CountCodePointsAvx2(const char *data, size_t size);
+void ToLowerAvx2(const char *data, size_t size, char *out);
+void ToUpperAvx2(const char *data, size_t size, char *out);
+bool EqualIgnoreCaseAvx2(const char *lhs, const char *rhs, size_t size);
+const char *SkipSpaceAvx2(const char *data, size_t size);
+const char *RSkipSpaceAvx2(const char *data, size_t size);
+
+// Compiled for SSSE3 in simd_ssse3.cpp; only called when CPUID reports SSSE3.
+bool ValidUtf8Ssse3(const char *data, size_t size);
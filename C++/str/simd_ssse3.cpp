@@ -0,0 +1,47 @@
+// SSSE3 instantiation of the lookup-table UTF-8 validator in simd_kernels.hpp: pshufb is the
+// one instruction it needs that SSE2 lacks. The other kernels have nothing to gain from SSSE3
+// and stay in simd.cpp.
+#include <cstddef>
+#include <cstring>
+#include "utf8.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+#pragma GCC target("ssse3")
+#include "simd_kernels.hpp"
+
+namespace {
+
+struct Ssse3Lanes {
+	static constexpr size_t Width = 16;
+	using Vector = __m128i;
+
+	static Vector Load(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+	static Vector Broadcast(char symbol) { return _mm_set1_epi8(symbol); }
+	static unsigned SignMask(Vector a) { return static_cast<unsigned>(_mm_movemask_epi8(a)); }
+	static Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+	static Vector Xor(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+
+	static Vector Or(Vector a, Vector b) { return _mm_or_si128(a, b); }
+	static Vector Zero() { return _mm_setzero_si128(); }
+	static Vector SubSaturate(Vector a, Vector b) { return _mm_subs_epu8(a, b); }
+	static Vector HighNibble(Vector v) { return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)); }
+	static Vector Table(char b0, char b1, char b2, char b3, char b4, char b5, char b6, char b7,
+			char b8, char b9, char b10, char b11, char b12, char b13, char b14, char b15) {
+		return _mm_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15);
+	}
+	static Vector Lookup(Vector table, Vector v) { return _mm_shuffle_epi8(table, v); }
+	template <int N>
+	static Vector Previous(Vector block, Vector previous) { return _mm_alignr_epi8(block, previous, 16 - N); }
+	// No ptest before SSE4.1.
+	static bool AnySet(Vector v) { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF; }
+};
+
+}
+
+bool ValidUtf8Ssse3(const char *data, size_t size) {
+	return LookupValidUtf8<Ssse3Lanes>(data, size);
+}
+
+#endif
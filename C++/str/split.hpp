@@ -0,0 +1,131 @@
+#pragma once
+#include "../vector.cpp"
+#include "str.hpp"
+
+// Lazy range over the fields of a text. It yields StringViews into the text, so iterating
+// allocates nothing; the text has to outlive the loop.
+//   for (StringView field : Split(line, ',')) ...
+class SplitRange {
+private:
+	enum class Mode { Symbol, Separator, Tokens };
+
+public:
+	struct End {};
+
+	class Iterator {
+	public:
+		Iterator(const SplitRange& range)
+			: Delimiters_(range.Delimiters_), Symbol_(range.Symbol_), Mode_(range.Mode_), Rest_(range.Text_) { Advance(); };
+
+		const StringView& operator*() const { return Field_; };
+		const StringView *operator->() const { return &Field_; };
+		Iterator& operator++() {
+			Advance();
+			return *this;
+		};
+		bool operator==(End) const { return Done_; };
+		bool operator!=(End) const { return !Done_; };
+
+	private:
+		StringView Delimiters_;
+		char Symbol_;
+		Mode Mode_;
+		StringView Rest_;
+		StringView Field_;
+		bool Last_ = false;  // Field_ took the rest of the text, nothing follows it
+		bool Done_ = false;
+
+		void Advance();
+	};
+
+	Iterator begin() const { return Iterator(*this); };
+	End end() const { return End(); };
+
+	// Collects the views, e.g. to index the fields of one line.
+	Vector<StringView> ToVector() const {
+		Vector<StringView> fields;
+		for (StringView field : *this) fields.PushBack(field);
+		return fields;
+	};
+
+private:
+	StringView Text_;
+	StringView Delimiters_;
+	char Symbol_ = '\0';
+	Mode Mode_;
+
+	SplitRange(StringView text, StringView delimiters, char symbol, Mode mode)
+		: Text_(text), Delimiters_(delimiters), Symbol_(symbol), Mode_(mode) {};
+
+	friend SplitRange Split(StringView text, StringView separator);
+	friend SplitRange Split(StringView text, char separator);
+	friend SplitRange Tokenize(StringView text, StringView delimiters);
+};
+
+inline void SplitRange::Iterator::Advance() {
+	if (Last_) {
+		Done_ = true;
+		return;
+	}
+
+	if (Mode_ == Mode::Tokens) {
+		const StringView& delimiters = Delimiters_;
+		size_t start = 0;
+		while (start < Rest_.Size() && memchr(delimiters.Data(), Rest_[start], delimiters.Size()) != nullptr)
+			++start;
+		if (start == Rest_.Size()) {
+			Done_ = true;
+			return;
+		}
+		Rest_.RemovePrefix(start);
+		size_t stop = Rest_.FindFirstOf(delimiters);
+		if (stop == StringView::NPos) stop = Rest_.Size();
+		Field_ = StringView(Rest_.Data(), stop);
+		Rest_.RemovePrefix(stop);
+		return;
+	}
+
+	size_t stop = StringView::NPos;
+	if (Mode_ == Mode::Symbol)
+		stop = Rest_.Find(Symbol_);
+	else if (!Delimiters_.Empty())
+		stop = Rest_.Find(Delimiters_);
+	if (stop == StringView::NPos) {
+		Field_ = Rest_;
+		Last_ = true;
+		return;
+	}
+	Field_ = StringView(Rest_.Data(), stop);
+	Rest_.RemovePrefix(stop + (Mode_ == Mode::Symbol ? 1 : Delimiters_.Size()));
+}
+
+// Fields separated by every occurrence of separator; empty fields are kept, so "a,,b" has three.
+// An empty separator yields the whole text as one field.
+inline SplitRange Split(StringView text, StringView separator) {
+	return SplitRange(text, separator, '\0', SplitRange::Mode::Separator);
+}
+
+inline SplitRange Split(StringView text, char separator) {
+	return SplitRange(text, StringView(), separator, SplitRange::Mode::Symbol);
+}
+
+// Non-empty runs of characters that are not in delimiters.
+inline SplitRange Tokenize(StringView text, StringView delimiters) {
+	return SplitRange(text, delimiters, '\0', SplitRange::Mode::Tokens);
+}
+
+// Concatenates parts with separator between them; the result is allocated exactly once.
+template <typename T>
+String Join(const Vector<T>& parts, StringView separator) {
+	if (parts.Empty()) return String();
+	size_t size = separator.Size() * (parts.Size() - 1);
+	for (size_t i = 0; i < parts.Size(); ++i) size += StringView(parts[i]).Size();
+
+	String result;
+	result.Reserve(size);
+	for (size_t i = 0; i < parts.Size(); ++i) {
+		if (i != 0) result.Append(separator);
+		result.Append(parts[i]);
+	}
+	return result;
+}
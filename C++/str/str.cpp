@@ -1,46 +1,172 @@
 #include "str.hpp"
+#include "simd.hpp"
+#include "file_descriptor.hpp"
+#include <locale>
+#include <streambuf>
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-bool operator== (const String& lhs, const String& rhs)  {
-	if ((lhs.Data_ == nullptr) && (rhs.Data_ == nullptr)) return true;
-	if ((lhs.Data_ == nullptr && rhs.Data_ != nullptr) ||
-			(lhs.Data_ != nullptr && rhs.Data_ == nullptr)) return false;
+template <typename Allocator>
+std::istream& operator>> (std::istream& stream, BasicString<Allocator>& first) {
+	std::istream::sentry sentry(stream);
+	if (!sentry) {
+		stream.width(0);
+		return stream;
+	}
 
-	if (lhs.Size() == rhs.Size()) {
-		return strncmp(lhs.Data_, rhs.Data_, lhs.Size()) == 0;
+	// Characters come through the public sgetc() and snextc(), which are inline while the
+	// stream buffer has characters, and go straight into the free capacity of the string.
+	first.Clear();
+	std::streambuf *buffer = stream.rdbuf();
+	const std::ctype<char>& ctype = std::use_facet<std::ctype<char>>(stream.getloc());
+	size_t limit = stream.width() > 0 ? static_cast<size_t>(stream.width()) : StringView::NPos;
+	std::ios_base::iostate state = std::ios_base::goodbit;
+	char *out = first.Buffer();
+	size_t size = 0;
+	size_t capacity = first.Capacity();
+	for (auto next = buffer->sgetc(); size < limit; next = buffer->snextc()) {
+		if (std::char_traits<char>::eq_int_type(next, std::char_traits<char>::eof())) {
+			state |= std::ios_base::eofbit;
+			break;
+		}
+		char symbol = std::char_traits<char>::to_char_type(next);
+		if (ctype.is(std::ctype_base::space, symbol)) break;
+		if (size == capacity) {
+			first.SetSize(size);
+			first.Grow(first.NextCapacity(size + 1));
+			out = first.Buffer();
+			capacity = first.Capacity();
+		}
+		out[size++] = symbol;
 	}
-	else
-		return false;
+	first.SetSize(size);
+	stream.width(0);
+	if (size == 0) state |= std::ios_base::failbit;
+	stream.setstate(state);
+	return stream;
 }
 
-String operator+ (const String& lhs, const String& rhs) { 
-	String result(lhs);
-	result += rhs;
+template <typename Allocator>
+std::istream& GetLine(std::istream& stream, BasicString<Allocator>& line, char delimiter) {
+	std::istream::sentry sentry(stream, true);
+	if (!sentry) return stream;
+
+	// istream::getline finds the delimiter in the stream buffer a block at a time; it is called
+	// on the free capacity of the string and once more after each time it fills it.
+	line.Clear();
+	size_t size = 0;
+	while (true) {
+		if (size == line.Capacity()) line.Grow(line.NextCapacity(size + 1));
+		size_t room = line.Capacity() - size;
+		// Writes up to room characters and the terminator, which the buffer has space for.
+		stream.getline(line.Buffer() + size, static_cast<std::streamsize>(room + 1), delimiter);
+		size_t count = static_cast<size_t>(stream.gcount());
+		if (!stream.fail()) {
+			// Stopped at the delimiter, which counts as extracted, or at the end of the input.
+			size += stream.eof() ? count : count - 1;
+			break;
+		}
+		size += count;
+		if (stream.eof()) {
+			// Nothing more in this call; the line is still there if earlier calls found any.
+			if (size != 0) stream.clear(stream.rdstate() & ~std::ios_base::failbit);
+			break;
+		}
+		// The string is full and the line goes on.
+		line.SetSize(size);
+		stream.clear(stream.rdstate() & ~std::ios_base::failbit);
+	}
+	line.SetSize(size);
+	return stream;
+}
+
+template <typename Allocator>
+BasicString<Allocator> ReadAll(std::istream& stream, const Allocator& alloc) {
+	BasicString<Allocator> result(alloc);
+	std::istream::sentry sentry(stream, true);
+	if (!sentry) return result;
+
+	std::streambuf *buffer = stream.rdbuf();
+	std::streampos here = buffer->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+	if (here != std::streampos(-1)) {
+		std::streampos end = buffer->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+		buffer->pubseekpos(here, std::ios_base::in);
+		if (end != std::streampos(-1) && end > here) result.Reserve(static_cast<size_t>(end - here));
+	}
+
+	size_t size = 0;
+	while (true) {
+		if (size == result.Capacity()) {
+			// A stream measured exactly is full now; only grow if something is left.
+			if (buffer->sgetc() == std::char_traits<char>::eof()) break;
+			result.Grow(result.NextCapacity(size + 1));
+		}
+		std::streamsize read = buffer->sgetn(result.Buffer() + size, result.Capacity() - size);
+		if (read <= 0) break;
+		size += static_cast<size_t>(read);
+		result.SetSize(size);
+	}
+	stream.setstate(std::ios_base::eofbit);
 	return result;
 }
 
-std::ostream& operator<< (std::ostream& stream, const String& first) {
-	for (size_t i = 0; i < first.Size(); i++) { stream << first.Data_[i]; }
-	return stream;
+namespace {
+
+[[noreturn]] void ThrowFileError(const char *what, const char *path) {
+	throw std::system_error(errno, std::generic_category(), std::string("String::FromFile: ") + what + " " + path);
 }
 
-std::istream& operator>> (std::istream& stream, String& first) {
-	for (size_t i = 0; i < first.Size(); i++) { stream >> first.Data_[i]; }
-	return stream;
+// read() that retries on EINTR and throws on any other error.
+size_t ReadSome(const FileDescriptor& fd, char *buffer, size_t size, const char *path) {
+	while (true) {
+		ssize_t count = read(fd.Get(), buffer, size);
+		if (count >= 0) return static_cast<size_t>(count);
+		if (errno != EINTR) ThrowFileError("cannot read", path);
+	}
 }
 
-int operator<=>(const String& lhs, const String& rhs) {
-	size_t nCompared = std::min(rhs.Size(), lhs.Size());
-    for (size_t i = 0; i < nCompared; i++) {
-        if (lhs[i] < rhs[i])
-            return -1;
-        else if (lhs[i] > rhs[i])
-            return 1;
-    }
-
-    if (lhs.Size() < rhs.Size())
-        return -1;
-    else if (lhs.Size() > rhs.Size())
-        return 1;
-
-    return 0;
+}  // namespace
+
+template <typename Allocator>
+BasicString<Allocator> BasicString<Allocator>::FromFile(const char *path, const Allocator& alloc) {
+	FileDescriptor fd(open(path, O_RDONLY | O_CLOEXEC));
+	if (!fd.Valid()) ThrowFileError("cannot open", path);
+
+	BasicString result(alloc);
+	struct stat info;
+	if (fstat(fd.Get(), &info) == 0 && info.st_size > 0)
+		result.Reserve(static_cast<size_t>(info.st_size));
+
+	// One read() normally does it; the loop covers short reads, files that grew since fstat,
+	// and files such as those in /proc that report size 0.
+	size_t size = 0;
+	while (true) {
+		if (size == result.Capacity()) {
+			// Full: grow only if the file really goes on.
+			char next;
+			if (ReadSome(fd, &next, 1, path) == 0) break;
+			result.SetSize(size);
+			result.Grow(result.NextCapacity(size + 1));
+			result.Buffer()[size++] = next;
+		}
+		size_t count = ReadSome(fd, result.Buffer() + size, result.Capacity() - size, path);
+		if (count == 0) break;
+		size += count;
+	}
+	result.SetSize(size);
+	return result;
 }
+
+template class BasicString<std::allocator<char>>;
+template std::istream& operator>> (std::istream&, String&);
+template std::istream& GetLine(std::istream&, String&, char);
+template String ReadAll(std::istream&, const std::allocator<char>&);
+
+template class BasicString<std::pmr::polymorphic_allocator<char>>;
+template std::istream& operator>> (std::istream&, PmrString&);
+template std::istream& GetLine(std::istream&, PmrString&, char);
+template PmrString ReadAll(std::istream&, const std::pmr::polymorphic_allocator<char>&);
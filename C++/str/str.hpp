@@ -2,251 +2,605 @@
 #include <iostream>
 #include <cstring>
 #include <cstdbool>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include "simd.hpp"
+#include "string_view.hpp"
+#include "utf8.hpp"
+
+template <typename Lhs, typename Rhs>
+class StringConcat;
+
+template <typename Allocator>
+class BasicString;
+
+// Declared with Vector (../vector.cpp).
+template <typename T>
+struct IsTriviallyRelocatable;
+
+// A string finds its characters through the heap flag in Size_, never through a pointer into
+// itself, so Vector moves strings with memcpy when the allocator allows it: a stateless one
+// (std::allocator has a user-provided copy constructor, but nothing to copy) or a relocatable one.
+template <typename Allocator>
+struct IsTriviallyRelocatable<BasicString<Allocator>>
+	: std::bool_constant<std::is_empty_v<Allocator> || IsTriviallyRelocatable<Allocator>::value> {};
+
+// The rest of the stream. Seekable streams (files, string streams) are measured first,
+// so the result is allocated once.
+template <typename Allocator = std::allocator<char>>
+BasicString<Allocator> ReadAll(std::istream& stream, const Allocator& alloc = Allocator());
+
+// One whitespace-delimited token; see operator<< below.
+template <typename Allocator>
+std::istream& operator>> (std::istream& stream, BasicString<Allocator>& first);
+
+// Replaces line with the characters up to delimiter, which is consumed but not stored.
+// Fails only when nothing, not even the delimiter, could be read.
+template <typename Allocator>
+std::istream& GetLine(std::istream& stream, BasicString<Allocator>& line, char delimiter = '\n');
+
+// Byte string with small-string optimization whose heap buffers come from Allocator.
+// String uses the global heap; PmrString takes a std::pmr::memory_resource, so that, for example,
+// every string of one request can live in a monotonic arena that is dropped at once:
+//   std::pmr::monotonic_buffer_resource arena;
+//   PmrString name("...", &arena);
+template <typename Allocator>
+class BasicString {
+public:
+	using AllocatorType = Allocator;
+
+	// Strings of up to InlineCapacity characters live inside the object, without a heap buffer.
+	static constexpr size_t InlineCapacity = 15;
+	// Returned by the Find family when there is no match.
+	static constexpr size_t NPos = ~size_t(0);
 
-class String {
 private:
-		size_t Size_ = 0;
-		size_t Capacity_ = 1;
-		char * Data_ = nullptr;
+	using Traits = std::allocator_traits<Allocator>;
+	static_assert(std::is_same_v<typename Traits::value_type, char>, "BasicString needs an allocator of char");
+
+	// The top bit of Size_ is set while the characters live in Storage_.Heap.
+	static constexpr size_t HeapFlag_ = ~(~size_t(0) >> 1);
+
+	union Storage {
+		struct {
+			char *Data;
+			size_t Capacity;
+		} Heap;
+		char Inline[InlineCapacity + 1];
+	};
 
-public:
-	String() {};
-
-	String (char symbol) {
-		Data_ = new char[2]();
-		Data_[0] = symbol;
-		Data_[1] = '\0';
-
-		Size_ = 1;
-		Capacity_ = 2;
-	};
-	
-	String (size_t N, char symbol) {
-		Data_ = new char[N + 1]();
-		for (size_t i = 0; i < N; i++) Data_[i] = symbol;
-		Data_[N] = '\0';
-		Size_ = N;
-		Capacity_ = N + 1;
-	};
-
-	String (const char *Copy_Source, size_t N) {
-		Data_ = new char[N + 1]();
-		memcpy(Data_, Copy_Source, N);
-		Data_[N] = '\0';
-		Size_ = N;
-		Capacity_ = N + 1;
-	};
-
-	String (const char *Copy_Source) {
-		if (Copy_Source == nullptr) {
-			Size_ = 0;
-			Capacity_ = 1;
-			Data_ = nullptr;
-			return;
+	size_t Size_ = 0;
+	Storage Storage_ {};
+	// Takes no space for stateless allocators, so String stays 24 bytes.
+	[[no_unique_address]] Allocator Alloc_;
+
+	bool IsHeap() const { return (Size_ & HeapFlag_) != 0; };
+
+	char *Buffer() { return IsHeap() ? Storage_.Heap.Data : Storage_.Inline; };
+	const char *Buffer() const { return IsHeap() ? Storage_.Heap.Data : Storage_.Inline; };
+
+	void SetSize(size_t N) {
+		Size_ = N | (Size_ & HeapFlag_);
+		Buffer()[N] = '\0';
+	};
+
+	// Every heap buffer is allocated and released here, one byte longer than its capacity for the NUL.
+	char *AllocateBuffer(size_t capacity) { return Traits::allocate(Alloc_, capacity + 1); };
+	void FreeBuffer() {
+		if (IsHeap()) Traits::deallocate(Alloc_, Storage_.Heap.Data, Storage_.Heap.Capacity + 1);
+	};
+
+	// Releases the current buffer and keeps the characters in buffer, which holds capacity of them.
+	void ReplaceBuffer(char *buffer, size_t capacity, size_t size) {
+		FreeBuffer();
+		Storage_.Heap.Data = buffer;
+		Storage_.Heap.Capacity = capacity;
+		Size_ = size | HeapFlag_;
+		buffer[size] = '\0';
+	};
+
+	// Only for a freshly constructed object: makes room for N characters and sets the size.
+	void Allocate(size_t N) {
+		if (N > InlineCapacity) {
+			Storage_.Heap.Data = AllocateBuffer(N);
+			Storage_.Heap.Capacity = N;
+			Size_ = HeapFlag_;
 		}
+		SetSize(N);
+	};
+
+	// Capacity to grow to when appending needs room for required characters: at least double
+	// the current one, so that a loop of appends copies every character O(1) times on average.
+	size_t NextCapacity(size_t required) const {
+		size_t doubled = 2 * Capacity();
+		return required > doubled ? required : doubled;
+	};
+
+	// Moves the characters into a new heap buffer that holds new_capacity of them.
+	void Grow(size_t new_capacity) {
+		size_t size = Size();
+		char *buffer = AllocateBuffer(new_capacity);
+		memcpy(buffer, Buffer(), size);
+		ReplaceBuffer(buffer, new_capacity, size);
+	};
+
+	// Replaces the contents with N characters that do not point into this string.
+	void Assign(const char *data, size_t N) {
+		if (Capacity() < N) {
+			char *buffer = AllocateBuffer(N);
+			ReplaceBuffer(buffer, N, 0);
+		}
+		if (N != 0) memcpy(Buffer(), data, N);
+		SetSize(N);
+	};
 
-		int length = strlen(Copy_Source);
-		Data_ = new char[length + 1]();
-		memcpy(Data_, Copy_Source, length);
-		Data_[length] = '\0';
-		Size_ = length;
-		Capacity_ = length + 1;
+	// Appends what write(first, last) puts into [first, last) and returns the end of, MaxSize
+	// characters at most. With room left it writes in place; otherwise it writes to the stack and
+	// appends from there, so a short number does not push a small string onto the heap.
+	template <size_t MaxSize, typename Writer>
+	BasicString& AppendWritten(Writer write) {
+		size_t size = Size();
+		if (Capacity() - size >= MaxSize) {
+			char *end = write(Buffer() + size, Buffer() + size + MaxSize);
+			SetSize(end - Buffer());
+			return *this;
+		}
+		char buffer[MaxSize];
+		return Append(StringView(buffer, write(buffer, buffer + MaxSize) - buffer));
 	};
 
-	String (const String& CopySource) {	 
-		if (CopySource.Data() == nullptr) {
-			Size_ = 0;
-			Capacity_ = 1;
-			Data_ = nullptr;
+	// Puts view in front of the characters: in place, moving them up, when the capacity allows,
+	// otherwise in a new buffer grown like Append. view may point into this string.
+	void Prepend(StringView view) {
+		size_t size = Size();
+		size_t count = view.Size();
+		if (Capacity() < size + count) {
+			size_t capacity = NextCapacity(size + count);
+			char *buffer = AllocateBuffer(capacity);
+			memcpy(buffer, view.Data(), count);
+			memcpy(buffer + count, Buffer(), size);
+			ReplaceBuffer(buffer, capacity, size + count);
 			return;
 		}
+		char *data = Buffer();
+		const char *source = view.Data();
+		// Characters of this string that view refers to are moved up along with the rest.
+		if (std::less_equal<const char *>()(data, source) && std::less<const char *>()(source, data + size))
+			source += count;
+		memmove(data + count, data, size);
+		memmove(data, source, count);
+		SetSize(size + count);
+	};
+
+	// Takes the buffer of other, which must use an equal allocator, and leaves it empty.
+	void Steal(BasicString& other) {
+		FreeBuffer();
+		Size_ = other.Size_;
+		Storage_ = other.Storage_;
+		other.Size_ = 0;
+		other.Storage_.Inline[0] = '\0';
+	};
 
-		Data_ = new char [CopySource.Size() + 1]();
-		memcpy(Data_, CopySource.Data(), CopySource.Size());
-		Data_[CopySource.Size()] = '\0';
-		Size_ = CopySource.Size();
-		Capacity_ = CopySource.Size() + 1;
+public:
+	BasicString() {};
+
+	explicit BasicString(const Allocator& alloc) : Alloc_(alloc) {};
+
+	BasicString (char symbol, const Allocator& alloc = Allocator()) : BasicString(1, symbol, alloc) {};
+
+	BasicString (size_t N, char symbol, const Allocator& alloc = Allocator()) : Alloc_(alloc) {
+		Allocate(N);
+		memset(Buffer(), symbol, N);
+	};
+
+	BasicString (const char *Copy_Source, size_t N, const Allocator& alloc = Allocator()) : Alloc_(alloc) {
+		Allocate(N);
+		if (N != 0) memcpy(Buffer(), Copy_Source, N);
+	};
+
+	BasicString (const char *Copy_Source, const Allocator& alloc = Allocator())
+		: BasicString(Copy_Source, Copy_Source == nullptr ? 0 : strlen(Copy_Source), alloc) {};
+
+	explicit BasicString (StringView view, const Allocator& alloc = Allocator())
+		: BasicString(view.Data(), view.Size(), alloc) {};
+
+	// Contents of the file at path, read with a single read() into a buffer sized from fstat.
+	// Throws std::system_error if the file cannot be opened or read. For files that are only
+	// scanned, MappedFile (mapped_file.hpp) avoids the copy altogether.
+	static BasicString FromFile(const char *path, const Allocator& alloc = Allocator());
+
+	BasicString (const BasicString& CopySource)
+		: BasicString(CopySource.Data(), CopySource.Size(),
+		              Traits::select_on_container_copy_construction(CopySource.Alloc_)) {};
+
+	BasicString (const BasicString& CopySource, const Allocator& alloc)
+		: BasicString(CopySource.Data(), CopySource.Size(), alloc) {};
+
+	BasicString (BasicString&& MoveSource) noexcept
+		: Size_(MoveSource.Size_), Storage_(MoveSource.Storage_), Alloc_(std::move(MoveSource.Alloc_)) {
+		MoveSource.Size_ = 0;
+		MoveSource.Storage_.Inline[0] = '\0';
+	};
+
+	// Steals the buffer only if alloc can free it, and copies otherwise.
+	BasicString (BasicString&& MoveSource, const Allocator& alloc) : Alloc_(alloc) {
+		if (Alloc_ == MoveSource.Alloc_)
+			Steal(MoveSource);
+		else
+			Assign(MoveSource.Data(), MoveSource.Size());
+	};
+
+	// Materializes a + b + ... into a single buffer sized up front.
+	template <typename Lhs, typename Rhs>
+	BasicString (const StringConcat<Lhs, Rhs>& concat, const Allocator& alloc = Allocator()) : Alloc_(alloc) {
+		Allocate(concat.Size());
+		concat.CopyTo(Buffer());
 	};
-	
-	String& operator= (const String& CopySource) {
-		if (CopySource.Data() == Data_)
+
+	BasicString& operator= (const BasicString& CopySource) {
+		if (this == &CopySource)
 			return *this;
 
-		if (CopySource.Size_ == 0) {
-			Size_ = 0;
-			Capacity_ = 1;
-			delete[] Data_;
-			Data_ = nullptr;
+		if constexpr (Traits::propagate_on_container_copy_assignment::value) {
+			if (Alloc_ != CopySource.Alloc_) {
+				FreeBuffer();
+				Size_ = 0;
+				Alloc_ = CopySource.Alloc_;
+			}
+		}
+		Assign(CopySource.Data(), CopySource.Size());
+		return *this;
+	};
+
+	// Allocators that stay with the object (as the pmr one does) only let the buffer be taken
+	// over when they are equal; otherwise the characters are copied.
+	BasicString& operator= (BasicString&& MoveSource) noexcept(
+		Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+		if (this == &MoveSource)
 			return *this;
+
+		if constexpr (Traits::propagate_on_container_move_assignment::value) {
+			Steal(MoveSource);
+			Alloc_ = std::move(MoveSource.Alloc_);
+		} else if (Alloc_ == MoveSource.Alloc_) {
+			Steal(MoveSource);
+		} else {
+			Assign(MoveSource.Data(), MoveSource.Size());
 		}
-		
-		String Copy = *this;
-		if (Data_ != nullptr) delete[] Data_;
-		Data_ = new char[CopySource.Size_ + 1];
-		Capacity_ = CopySource.Size_ + 1;
-		Size_ = CopySource.Size_;
-		for (size_t i = 0; i < Size_; ++i) 
-			Data_[i] = CopySource.Data_[i];	
-		Data_[Size_] = '\0';	
 		return *this;
 	};
 
+	Allocator GetAllocator() const { return Alloc_; };
 
-	char& operator[](size_t i) { return Data_[i]; };
-	const char& operator[] (size_t i) const { return Data_[i]; };
+	char& operator[](size_t i) { return Buffer()[i]; };
+	const char& operator[] (size_t i) const { return Buffer()[i]; };
 
-	char& Front() { return Data_[0]; }; 
-	const char& Front() const { return Data_[0]; };
+	char& Front() { return Buffer()[0]; };
+	const char& Front() const { return Buffer()[0]; };
 
-	char& Back() { return Data_[Size_ - 1]; };
-	const char& Back() const {return Data_[Size_ - 1]; };
+	char& Back() { return Buffer()[Size() - 1]; };
+	const char& Back() const {return Buffer()[Size() - 1]; };
 
-	const char *Data() const { return Data_; };
+	const char *Data() const { return Buffer(); };
 	// char *Data() { return Data_; };
-	const char *CStr() const { return Data_; };
+	const char *CStr() const { return Buffer(); };
 
-	bool Empty() { return Size_ == 0; };
+	operator StringView() const { return StringView(Buffer(), Size()); };
 
-	size_t Size() const { return Size_; };
-	size_t Length() const { return Size_; };
-	size_t Capacity() const { return Capacity_ - 1; };
+	bool Empty() const { return Size() == 0; };
 
-	void Clear() { Size_ = 0; };
-	
-	void Swap(String &other) {
-		size_t buffer = Size_;
-		Size_ = other.Size_;
-		other.Size_ = buffer;
+	size_t Size() const { return Size_ & ~HeapFlag_; };
+	size_t Length() const { return Size(); };
+	size_t Capacity() const { return IsHeap() ? Storage_.Heap.Capacity : InlineCapacity; };
 
-		buffer = Capacity_;
-		Capacity_ = other.Capacity_;
-		other.Capacity_ = buffer;
+	void Clear() { SetSize(0); };
 
-		char *st = Data_;
-		Data_ = other.Data_;
-		other.Data_ = st;
+	// Allocators are exchanged only if they propagate on swap; otherwise they have to be equal.
+	void Swap(BasicString &other) {
+		std::swap(Size_, other.Size_);
+		std::swap(Storage_, other.Storage_);
+		if constexpr (Traits::propagate_on_container_swap::value)
+			std::swap(Alloc_, other.Alloc_);
 	};
 
 	char PopBack() {
-		if (Size_ == 0) return '\0';
-		int symbol = Data_[Size_ - 1];
-		Data_[Size_ - 1] = '\0';
-		Size_--;
+		if (Size() == 0) return '\0';
+		char symbol = Back();
+		SetSize(Size() - 1);
 		return symbol;
 	};
 
 	void PushBack(const char symbol) {
-		if (Size_ < Capacity_ - 1) {
-			Data_[Size_] = symbol;
-			Data_[Size_ + 1] = '\0';
-			Size_++;
-			return;
-		}
-	
-		if (Data_ == nullptr) {
-			Data_ = new char[2]();
-			Data_[0] = symbol;
-			Data_[1] = '\0';
-			Capacity_ = 2;
-			Size_ = 1;
-			return;
-		}
+		size_t size = Size();
+		if (size == Capacity())
+			Grow(2 * size);
 
-		char *buffer = new char [Capacity_ * 2 - 1]();
-		memcpy(buffer, Data_, Size_);
-		delete [] Data_;
-		Data_ = buffer;
-		Data_[Size_] = symbol;
-		Data_[Size_ + 1] = '\0';
-		Size_++;
-		Capacity_ = 2 * Capacity_ - 1;
-	};
-
-	String& operator+= (const String& other) {
-		if (Capacity_ - 1 < other.Size() + Size_) {
-			Capacity_ = Size_ + other.Size() + 1;
-			char *buffer = new char [Capacity_]();
-	
-			if (Data_ != nullptr) {
-				memcpy(buffer, Data_, Size_);
-				delete[] Data_;
-			}
-			memcpy(buffer + Size_, other.Data(), other.Size());
-			buffer[Capacity_ - 1] = '\0'; 
-			Size_ += other.Size();
-			Data_ = buffer;
+		Buffer()[size] = symbol;
+		SetSize(size + 1);
+	};
+
+	BasicString& operator+= (const BasicString& other) { return Append(other); };
+
+	BasicString& Append(StringView view) {
+		size_t size = Size();
+		if (Capacity() < size + view.Size()) {
+			// Filled before the old buffer is released, since view may point into it.
+			size_t capacity = NextCapacity(size + view.Size());
+			char *buffer = AllocateBuffer(capacity);
+			memcpy(buffer, Buffer(), size);
+			memcpy(buffer + size, view.Data(), view.Size());
+			ReplaceBuffer(buffer, capacity, size + view.Size());
 			return *this;
 		}
 
-		if (other.Data_ != nullptr)
-			memcpy(Data_ + Size_, other.Data_, other.Size());
-		Data_[Size_ + other.Size()] = '\0';
-		Size_ += other.Size();
+		if (!view.Empty())
+			memcpy(Buffer() + size, view.Data(), view.Size());
+		SetSize(size + view.Size());
 		return *this;
 	};
-	
-	void Resize(size_t new_size, char symbol) {
-		if (new_size <= Size_) {
-			Size_ = new_size;
-			Data_[new_size] = '\0';
-			return;
-		}
-		if (new_size <= Capacity_ - 1) {
-			for (size_t index = Size_; index < new_size; index++)
-			Data_[index] = symbol;
-			Size_ = new_size;
-			return;
-		}
-		char *save_buffer = new char[new_size + 1]();
-		if (Data_ != nullptr)
-		std::memcpy(save_buffer, Data_, Size_);
 
-		delete[] Data_;
+	template <typename Lhs, typename Rhs>
+	BasicString& operator+= (const StringConcat<Lhs, Rhs>& other) {
+		size_t size = Size();
+		size_t other_size = other.Size();
+		if (Capacity() < size + other_size)
+			Grow(NextCapacity(size + other_size));
 
-		for (size_t index = Size_; index < new_size; index++)
-		save_buffer[index] = symbol;
+		// Parts of other may alias *this; they only read below the old size.
+		other.CopyTo(Buffer() + size);
+		SetSize(size + other_size);
+		return *this;
+	};
+
+	// Appends count characters that write(first) puts at first, growing like Append; for writers that
+	// know the exact length up front. write may read from this string and must not throw.
+	template <typename Writer>
+	BasicString& AppendWith(size_t count, Writer write) {
+		size_t size = Size();
+		if (Capacity() < size + count) {
+			size_t capacity = NextCapacity(size + count);
+			char *buffer = AllocateBuffer(capacity);
+			memcpy(buffer, Buffer(), size);
+			write(buffer + size);
+			ReplaceBuffer(buffer, capacity, size + count);
+			return *this;
+		}
+		write(Buffer() + size);
+		SetSize(size + count);
+		return *this;
+	};
 
-		Data_ = save_buffer;
-		Size_ = new_size;
-		Capacity_ = new_size + 1;
+	// Numbers in the form of std::to_chars, written without a temporary string: decimal integers,
+	// lowercase hexadecimal without a prefix, and the shortest decimal form of a double that reads
+	// back as the same value ("0.1", "1e+100", "inf", "nan").
+	BasicString& AppendInt(int64_t value) {
+		return AppendWritten<20>([value](char *first, char *last) { return std::to_chars(first, last, value).ptr; });
+	};
+	BasicString& AppendUInt(uint64_t value) {
+		return AppendWritten<20>([value](char *first, char *last) { return std::to_chars(first, last, value).ptr; });
+	};
+	BasicString& AppendHex(uint64_t value) {
+		return AppendWritten<16>([value](char *first, char *last) { return std::to_chars(first, last, value, 16).ptr; });
+	};
+	BasicString& AppendDouble(double value) {
+		return AppendWritten<24>([value](char *first, char *last) { return std::to_chars(first, last, value).ptr; });
+	};
 
+	void Resize(size_t new_size, char symbol) {
+		size_t size = Size();
+		if (new_size > Capacity())
+			Grow(new_size);
+		if (new_size > size)
+			memset(Buffer() + size, symbol, new_size - size);
+		SetSize(new_size);
 	};
 
 	void Reserve(size_t new_capacity) {
-		if (Capacity_ - 1 < new_capacity) {
-			char *buffer = new char [new_capacity + 1];
-			if (Data_ != nullptr) { 
-				memcpy(buffer, Data_, Size_ + 1);
-				delete [] Data_;
-			}
-			Data_ = buffer;
-			Capacity_ = new_capacity + 1;
-		}
+		if (Capacity() < new_capacity)
+			Grow(new_capacity);
 	};
 
 	void ShrinkToFit() {
-		if (Size_ == Capacity_ - 1) return;
-		String copy = *this;
-		if (Data_ != nullptr) delete[] Data_;
-		Data_ = new char[Size_ + 1];
-		for (size_t i = 0; i < copy.Size_; ++i) {
-			Data_[i] = copy.Data_[i];
+		if (!IsHeap() || Size() == Capacity()) return;
+		size_t size = Size();
+		if (size > InlineCapacity) {
+			Grow(size);
+			return;
+		}
+
+		char *heap = Storage_.Heap.Data;
+		size_t capacity = Storage_.Heap.Capacity;
+		memcpy(Storage_.Inline, heap, size + 1);
+		Traits::deallocate(Alloc_, heap, capacity + 1);
+		Size_ = size;
+	};
+
+// The Find family works on the StringView of the string, see string_view.hpp.
+	size_t Find(StringView needle, size_t pos = 0) const { return StringView(*this).Find(needle, pos); };
+	size_t Find(char symbol, size_t pos = 0) const { return StringView(*this).Find(symbol, pos); };
+	size_t RFind(StringView needle, size_t pos = NPos) const { return StringView(*this).RFind(needle, pos); };
+	size_t RFind(char symbol, size_t pos = NPos) const { return StringView(*this).RFind(symbol, pos); };
+	size_t FindFirstOf(StringView symbols, size_t pos = 0) const { return StringView(*this).FindFirstOf(symbols, pos); };
+
+	bool Contains(StringView needle) const { return Find(needle) != NPos; };
+	bool Contains(char symbol) const { return Find(symbol) != NPos; };
+	bool StartsWith(StringView prefix) const { return StringView(*this).StartsWith(prefix); };
+	bool EndsWith(StringView suffix) const { return StringView(*this).EndsWith(suffix); };
+	bool EqualsIgnoreCase(StringView other) const { return StringView(*this).EqualsIgnoreCase(other); };
+
+	// ASCII case mapping in place; other bytes, UTF-8 sequences included, stay as they are.
+	// ToLower(text) and ToUpper(text) below make mapped copies.
+	BasicString& ToLower() {
+		BytesToLower(Buffer(), Size(), Buffer());
+		return *this;
+	};
+	BasicString& ToUpper() {
+		BytesToUpper(Buffer(), Size(), Buffer());
+		return *this;
+	};
+
+	// Removes ASCII whitespace from both ends, the front or the back, in place, keeping the
+	// capacity. For a trimmed copy, construct a string from StringView::Trim().
+	BasicString& Trim() { return RTrim().LTrim(); };
+	BasicString& LTrim() {
+		StringView rest = StringView(*this).LTrim();
+		if (rest.Size() != Size()) {
+			memmove(Buffer(), rest.Data(), rest.Size());
+			SetSize(rest.Size());
 		}
-		Data_[Size_] = '\0';
-		Capacity_ = Size_ + 1;
+		return *this;
+	};
+	BasicString& RTrim() {
+		SetSize(StringView(*this).RTrim().Size());
+		return *this;
+	};
+
+	// 64-bit hash of the characters (see hash.hpp); a String and a StringView of it hash equally.
+	uint64_t Hash(uint64_t seed = 0) const { return HashBytes(Buffer(), Size(), seed); };
+
+	// UTF-8 of the characters, see StringView.
+	bool IsValidUtf8() const { return StringView(*this).IsValidUtf8(); };
+	size_t CodePointCount() const { return StringView(*this).CodePointCount(); };
+	Utf8Range CodePoints() const { return Utf8Range(*this); };
+
+	// Defined in the class, so that they are found through either operand and convert the other
+	// one: str == "text", concat == str, "text" + std::move(str).
+	friend bool operator== (const BasicString& lhs, const BasicString& rhs) { return StringView(lhs) == StringView(rhs); };
+	// Lexicographic order of the bytes as unsigned char; negative, zero or positive like memcmp.
+	friend int operator<=> (const BasicString& lhs, const BasicString& rhs) { return StringView(lhs) <=> StringView(rhs); };
+	// Views and C strings are compared in place: converting a long literal to a BasicString
+	// would allocate on every comparison.
+	friend bool operator== (const BasicString& lhs, StringView rhs) { return StringView(lhs) == rhs; };
+	friend int operator<=> (const BasicString& lhs, StringView rhs) { return StringView(lhs) <=> rhs; };
+	friend bool operator== (const BasicString& lhs, const char *rhs) { return StringView(lhs) == StringView(rhs); };
+	friend int operator<=> (const BasicString& lhs, const char *rhs) { return StringView(lhs) <=> StringView(rhs); };
+
+	// A temporary operand is consumed: its buffer is reused for, or replaced by, the result.
+	friend BasicString operator+ (BasicString&& lhs, const BasicString& rhs) {
+		lhs += rhs;
+		return std::move(lhs);
+	};
+	friend BasicString operator+ (const BasicString& lhs, BasicString&& rhs) {
+		rhs.Prepend(lhs);
+		return std::move(rhs);
 	};
+	friend BasicString operator+ (BasicString&& lhs, BasicString&& rhs) {
+		lhs += rhs;
+		return std::move(lhs);
+	};
+
+	template <typename A>
+	friend BasicString<A> ReadAll(std::istream& stream, const A& alloc);
+	template <typename A>
+	friend std::istream& operator>> (std::istream& stream, BasicString<A>& first);
+	template <typename A>
+	friend std::istream& GetLine(std::istream& stream, BasicString<A>& line, char delimiter);
+
+	~BasicString() { FreeBuffer(); };
+};
+
+using String = BasicString<std::allocator<char>>;
+using PmrString = BasicString<std::pmr::polymorphic_allocator<char>>;
+
+// Stream I/O works on the stream buffer in bulk: operator<< is one write(), operator>> reads
+// one whitespace-delimited token (like std::string: leading whitespace is skipped unless
+// noskipws is set, width() limits the length) through the inline sgetc()/snextc() of the stream
+// buffer, GetLine leaves the search for the delimiter to istream::getline.
+// operator>>, GetLine and ReadAll are compiled in str.cpp for String and PmrString.
+template <typename Allocator>
+std::ostream& operator<< (std::ostream& stream, const BasicString<Allocator>& first) {
+	return stream.write(first.Data(), first.Size());
+}
+
+// Copies of text with ASCII letters mapped, written in one pass into a string of exactly that size.
+template <typename Allocator = std::allocator<char>>
+BasicString<Allocator> ToLower(StringView text, const Allocator& alloc = Allocator()) {
+	BasicString<Allocator> result(alloc);
+	result.Reserve(text.Size());
+	result.AppendWith(text.Size(), [text](char *out) { BytesToLower(text.Data(), text.Size(), out); });
+	return result;
+}
+
+template <typename Allocator = std::allocator<char>>
+BasicString<Allocator> ToUpper(StringView text, const Allocator& alloc = Allocator()) {
+	BasicString<Allocator> result(alloc);
+	result.Reserve(text.Size());
+	result.AppendWith(text.Size(), [text](char *out) { BytesToUpper(text.Data(), text.Size(), out); });
+	return result;
+}
+
+template <typename Allocator>
+struct std::hash<BasicString<Allocator>> {
+	size_t operator()(const BasicString<Allocator>& str) const { return str.Hash(); };
+};
+
+template <typename T>
+struct IsBasicString : std::false_type {};
+
+template <typename Allocator>
+struct IsBasicString<BasicString<Allocator>> : std::true_type {};
+
+template <typename T>
+struct IsStringExpression : IsBasicString<T> {};
+
+template <typename Lhs, typename Rhs>
+struct IsStringExpression<StringConcat<Lhs, Rhs>> : std::true_type {};
 
-	friend String operator+ (const String& lhs, const String& rhs);
-	friend bool operator== (const String &lhs, const String& rhs);
-	friend int operator <=>(const String& lhs, const String& rhs);
-	friend std::ostream& operator<< (std::ostream& stream, const String& first);
-	friend std::istream& operator>> (std::istream& stream, String& first);
-	~String() {
-		delete [] Data_;
-		Data_ = nullptr;
-		Size_ = 0;
-		Capacity_ = 1;
+// Lazy result of lhs + rhs: it only remembers its operands, and converting it to a String
+// adds up the length of the whole chain and copies every part into one buffer.
+// Strings are held by reference, so keep the result in a String rather than in auto.
+template <typename Lhs, typename Rhs>
+class StringConcat {
+private:
+	template <typename T>
+	using Operand = std::conditional_t<IsBasicString<T>::value, const T&, T>;
+
+	Operand<Lhs> Lhs_;
+	Operand<Rhs> Rhs_;
+
+	template <typename T>
+	static char *CopyPart(const T& part, char *out) {
+		if constexpr (IsBasicString<T>::value) {
+			memcpy(out, part.Data(), part.Size());
+			return out + part.Size();
+		} else {
+			return part.CopyTo(out);
+		}
 	};
+
+public:
+	StringConcat(const Lhs& lhs, const Rhs& rhs) : Lhs_(lhs), Rhs_(rhs) {};
+
+	size_t Size() const { return Lhs_.Size() + Rhs_.Size(); };
+
+	// Writes the characters (without a NUL) to out and returns the end of the written range.
+	char *CopyTo(char *out) const { return CopyPart(Rhs_, CopyPart(Lhs_, out)); };
 };
+
+template <typename Lhs, typename Rhs>
+	requires (IsStringExpression<Lhs>::value && IsStringExpression<Rhs>::value)
+StringConcat<Lhs, Rhs> operator+ (const Lhs& lhs, const Rhs& rhs) {
+	return StringConcat<Lhs, Rhs>(lhs, rhs);
+}
+
+template <typename Allocator, typename Lhs, typename Rhs>
+BasicString<Allocator> operator+ (BasicString<Allocator>&& lhs, const StringConcat<Lhs, Rhs>& rhs) {
+	lhs += rhs;
+	return std::move(lhs);
+}
+
+// The chain may refer to rhs itself, so the result is built next to it, in its allocator.
+template <typename Allocator, typename Lhs, typename Rhs>
+BasicString<Allocator> operator+ (const StringConcat<Lhs, Rhs>& lhs, BasicString<Allocator>&& rhs) {
+	BasicString<Allocator> result(rhs.GetAllocator());
+	result.Reserve(lhs.Size() + rhs.Size());
+	result += lhs;
+	result += rhs;
+	return result;
+}
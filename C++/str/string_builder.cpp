@@ -0,0 +1,66 @@
+#include "string_builder.hpp"
+
+StringBuilder& StringBuilder::AppendSlow(StringView text) {
+	if (text.Empty()) return *this;
+	// Top up the current chunk, so that only the last chunk is ever partly filled.
+	size_t head = Left_;
+	if (head != 0) memcpy(Cursor_, text.Data(), head);
+	AddChunk(text.Size() - head);
+	memcpy(Cursor_, text.Data() + head, text.Size() - head);
+	Cursor_ += text.Size() - head;
+	Left_ -= text.Size() - head;
+	Size_ += text.Size();
+	return *this;
+}
+
+void StringBuilder::AddChunk(size_t required) {
+	size_t capacity = Chunks_.empty() ? FirstChunk : 2 * Chunks_.back().Capacity;
+	if (capacity < required) capacity = required;
+	Chunks_.push_back(Chunk{std::unique_ptr<char[]>(new char[capacity]), capacity});
+	Cursor_ = Chunks_.back().Data.get();
+	Left_ = capacity;
+}
+
+void StringBuilder::Clear() {
+	if (Chunks_.empty()) return;
+	Chunk last = std::move(Chunks_.back());
+	Chunks_.clear();
+	Chunks_.push_back(std::move(last));
+	Cursor_ = Chunks_.back().Data.get();
+	Left_ = Chunks_.back().Capacity;
+	Size_ = 0;
+}
+
+Vector<StringView> StringBuilder::Chunks() const {
+	Vector<StringView> chunks;
+	for (size_t i = 0; i < Chunks_.size(); ++i) {
+		size_t used = Used(i);
+		if (used != 0) chunks.PushBack(StringView(Chunks_[i].Data.get(), used));
+	}
+	return chunks;
+}
+
+char *StringBuilder::CopyTo(char *out) const {
+	for (size_t i = 0; i < Chunks_.size(); ++i) {
+		size_t used = Used(i);
+		memcpy(out, Chunks_[i].Data.get(), used);
+		out += used;
+	}
+	return out;
+}
+
+String StringBuilder::ToString() const {
+	String result;
+	result.Reserve(Size_);
+	for (size_t i = 0; i < Chunks_.size(); ++i) {
+		result.Append(StringView(Chunks_[i].Data.get(), Used(i)));
+	}
+	return result;
+}
+
+std::ostream& operator<< (std::ostream& stream, const StringBuilder& builder) {
+	for (size_t i = 0; i < builder.Chunks_.size(); ++i) {
+		stream.write(builder.Chunks_[i].Data.get(), builder.Used(i));
+	}
+	return stream;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../vector.cpp"
+#include "str.hpp"
+
+// Accumulates text in a list of chunks and turns it into one String at the end.
+//
+// A chunk is never reallocated once created: when it fills up the next one is allocated, twice
+// as large as the previous (or large enough for the piece being appended), so appending n bytes
+// in small pieces costs O(log n) allocations and copies every byte once. ToString() then copies
+// every byte once more into an exactly sized String. Writers that do not need a contiguous copy
+// can take Chunks() and emit the pieces directly, e.g. with writev:
+//   Vector<StringView> chunks = builder.Chunks();
+//   for (size_t i = 0; i < chunks.Size(); ++i) iov[i] = {(void *)chunks[i].Data(), chunks[i].Size()};
+class StringBuilder {
+public:
+	// Capacity of the first chunk.
+	static constexpr size_t FirstChunk = 256;
+
+	StringBuilder() {};
+	StringBuilder(const StringBuilder&) = delete;
+	StringBuilder& operator= (const StringBuilder&) = delete;
+	StringBuilder(StringBuilder&&) = default;
+	StringBuilder& operator= (StringBuilder&&) = default;
+
+	StringBuilder& Append(StringView text) {
+		// Empty text wraps around and takes the slow path, which keeps memcpy away from null pointers.
+		if (text.Size() - 1 < Left_) {
+			memcpy(Cursor_, text.Data(), text.Size());
+			Cursor_ += text.Size();
+			Left_ -= text.Size();
+			Size_ += text.Size();
+			return *this;
+		}
+		return AppendSlow(text);
+	};
+	StringBuilder& Append(char symbol) {
+		if (Left_ == 0) AddChunk(1);
+		*Cursor_++ = symbol;
+		--Left_;
+		++Size_;
+		return *this;
+	};
+	StringBuilder& operator+= (StringView text) { return Append(text); };
+	StringBuilder& operator+= (char symbol) { return Append(symbol); };
+
+	size_t Size() const { return Size_; };
+	bool Empty() const { return Size_ == 0; };
+	// Drops the text; the largest chunk is kept for reuse.
+	void Clear();
+
+	// The text as consecutive pieces, valid until the next change of the builder.
+	Vector<StringView> Chunks() const;
+	// Writes Size() characters (without a NUL) to out and returns the end of the written range.
+	char *CopyTo(char *out) const;
+	// Contiguous copy of the text, allocated once with capacity Size().
+	String ToString() const;
+
+	friend std::ostream& operator<< (std::ostream& stream, const StringBuilder& builder);
+
+private:
+	struct Chunk {
+		std::unique_ptr<char[]> Data;
+		size_t Capacity;
+	};
+
+	// Filled in order: every chunk but the last is full, the last one up to Cursor_.
+	std::vector<Chunk> Chunks_;
+	char *Cursor_ = nullptr;
+	size_t Left_ = 0;
+	size_t Size_ = 0;
+
+	StringBuilder& AppendSlow(StringView text);
+	void AddChunk(size_t required);
+	size_t Used(size_t chunk) const { return chunk + 1 == Chunks_.size() ? Chunks_[chunk].Capacity - Left_ : Chunks_[chunk].Capacity; };
+};
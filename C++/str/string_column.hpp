@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include "../vector.cpp"
+#include "str.hpp"
+
+// Read-only view of consecutive strings of a column: string i is Bytes[Offsets[i], Offsets[i + 1]).
+// Offsets are positions in the whole column's bytes, so slicing only moves the Offsets pointer and
+// copies nothing. Valid until the column it came from is changed or destroyed.
+template <typename Offset>
+class BasicStringColumnSlice {
+public:
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = StringView;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = StringView;
+
+		Iterator(const char *bytes, const Offset *offset) : Bytes_(bytes), Offset_(offset) {};
+
+		StringView operator*() const { return StringView(Bytes_ + Offset_[0], Offset_[1] - Offset_[0]); };
+		Iterator& operator++() {
+			++Offset_;
+			return *this;
+		};
+		Iterator operator++(int) {
+			Iterator copy = *this;
+			++Offset_;
+			return copy;
+		};
+		bool operator==(const Iterator& other) const { return Offset_ == other.Offset_; };
+		bool operator!=(const Iterator& other) const { return Offset_ != other.Offset_; };
+
+	private:
+		const char *Bytes_;
+		const Offset *Offset_;
+	};
+
+	BasicStringColumnSlice(const char *bytes, const Offset *offsets, size_t size)
+		: Bytes_(bytes), Offsets_(offsets), Size_(size) {};
+
+	size_t Size() const { return Size_; };
+	bool Empty() const { return Size_ == 0; };
+	// Total length of the strings in the slice.
+	size_t ByteSize() const { return Offsets_[Size_] - Offsets_[0]; };
+
+	StringView operator[] (size_t i) const { return StringView(Bytes_ + Offsets_[i], Offsets_[i + 1] - Offsets_[i]); };
+	StringView At(size_t i) const {
+		if (i >= Size_)
+			throw std::out_of_range("Wrong index");
+		return (*this)[i];
+	};
+	StringView Front() const { return (*this)[0]; };
+	StringView Back() const { return (*this)[Size_ - 1]; };
+
+	// At most count strings starting at pos, like StringView::Substr.
+	BasicStringColumnSlice Slice(size_t pos, size_t count = StringView::NPos) const {
+		if (pos > Size_)
+			throw std::out_of_range("Wrong index");
+		return BasicStringColumnSlice(Bytes_, Offsets_ + pos, count < Size_ - pos ? count : Size_ - pos);
+	};
+
+	Iterator begin() const { return Iterator(Bytes_, Offsets_); };
+	Iterator end() const { return Iterator(Bytes_, Offsets_ + Size_); };
+
+	// The raw buffers, laid out as an Arrow string array: Offsets() has Size() + 1 entries.
+	const char *Bytes() const { return Bytes_; };
+	const Offset *Offsets() const { return Offsets_; };
+
+private:
+	const char *Bytes_;
+	const Offset *Offsets_;
+	size_t Size_;
+};
+
+// Many strings in two flat buffers, as Arrow lays out a string array: the characters of all the
+// strings back to back, and Size() + 1 offsets where string i starts and ends. Each string costs
+// one offset instead of a String object with its own allocation, and reading the strings in order
+// walks two arrays front to back. Strings are only appended; operator[] returns a StringView.
+//   StringColumn names;
+//   for (StringView line : Split(text, '\n')) names.PushBack(line);
+// StringColumn has 32-bit offsets and holds up to 4 GiB of characters, LargeStringColumn has
+// 64-bit ones. Appending past what the offsets can address throws std::length_error.
+template <typename Offset>
+class BasicStringColumn {
+public:
+	using Iterator = typename BasicStringColumnSlice<Offset>::Iterator;
+
+	BasicStringColumn() {};
+	BasicStringColumn(std::initializer_list<StringView> strings) {
+		for (StringView str : strings) PushBack(str);
+	};
+
+	size_t Size() const { return Offsets_.Empty() ? 0 : Offsets_.Size() - 1; };
+	bool Empty() const { return Size() == 0; };
+	size_t ByteSize() const { return Bytes_.Size(); };
+
+	StringView operator[] (size_t i) const { return StringView(Bytes_.Data() + Offsets_[i], Offsets_[i + 1] - Offsets_[i]); };
+	StringView At(size_t i) const { return View().At(i); };
+	StringView Front() const { return (*this)[0]; };
+	StringView Back() const { return (*this)[Size() - 1]; };
+
+	BasicStringColumnSlice<Offset> View() const {
+		return BasicStringColumnSlice<Offset>(Bytes_.Data(), Offsets_.Empty() ? &Zero_ : Offsets_.Data(), Size());
+	};
+	operator BasicStringColumnSlice<Offset>() const { return View(); };
+	BasicStringColumnSlice<Offset> Slice(size_t pos, size_t count = StringView::NPos) const { return View().Slice(pos, count); };
+
+	Iterator begin() const { return View().begin(); };
+	Iterator end() const { return View().end(); };
+
+	const char *Bytes() const { return Bytes_.Data(); };
+	const Offset *Offsets() const { return View().Offsets(); };
+
+	void PushBack(StringView str) {
+		size_t size = Bytes_.Size();
+		CheckCapacity(str.Size());
+		// Room for the offset first: once the bytes are in, nothing may throw and leave them
+		// without one.
+		ReserveOffsets(Size() + 1);
+		// str may be a string of this column: Vector copies it before growing moves it.
+		AppendBytes(str.Data(), str.Size());
+		if (Offsets_.Empty()) Offsets_.PushBack(0);
+		Offsets_.PushBack(static_cast<Offset>(size + str.Size()));
+	};
+
+	// Appends all the strings of other with one copy of their characters; the offsets are shifted
+	// to the end of this column.
+	void Append(BasicStringColumnSlice<Offset> other) {
+		if (other.Empty()) return;
+		// A slice of this column: its offsets move when this column grows.
+		if (Owns(Offsets_, other.Offsets())) {
+			BasicStringColumn copy;
+			copy.Append(other);
+			Append(copy.View());
+			return;
+		}
+		size_t bytes = other.ByteSize();
+		CheckCapacity(bytes);
+		ReserveOffsets(Size() + other.Size());
+		const Offset *offsets = other.Offsets();
+		size_t first = offsets[0], shift = Bytes_.Size();
+		AppendBytes(other.Bytes() + first, bytes);
+		// Constructed in the capacity reserved above: nothing is zero-filled first, and nothing can
+		// throw once the bytes are in.
+		if (Offsets_.Empty()) Offsets_.PushBack(0);
+		Offsets_.Append(std::views::iota(size_t(1), other.Size() + 1) | std::views::transform([&](size_t i) {
+			return static_cast<Offset>(offsets[i] - first + shift);
+		}));
+	};
+
+	void Reserve(size_t strings, size_t bytes) {
+		Bytes_.Reserve(bytes);
+		Offsets_.Reserve(strings + 1);
+	};
+	void Clear() {
+		Bytes_.Clear();
+		Offsets_.Clear();
+	};
+	void Swap(BasicStringColumn& other) {
+		Bytes_.Swap(other.Bytes_);
+		Offsets_.Swap(other.Offsets_);
+	};
+
+private:
+	Vector<char> Bytes_;
+	// Empty until the first string, then Size() + 1 entries starting with 0.
+	Vector<Offset> Offsets_;
+
+	static constexpr Offset Zero_ = 0;
+
+	template <typename T>
+	static bool Owns(const Vector<T>& storage, const T *pointer) {
+		return !storage.Empty() && std::less_equal<const T *>()(storage.Data(), pointer)
+			&& std::less<const T *>()(pointer, storage.Data() + storage.Size());
+	};
+
+	void CheckCapacity(size_t added) const {
+		if (added > std::numeric_limits<Offset>::max() - Bytes_.Size())
+			throw std::length_error("StringColumn: more characters than the offsets can address");
+	};
+
+	// Copies the characters straight into the spare capacity, growing at least twice so that
+	// appending is amortized O(1) per character; nothing is zero-filled first.
+	void AppendBytes(const char *data, size_t count) { Bytes_.Insert(Bytes_.cend(), data, data + count); };
+
+	void ReserveOffsets(size_t strings) {
+		if (Offsets_.Capacity() < strings + 1) Offsets_.Reserve(std::max(strings + 1, 2 * Offsets_.Capacity()));
+	};
+};
+
+using StringColumn = BasicStringColumn<uint32_t>;
+using LargeStringColumn = BasicStringColumn<uint64_t>;
+using StringColumnSlice = BasicStringColumnSlice<uint32_t>;
+using LargeStringColumnSlice = BasicStringColumnSlice<uint64_t>;
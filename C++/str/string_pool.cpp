@@ -0,0 +1,80 @@
+#include "string_pool.hpp"
+#include <new>
+#include "simd.hpp"
+
+// Constant-initialized, so that handles made by other static initializers already see its hash.
+constinit const InternedString::EmptyEntry InternedString::Empty_ = {{HashEmpty(), 0}, '\0'};
+
+// Slot that holds text, or the free slot where it would go. The table is never full.
+size_t StringPool::Probe(StringView text, uint64_t hash) const {
+	size_t mask = Slots_.size() - 1;
+	for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+		const Entry *entry = Slots_[slot];
+		if (entry == nullptr) return slot;
+		if (entry->Hash == hash && entry->Size == text.Size() && BytesEqual(entry->Data(), text.Data(), text.Size()))
+			return slot;
+	}
+}
+
+InternedString StringPool::Find(StringView text) const {
+	if (text.Empty() || Slots_.empty()) return InternedString();
+	const Entry *entry = Slots_[Probe(text, text.Hash())];
+	return entry == nullptr ? InternedString() : InternedString(entry);
+}
+
+InternedString StringPool::Intern(StringView text) {
+	if (text.Empty()) return InternedString();
+	// Keep the load factor at most 1/2 so that probe sequences stay short.
+	if (2 * (Size_ + 1) > Slots_.size()) Rehash(Slots_.empty() ? 64 : 2 * Slots_.size());
+
+	uint64_t hash = text.Hash();
+	const Entry *&slot = Slots_[Probe(text, hash)];
+	if (slot == nullptr) {
+		slot = Store(text, hash);
+		++Size_;
+	}
+	return InternedString(slot);
+}
+
+// Copies text into the arena. Strings too large to share a block get a block of their own,
+// so that the rest of the current block is not wasted.
+const StringPool::Entry *StringPool::Store(StringView text, uint64_t hash) {
+	size_t bytes = (sizeof(Entry) + text.Size() + 1 + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+	char *memory;
+	if (bytes > BlockSize_ / 4) {
+		Blocks_.emplace_back(new char[bytes]);
+		BlockBytes_ += bytes;
+		memory = Blocks_.back().get();
+	} else {
+		if (bytes > Left_) {
+			Blocks_.emplace_back(new char[BlockSize_]);
+			BlockBytes_ += BlockSize_;
+			Cursor_ = Blocks_.back().get();
+			Left_ = BlockSize_;
+		}
+		memory = Cursor_;
+		Cursor_ += bytes;
+		Left_ -= bytes;
+	}
+
+	Entry *entry = new (memory) Entry{hash, text.Size()};
+	memcpy(memory + sizeof(Entry), text.Data(), text.Size());
+	memory[sizeof(Entry) + text.Size()] = '\0';
+	return entry;
+}
+
+void StringPool::Rehash(size_t slots) {
+	std::vector<const Entry *> old(slots, nullptr);
+	old.swap(Slots_);
+	size_t mask = slots - 1;
+	for (const Entry *entry : old) {
+		if (entry == nullptr) continue;
+		size_t slot = entry->Hash & mask;
+		while (Slots_[slot] != nullptr) slot = (slot + 1) & mask;
+		Slots_[slot] = entry;
+	}
+}
+
+size_t StringPool::MemoryUsage() const {
+	return BlockBytes_ + Slots_.capacity() * sizeof(const Entry *) + Blocks_.capacity() * sizeof(Blocks_[0]);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "str.hpp"
+
+class StringPool;
+
+// Handle to a string stored once in a StringPool. It is one pointer wide, so copying it is free;
+// two handles from the same pool are equal exactly when they point to the same entry, and the
+// hash is computed once, when the string is interned. Valid as long as the pool that issued it.
+// A default-constructed handle is the empty string, which every pool interns to the same handle.
+class InternedString {
+private:
+	// Entries live in the pool's arena: the header followed by Size characters and a '\0'.
+	struct Entry {
+		uint64_t Hash;
+		size_t Size;
+
+		const char *Data() const { return reinterpret_cast<const char *>(this + 1); };
+	};
+
+	// The shared empty string, laid out like an arena entry.
+	struct EmptyEntry {
+		Entry Header;
+		char Terminator;
+	};
+	static const EmptyEntry Empty_;
+
+	const Entry *Entry_ = &Empty_.Header;
+
+	explicit InternedString(const Entry *entry) : Entry_(entry) {};
+
+	friend class StringPool;
+
+public:
+	InternedString() {};
+
+	const char *Data() const { return Entry_->Data(); };
+	const char *CStr() const { return Entry_->Data(); };
+	size_t Size() const { return Entry_->Size; };
+	size_t Length() const { return Entry_->Size; };
+	bool Empty() const { return Entry_->Size == 0; };
+	// Equal to StringView::Hash() of the characters.
+	uint64_t Hash() const { return Entry_->Hash; };
+
+	operator StringView() const { return StringView(Data(), Size()); };
+
+	friend bool operator== (InternedString lhs, InternedString rhs) { return lhs.Entry_ == rhs.Entry_; };
+};
+
+// Deduplicating store for many repeated strings (host names, metric names, user agents...).
+// Every distinct content is copied once into large arena blocks, so a string costs its length plus
+// a 16-byte header instead of a heap allocation per copy. Intern() looks the content up in an
+// open-addressing table keyed by the hash. Not thread-safe; entries are freed with the pool.
+class StringPool {
+public:
+	StringPool() {};
+	StringPool(const StringPool&) = delete;
+	StringPool& operator= (const StringPool&) = delete;
+
+	// Handle to the pooled copy of text, adding it if it is not in the pool yet.
+	InternedString Intern(StringView text);
+	// Handle to text if it was interned before, otherwise the empty handle; never adds anything.
+	InternedString Find(StringView text) const;
+	bool Contains(StringView text) const { return text.Empty() || !Find(text).Empty(); };
+
+	// Number of distinct non-empty strings in the pool.
+	size_t Size() const { return Size_; };
+	// Bytes taken by the arena blocks and the lookup table.
+	size_t MemoryUsage() const;
+
+private:
+	using Entry = InternedString::Entry;
+
+	static constexpr size_t BlockSize_ = 64 * 1024;
+
+	// Open addressing with linear probing; nullptr marks a free slot. The size is a power of two.
+	std::vector<const Entry *> Slots_;
+	size_t Size_ = 0;
+
+	std::vector<std::unique_ptr<char[]>> Blocks_;
+	size_t BlockBytes_ = 0;
+	char *Cursor_ = nullptr;
+	size_t Left_ = 0;
+
+	size_t Probe(StringView text, uint64_t hash) const;
+	const Entry *Store(StringView text, uint64_t hash);
+	void Rehash(size_t slots);
+};
+
+template <>
+struct std::hash<InternedString> {
+	size_t operator()(InternedString str) const { return str.Hash(); };
+};
@@ -0,0 +1,177 @@
+#include "string_sort.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace string_sort_detail {
+
+namespace {
+
+constexpr size_t InsertionSortMax = 16;
+// The radix pass pays for its 65536 counters from this many strings on.
+constexpr size_t RadixMin = 1 << 15;
+constexpr size_t BucketBits = 16;
+constexpr size_t Buckets = size_t(1) << BucketBits;
+// Below this many strings handing the work to other threads costs more than it saves.
+constexpr size_t ParallelMin = 1 << 16;
+
+uint64_t Median(uint64_t a, uint64_t b, uint64_t c) {
+	return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+uint64_t Pivot(const Entry *entries, size_t size) {
+	if (size < 1024) return Median(entries[0].Key, entries[size / 2].Key, entries[size - 1].Key);
+	size_t step = size / 8;
+	return Median(Median(entries[0].Key, entries[step].Key, entries[2 * step].Key),
+		Median(entries[3 * step].Key, entries[4 * step].Key, entries[5 * step].Key),
+		Median(entries[6 * step].Key, entries[7 * step].Key, entries[size - 1].Key));
+}
+
+// Bentley-McIlroy three-way partition: keys below pivot end up in [0, less), equal ones in
+// [less, greater) and the ones above in [greater, size). Equal keys are parked at both ends while
+// scanning and moved to the middle at the end, so distinct keys cost one swap per misplaced pair.
+std::pair<size_t, size_t> Partition(Entry *entries, size_t size, uint64_t pivot) {
+	ptrdiff_t a = 0, b = 0, c = size - 1, d = size - 1;
+	while (true) {
+		for (; b <= c && entries[b].Key <= pivot; ++b)
+			if (entries[b].Key == pivot) std::swap(entries[a++], entries[b]);
+		for (; b <= c && entries[c].Key >= pivot; --c)
+			if (entries[c].Key == pivot) std::swap(entries[c], entries[d--]);
+		if (b > c) break;
+		std::swap(entries[b++], entries[c--]);
+	}
+	ptrdiff_t end = size;
+	std::swap_ranges(entries, entries + std::min(a, b - a), entries + b - std::min(a, b - a));
+	std::swap_ranges(entries + b, entries + b + std::min(d - c, end - 1 - d), entries + end - std::min(d - c, end - 1 - d));
+	return {b - a, end - (d - c)};
+}
+
+// Multikey quicksort of entries whose strings are Views[entry.Index].
+class Sorter {
+public:
+	explicit Sorter(const StringView *views) : Views_(views) {};
+
+	// Three-way quicksort on the cached keys. Recurses into the smaller side and loops on the
+	// larger, so the stack stays O(log size) per depth.
+	void Sort(Entry *entries, size_t size, size_t depth) const {
+		while (size > InsertionSortMax) {
+			auto [less, greater] = Partition(entries, size, Pivot(entries, size));
+			if (greater - less > 1) SortEqualKeys(entries + less, greater - less, depth);
+			if (less < size - greater) {
+				Sort(entries, less, depth);
+				entries += greater;
+				size -= greater;
+			} else {
+				Sort(entries + greater, size - greater, depth);
+				size = less;
+			}
+		}
+		InsertionSort(entries, size, depth);
+	};
+
+private:
+	const StringView *Views_;
+
+	size_t Size(const Entry& entry) const { return Views_[entry.Index].Size(); };
+
+	// Order of whole strings whose keys are loaded at depth and whose first depth bytes are equal.
+	bool Less(const Entry& lhs, const Entry& rhs, size_t depth) const {
+		if (lhs.Key != rhs.Key) return lhs.Key < rhs.Key;
+		StringView left = Views_[lhs.Index], right = Views_[rhs.Index];
+		size_t next = depth + 8;
+		// Equal keys and one string ends within them: it is a prefix of the other (the zeros that
+		// pad its key match the other's bytes), so the shorter one goes first.
+		if (left.Size() <= next || right.Size() <= next) return left.Size() < right.Size();
+		return left.Substr(next) < right.Substr(next);
+	};
+
+	void InsertionSort(Entry *entries, size_t size, size_t depth) const {
+		for (size_t i = 1; i < size; ++i) {
+			Entry entry = entries[i];
+			size_t j = i;
+			for (; j > 0 && Less(entry, entries[j - 1], depth); --j) entries[j] = entries[j - 1];
+			entries[j] = entry;
+		}
+	};
+
+	// All keys are equal: the strings that end within them go first, by length, and the others
+	// are sorted by their next 8 bytes.
+	void SortEqualKeys(Entry *entries, size_t size, size_t depth) const {
+		size_t next = depth + 8;
+		Entry *longer = std::partition(entries, entries + size, [&](const Entry& entry) { return Size(entry) <= next; });
+		std::sort(entries, longer, [&](const Entry& lhs, const Entry& rhs) { return Size(lhs) < Size(rhs); });
+		size_t rest = entries + size - longer;
+		if (rest < 2) return;
+		for (Entry *entry = longer; entry != entries + size; ++entry) {
+			StringView view = Views_[entry->Index];
+			entry->Key = LoadKey(view.Data(), view.Size(), next);
+		}
+		Sort(longer, rest, next);
+	};
+};
+
+}  // namespace
+
+ThreadPool *UsefulPool(ThreadPool *pool, size_t size) {
+	return pool == nullptr || pool->Threads() == 1 || size < ParallelMin ? nullptr : pool;
+}
+
+void SortEntries(Vector<Entry>& entries, const StringView *views, ThreadPool *pool) {
+	size_t size = entries.Size();
+	const Sorter sorter(views);
+	if (size < RadixMin) {
+		sorter.Sort(entries.Data(), size, 0);
+		return;
+	}
+
+	// Counting sort by the first two bytes, in one chunk per thread. Each chunk is counted on
+	// its own, so that it can be scattered to its own slots of every bucket.
+	size_t chunks = pool == nullptr ? 1 : pool->Threads();
+	auto chunk_begin = [&](size_t chunk) { return size / chunks * chunk + std::min(size % chunks, chunk); };
+	std::vector<size_t> slots(chunks * Buckets);
+	ForRange(pool, chunks, 1, [&](size_t first, size_t last) {
+		for (size_t chunk = first; chunk < last; ++chunk) {
+			size_t *counts = slots.data() + chunk * Buckets;
+			for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+				++counts[entries[i].Key >> (64 - BucketBits)];
+		}
+	});
+	std::vector<size_t> bounds(Buckets + 1);
+	size_t total = 0;
+	for (size_t bucket = 0; bucket < Buckets; ++bucket) {
+		bounds[bucket] = total;
+		for (size_t chunk = 0; chunk < chunks; ++chunk) {
+			size_t count = slots[chunk * Buckets + bucket];
+			slots[chunk * Buckets + bucket] = total;
+			total += count;
+		}
+	}
+	bounds[Buckets] = total;
+
+	Vector<Entry> scattered(size);
+	ForRange(pool, chunks, 1, [&](size_t first, size_t last) {
+		for (size_t chunk = first; chunk < last; ++chunk) {
+			size_t *next = slots.data() + chunk * Buckets;
+			for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+				scattered[next[entries[i].Key >> (64 - BucketBits)]++] = entries[i];
+		}
+	});
+	entries.Swap(scattered);
+
+	// Largest buckets first, so that no thread is left with a big one at the end; each bucket is a
+	// range of its own, and the threads that run out of buckets steal the remaining ones.
+	std::vector<size_t> order;
+	for (size_t bucket = 0; bucket < Buckets; ++bucket)
+		if (bounds[bucket + 1] - bounds[bucket] > 1) order.push_back(bucket);
+	if (pool != nullptr)
+		std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+			return bounds[lhs + 1] - bounds[lhs] > bounds[rhs + 1] - bounds[rhs];
+		});
+	ForRange(pool, order.size(), 1, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			size_t bucket = order[i];
+			sorter.Sort(entries.Data() + bounds[bucket], bounds[bucket + 1] - bounds[bucket], 0);
+		}
+	});
+}
+
+}  // namespace string_sort_detail
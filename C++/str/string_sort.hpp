@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "../vector.cpp"
+#include "../thread_pool/thread_pool.hpp"
+#include "str.hpp"
+
+// Building blocks of SortStrings: the strings are sorted as an array of 16-byte entries that carry
+// the next 8 bytes of the key, so most comparisons read the entry alone and not the characters.
+namespace string_sort_detail {
+
+struct Entry {
+	uint64_t Key;  // bytes [depth, depth + 8) of the string, big-endian, padded with zeros
+	size_t Index;  // position of the string before sorting
+};
+
+// Big-endian, so that comparing keys as integers orders them as their bytes.
+inline uint64_t LoadKey(const char *data, size_t size, size_t depth) {
+	if (depth >= size) return 0;
+	uint64_t word = 0;
+	memcpy(&word, data + depth, size - depth < 8 ? size - depth : 8);
+	return __builtin_bswap64(word);
+}
+
+inline constexpr size_t PrefetchDistance = 16;
+
+// Runs body(begin, end) over [0, size) on pool, or at once on the calling thread without one.
+template <typename Body>
+void ForRange(ThreadPool *pool, size_t size, size_t grain, const Body& body) {
+	if (pool == nullptr)
+		body(0, size);
+	else
+		pool->ForRange(size, grain, body);
+}
+
+// Sorts entries whose keys are loaded at depth 0; views[entry.Index] is the string of an entry.
+void SortEntries(Vector<Entry>& entries, const StringView *views, ThreadPool *pool);
+
+// pool, or nullptr when it has a single thread or size strings are too few to be worth splitting.
+ThreadPool *UsefulPool(ThreadPool *pool, size_t size);
+
+template <typename T, typename Allocator>
+void Sort(Vector<T, Allocator>& strings, ThreadPool *pool) {
+	static_assert(IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>,
+		"the strings are relocated in place and cannot be put back if a move throws");
+	size_t size = strings.Size();
+	if (size < 2) return;
+	pool = UsefulPool(pool, size);
+	Vector<StringView> views(size);
+	Vector<Entry> entries(size);
+	ForRange(pool, size, 0, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			views[i] = strings[i];
+			entries[i] = Entry {LoadKey(views[i].Data(), views[i].Size(), 0), i};
+		}
+	});
+	SortEntries(entries, views.Data(), pool);
+	// The strings are relocated in sorted order into raw memory and back: T needs no default
+	// constructor, and trivially relocatable strings are copied as bytes both ways.
+	Vector<T, Allocator> sorted(strings.GetAllocator());
+	sorted.Reserve(size);
+	T *from = strings.Data(), *to = sorted.Data();
+	ForRange(pool, size, 0, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			// The sources are in random order: ask for them a few iterations ahead.
+			if (i + PrefetchDistance < end) __builtin_prefetch(from + entries[i + PrefetchDistance].Index);
+			vector_detail::Relocate(from + entries[i].Index, 1, to + i);
+		}
+	});
+	ForRange(pool, size, 0, [&](size_t begin, size_t end) { vector_detail::Relocate(to + begin, end - begin, from + begin); });
+}
+
+}  // namespace string_sort_detail
+
+// Sorts strings in the order of their operator<=>, as std::sort would, but without following
+// each string's pointer at every comparison: every string is represented by an entry holding its
+// next 8 bytes as a big-endian integer, the entries are split into 65536 buckets by their first
+// two bytes (MSD radix), and each bucket is sorted by multikey quicksort on the cached 8 bytes,
+// with insertion sort for small buckets. The characters are only read again to load the next
+// 8 bytes of strings that agree on the previous ones.
+// T is anything that converts to StringView and is trivially relocatable or can be moved without
+// throwing: String, PmrString, StringView, SharedString. Not stable; equal strings are
+// interchangeable anyway.
+template <typename T, typename Allocator>
+void SortStrings(Vector<T, Allocator>& strings) {
+	string_sort_detail::Sort(strings, nullptr);
+}
+
+// The same on a ThreadPool: the entries are built and moved in parallel ranges, and the buckets
+// are sorted as separate tasks, which idle threads steal. Small inputs stay on the calling thread.
+template <typename T, typename Allocator>
+void ParallelSortStrings(Vector<T, Allocator>& strings, ThreadPool& pool = ThreadPool::Default()) {
+	string_sort_detail::Sort(strings, &pool);
+}
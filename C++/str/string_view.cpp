@@ -0,0 +1,119 @@
+#include "string_view.hpp"
+#include <algorithm>
+#include <charconv>
+#include "simd.hpp"
+
+size_t StringView::Find(StringView needle, size_t pos) const {
+	if (pos > Size()) return NPos;
+	if (needle.Empty()) return pos;
+	const char *found = BytesFind(Data() + pos, Size() - pos, needle.Data(), needle.Size());
+	return found == nullptr ? NPos : found - Data();
+}
+
+size_t StringView::Find(char symbol, size_t pos) const {
+	if (pos >= Size()) return NPos;
+	const void *found = memchr(Data() + pos, symbol, Size() - pos);
+	return found == nullptr ? NPos : static_cast<const char *>(found) - Data();
+}
+
+size_t StringView::RFind(StringView needle, size_t pos) const {
+	if (needle.Size() > Size()) return NPos;
+	size_t last = std::min(pos, Size() - needle.Size());
+	if (needle.Empty()) return last;
+	const char *found = BytesRFind(Data(), last + needle.Size(), needle.Data(), needle.Size());
+	return found == nullptr ? NPos : found - Data();
+}
+
+size_t StringView::RFind(char symbol, size_t pos) const {
+	if (Empty()) return NPos;
+	size_t last = std::min(pos, Size() - 1);
+	const char *found = BytesRFindByte(Data(), last + 1, symbol);
+	return found == nullptr ? NPos : found - Data();
+}
+
+size_t StringView::FindFirstOf(StringView symbols, size_t pos) const {
+	if (pos >= Size()) return NPos;
+	const char *found = BytesFindFirstOf(Data() + pos, Size() - pos, symbols.Data(), symbols.Size());
+	return found == nullptr ? NPos : found - Data();
+}
+
+bool StringView::StartsWith(StringView prefix) const {
+	return prefix.Size() <= Size() && BytesEqual(Data(), prefix.Data(), prefix.Size());
+}
+
+bool StringView::EndsWith(StringView suffix) const {
+	return suffix.Size() <= Size() && BytesEqual(Data() + Size() - suffix.Size(), suffix.Data(), suffix.Size());
+}
+
+bool StringView::EqualsIgnoreCase(StringView other) const {
+	return other.Size() == Size() && BytesEqualIgnoreCase(Data(), other.Data(), Size());
+}
+
+namespace {
+
+// Most text has no whitespace at its ends: one byte tells, without calling the kernel.
+bool IsSpace(char symbol) {
+	return symbol == ' ' || static_cast<unsigned char>(symbol - '\t') < 5;
+}
+
+}  // namespace
+
+StringView StringView::LTrim() const {
+	if (Empty() || !IsSpace(Front())) return *this;
+	const char *first = BytesSkipSpace(Data(), Size());
+	return StringView(first, end() - first);
+}
+
+StringView StringView::RTrim() const {
+	if (Empty() || !IsSpace(Back())) return *this;
+	return StringView(Data(), BytesRSkipSpace(Data(), Size()) - Data());
+}
+
+bool operator== (StringView lhs, StringView rhs) {
+	return lhs.Size() == rhs.Size() && BytesEqual(lhs.Data(), rhs.Data(), lhs.Size());
+}
+
+int operator<=> (StringView lhs, StringView rhs) {
+	size_t nCompared = std::min(rhs.Size(), lhs.Size());
+	int result = BytesCompare(lhs.Data(), rhs.Data(), nCompared);
+	if (result != 0)
+		return result;
+	return (lhs.Size() > rhs.Size()) - (lhs.Size() < rhs.Size());
+}
+
+std::ostream& operator<< (std::ostream& stream, StringView view) {
+	return stream.write(view.Data(), view.Size());
+}
+
+bool StringView::IsValidUtf8() const {
+	return BytesValidUtf8(Data(), Size());
+}
+
+size_t StringView::CodePointCount() const {
+	return BytesCountCodePoints(Data(), Size());
+}
+
+namespace {
+
+template <typename Number, typename... Format>
+bool ParseWhole(StringView text, Number& value, Format... format) {
+	Number parsed;
+	auto [end, error] = std::from_chars(text.begin(), text.end(), parsed, format...);
+	if (error != std::errc() || end != text.end()) return false;
+	value = parsed;
+	return true;
+}
+
+}  // namespace
+
+bool ParseInt(StringView text, int64_t& value, int base) {
+	return ParseWhole(text, value, base);
+}
+
+bool ParseUInt(StringView text, uint64_t& value, int base) {
+	return ParseWhole(text, value, base);
+}
+
+bool ParseDouble(StringView text, double& value) {
+	return ParseWhole(text, value);
+}
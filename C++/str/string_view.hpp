@@ -0,0 +1,96 @@
+#pragma once
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+#include "hash.hpp"
+
+class Utf8Range;
+
+// Non-owning view of Size() bytes at Data(). It never allocates and is not NUL-terminated;
+// it stays valid only as long as the characters it points to (a String converts to one implicitly).
+class StringView {
+private:
+	const char *Data_ = nullptr;
+	size_t Size_ = 0;
+
+public:
+	// Returned by the Find family when there is no match.
+	static constexpr size_t NPos = ~size_t(0);
+
+	StringView() {};
+	StringView(const char *data, size_t size) : Data_(data), Size_(size) {};
+	StringView(const char *CStr) : Data_(CStr), Size_(CStr == nullptr ? 0 : strlen(CStr)) {};
+
+	const char& operator[](size_t i) const { return Data_[i]; };
+	const char& Front() const { return Data_[0]; };
+	const char& Back() const { return Data_[Size_ - 1]; };
+	const char *Data() const { return Data_; };
+
+	const char *begin() const { return Data_; };
+	const char *end() const { return Data_ + Size_; };
+
+	bool Empty() const { return Size_ == 0; };
+	size_t Size() const { return Size_; };
+	size_t Length() const { return Size_; };
+
+	// At most count characters starting at pos.
+	StringView Substr(size_t pos, size_t count = NPos) const {
+		if (pos > Size_)
+			throw std::out_of_range("Wrong index");
+		return StringView(Data_ + pos, count < Size_ - pos ? count : Size_ - pos);
+	};
+	void RemovePrefix(size_t count) {
+		Data_ += count;
+		Size_ -= count;
+	};
+	void RemoveSuffix(size_t count) { Size_ -= count; };
+
+	// Position of the first occurrence of needle that starts at or after pos, or NPos.
+	size_t Find(StringView needle, size_t pos = 0) const;
+	size_t Find(char symbol, size_t pos = 0) const;
+	// Position of the last occurrence of needle that starts at or before pos, or NPos.
+	size_t RFind(StringView needle, size_t pos = NPos) const;
+	size_t RFind(char symbol, size_t pos = NPos) const;
+	// Position of the first character at or after pos that is one of symbols, or NPos.
+	size_t FindFirstOf(StringView symbols, size_t pos = 0) const;
+
+	bool Contains(StringView needle) const { return Find(needle) != NPos; };
+	bool Contains(char symbol) const { return Find(symbol) != NPos; };
+	bool StartsWith(StringView prefix) const;
+	bool EndsWith(StringView suffix) const;
+	// Equal up to ASCII case, like "Content-Type" and "content-type"; other bytes compare exactly.
+	bool EqualsIgnoreCase(StringView other) const;
+
+	// The view without ASCII whitespace (space, \t, \n, \v, \f, \r) at both ends, the front
+	// or the back; the characters are not copied.
+	StringView Trim() const { return LTrim().RTrim(); };
+	StringView LTrim() const;
+	StringView RTrim() const;
+
+	// HashBytes of the characters; equal views hash equally whatever they point into.
+	uint64_t Hash(uint64_t seed = 0) const { return HashBytes(Data_, Size_, seed); };
+
+	// UTF-8, see utf8.hpp. CodePointCount() is only meaningful for valid text; CodePoints()
+	// iterates any bytes, reading malformed ones as U+FFFD, and is defined in utf8.hpp.
+	bool IsValidUtf8() const;
+	size_t CodePointCount() const;
+	Utf8Range CodePoints() const;
+};
+
+// Parse the whole text as one number, in the syntax of std::from_chars: an optional '-' for
+// ParseInt, no '+', no whitespace, no "0x" prefix. They return false and leave value unchanged
+// if anything else is there or the number does not fit.
+bool ParseInt(StringView text, int64_t& value, int base = 10);
+bool ParseUInt(StringView text, uint64_t& value, int base = 10);
+// Accepts fixed and scientific notation, "inf" and "nan".
+bool ParseDouble(StringView text, double& value);
+
+bool operator== (StringView lhs, StringView rhs);
+int operator<=> (StringView lhs, StringView rhs);
+std::ostream& operator<< (std::ostream& stream, StringView view);
+
+template <>
+struct std::hash<StringView> {
+	size_t operator()(StringView view) const { return view.Hash(); };
+};
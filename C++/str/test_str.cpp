@@ -1,8 +1,35 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 #include <string_view>
+#include <charconv>
+#include <cctype>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstring>
+#include <random>
+#include <iterator>
+#include <sstream>
+#include <string>
 #include "str.hpp"
+#include "pattern_matcher.hpp"
+#include "split.hpp"
+#include "string_pool.hpp"
+#include "string_builder.hpp"
+#include "mapped_file.hpp"
+#include "format.hpp"
+#include "shared_string.hpp"
+#include "string_column.hpp"
+#include "string_sort.hpp"
+#include "simd_kernels.hpp"
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <memory_resource>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <vector>
 
 const char* TEST_STRING = "test string";
 
@@ -17,9 +44,10 @@ void RequireEqual(const String& actual, std::string_view expected) {
 
 TEST_CASE("Default constructor + basic Data_access") {
   String s;
-  REQUIRE(s.Capacity() == 0);
+  REQUIRE(s.Capacity() == String::InlineCapacity);
   REQUIRE(s.Size() == 0);
-  REQUIRE(s.Data() == nullptr);
+  REQUIRE(s.Data() != nullptr);
+  REQUIRE(s.Data()[0] == '\0');
   REQUIRE(s.Empty());
   RequireEqual(s, "");
 }
@@ -32,7 +60,7 @@ TEST_CASE("Constructors", "C-style-string") {
 
   SECTION("From empty string") {
     const String s = "";
-    REQUIRE(s.Capacity() == 0);
+    REQUIRE(s.Capacity() == String::InlineCapacity);
     RequireEqual(s, "");
   }
 
@@ -43,7 +71,7 @@ TEST_CASE("Constructors", "C-style-string") {
 
   SECTION("From empty string prefix") {
     const String s(TEST_STRING, 0);
-    REQUIRE(s.Capacity() == 0);
+    REQUIRE(s.Capacity() == String::InlineCapacity);
     RequireEqual(s, "");
   }
 }
@@ -53,11 +81,11 @@ TEST_CASE("Copy Constructor", "[Constructor]") {
     const String empty;
     const auto copy = empty;
     REQUIRE(empty.Size() == 0);
-    REQUIRE(empty.Capacity() == 0);
-    REQUIRE(empty.Data() == nullptr);
+    REQUIRE(empty.Capacity() == String::InlineCapacity);
+    REQUIRE(empty.CStr()[0] == '\0');
     REQUIRE(copy.Size() == 0);
-    REQUIRE(copy.Capacity() == 0);
-    REQUIRE(copy.Data() == nullptr);
+    REQUIRE(copy.Capacity() == String::InlineCapacity);
+    REQUIRE(copy.CStr()[0] == '\0');
   }
 
   SECTION("Copy non-empty string") {
@@ -74,16 +102,16 @@ TEST_CASE("Operator =") {
     String s;
     s = empty;
     REQUIRE(empty.Size() == 0);
-    REQUIRE(empty.Capacity() == 0);
-    REQUIRE(empty.Data() == nullptr);
+    REQUIRE(empty.Capacity() == String::InlineCapacity);
+    REQUIRE(empty.CStr()[0] == '\0');
     REQUIRE(s.Size() == 0);
-    REQUIRE(s.Capacity() == 0);
-    REQUIRE(s.Data() == nullptr);
+    REQUIRE(s.Capacity() == String::InlineCapacity);
+    REQUIRE(s.CStr()[0] == '\0');
 
     s = s;
     REQUIRE(s.Size() == 0);
-    REQUIRE(s.Capacity() == 0);
-    REQUIRE(s.Data() == nullptr);
+    REQUIRE(s.Capacity() == String::InlineCapacity);
+    REQUIRE(s.CStr()[0] == '\0');
   }
 
   SECTION("Empty to filled") {
@@ -91,8 +119,8 @@ TEST_CASE("Operator =") {
     String s = TEST_STRING;
     s = empty;
     REQUIRE(empty.Size() == 0);
-    REQUIRE(empty.Capacity() == 0);
-    REQUIRE(empty.Data() == nullptr);
+    REQUIRE(empty.Capacity() == String::InlineCapacity);
+    REQUIRE(empty.CStr()[0] == '\0');
     REQUIRE(s.Size() == 0);
   }
 
@@ -198,11 +226,73 @@ TEST_CASE("PushBack") {
   s.PushBack('a');
   REQUIRE(s == "a");
   REQUIRE(s.Size() == 1);
-  REQUIRE(s.Capacity() == 1);
+  REQUIRE(s.Capacity() == String::InlineCapacity);
   s.PushBack('a');
   REQUIRE(s == "aa");
   REQUIRE(s.Size() == 2);
-  REQUIRE(s.Capacity() == 2);
+  REQUIRE(s.Capacity() == String::InlineCapacity);
+
+  while (s.Size() < String::InlineCapacity) s.PushBack('a');
+  REQUIRE(s.Capacity() == String::InlineCapacity);
+  s.PushBack('b');
+  REQUIRE(s.Capacity() == 2 * String::InlineCapacity);
+  RequireEqual(s, std::string(String::InlineCapacity, 'a') + 'b');
+  REQUIRE(s.CStr()[s.Size()] == '\0');
+}
+
+TEST_CASE("Small string optimization") {
+  auto is_inline = [](const String& s) {
+    const char* object = reinterpret_cast<const char*>(&s);
+    return s.Data() >= object && s.Data() < object + sizeof(String);
+  };
+  REQUIRE(sizeof(String) <= 24);
+
+  SECTION("Short strings stay inline") {
+    REQUIRE(is_inline(String()));
+    REQUIRE(is_inline(String('a')));
+    REQUIRE(is_inline(String(TEST_STRING)));
+    REQUIRE(is_inline(String(String::InlineCapacity, 'a')));
+    REQUIRE_FALSE(is_inline(String(String::InlineCapacity + 1, 'a')));
+  }
+
+  SECTION("Growth moves to the heap") {
+    String s = "short";
+    s += String(" and now a rather long tail");
+    REQUIRE_FALSE(is_inline(s));
+    RequireEqual(s, "short and now a rather long tail");
+    REQUIRE(s.CStr()[s.Size()] == '\0');
+
+    String r = "abc";
+    r.Resize(40, 'x');
+    REQUIRE_FALSE(is_inline(r));
+    RequireEqual(r, "abc" + std::string(37, 'x'));
+
+    String q = "abc";
+    q.Reserve(16);
+    REQUIRE_FALSE(is_inline(q));
+    RequireEqual(q, "abc");
+  }
+
+  SECTION("Self-append across the boundary") {
+    String s = "0123456789";
+    s += s;
+    RequireEqual(s, "01234567890123456789");
+  }
+
+  SECTION("Copies and swaps of mixed storage") {
+    String small = "small";
+    String large(100, 'L');
+    String copy = large;
+    small.Swap(large);
+    RequireEqual(small, std::string(100, 'L'));
+    RequireEqual(large, "small");
+    REQUIRE(is_inline(large));
+
+    copy = large;
+    RequireEqual(copy, "small");
+    large = small;
+    RequireEqual(large, std::string(100, 'L'));
+  }
 }
 
 TEST_CASE("Operator +") {
@@ -228,6 +318,106 @@ TEST_CASE("Operator +") {
   }
 }
 
+TEST_CASE("Move semantics") {
+  REQUIRE(std::is_nothrow_move_constructible_v<String>);
+  REQUIRE(std::is_nothrow_move_assignable_v<String>);
+
+  SECTION("Move constructor steals the heap buffer") {
+    String source(100, 'a');
+    const char* buffer = source.Data();
+    String moved = std::move(source);
+    REQUIRE(moved.Data() == buffer);
+    RequireEqual(moved, std::string(100, 'a'));
+    RequireEqual(source, "");
+    REQUIRE(source.CStr()[0] == '\0');
+  }
+
+  SECTION("Move constructor of an inline string") {
+    String source = TEST_STRING;
+    String moved = std::move(source);
+    RequireEqual(moved, TEST_STRING);
+    RequireEqual(source, "");
+  }
+
+  SECTION("Move assignment") {
+    String source(100, 'a');
+    const char* buffer = source.Data();
+    String target = TEST_STRING;
+    target = std::move(source);
+    REQUIRE(target.Data() == buffer);
+    RequireEqual(target, std::string(100, 'a'));
+    RequireEqual(source, "");
+
+    target = std::move(target);
+    RequireEqual(target, std::string(100, 'a'));
+  }
+}
+
+TEST_CASE("Concatenation chains") {
+  const String a(20, 'a');
+  const String b(20, 'b');
+  const String c(20, 'c');
+  const String d = "d";
+  const std::string expected = std::string(20, 'a') + std::string(20, 'b') + std::string(20, 'c') + "d";
+
+  SECTION("Lazy chain") {
+    RequireEqual(a + b + c + d, expected);
+    RequireEqual(a + (b + c) + d, expected);
+    String built = a + b + c + d;
+    REQUIRE(built.Capacity() == expected.size());
+    REQUIRE(built.CStr()[built.Size()] == '\0');
+  }
+
+  SECTION("Temporaries and literals") {
+    RequireEqual(String(a) + b + c + d, expected);
+    RequireEqual(a + b + c + String(d), expected);
+    RequireEqual(a + String(b) + (c + d), expected);
+    RequireEqual(String(a) + String(b) + String(c) + String(d), expected);
+    RequireEqual(a + "x", std::string(20, 'a') + "x");
+    RequireEqual("x" + d, "xd");
+  }
+
+  SECTION("A temporary on the right keeps its buffer and allocator") {
+    String tail(30, 't');
+    tail.Reserve(100);
+    const char* buffer = tail.Data();
+    String joined = a + std::move(tail);
+    RequireEqual(joined, std::string(20, 'a') + std::string(30, 't'));
+    REQUIRE(joined.Data() == buffer);
+    RequireEqual(d + String(b), "d" + std::string(20, 'b'));
+
+    std::pmr::monotonic_buffer_resource arena;
+    const PmrString head(std::string(20, 'h').c_str(), &arena);
+    PmrString pmr_tail(std::string(20, 't').c_str(), &arena);
+    PmrString pmr_joined = head + std::move(pmr_tail);
+    REQUIRE(pmr_joined.GetAllocator().resource() == &arena);
+    REQUIRE(StringView(pmr_joined) == StringView((std::string(20, 'h') + std::string(20, 't')).c_str()));
+    PmrString chained = head + head + PmrString("t", &arena);
+    REQUIRE(chained.GetAllocator().resource() == &arena);
+    REQUIRE(chained.Size() == 41);
+  }
+
+  SECTION("Aliasing") {
+    String s = "ab";
+    s += s + d + s;
+    RequireEqual(s, "ababdab");
+    s = s + s;
+    RequireEqual(s, "ababdabababdab");
+    String t = "xy";
+    t = t + std::move(t);
+    RequireEqual(t, "xyxy");
+    t.Reserve(20);
+    t = t + std::move(t);
+    RequireEqual(t, "xyxyxyxy");
+    t = d + t + std::move(t);
+    RequireEqual(t, "dxyxyxyxyxyxyxyxy");
+  }
+
+  SECTION("Comparison with a chain") {
+    REQUIRE(d + d == String("dd"));
+  }
+}
+
 TEST_CASE("Clear") {
   String s;
   s.Clear();
@@ -263,7 +453,7 @@ TEST_CASE("Change size/capacity") {
 
     str = "aba";
     RequireEqual(str, "aba");
-    REQUIRE(str.Capacity() == 3);
+    REQUIRE(str.Capacity() == String::InlineCapacity);
   }
 
   SECTION("Reserve") {
@@ -273,7 +463,7 @@ TEST_CASE("Change size/capacity") {
     https://en.cppreference.com/w/cpp/string/basic_string/capacity
     */
     String str = TEST_STRING;
-    REQUIRE(str.Capacity() == 11);
+    REQUIRE(str.Capacity() == String::InlineCapacity);
 
     str.Reserve(20);
     REQUIRE(str.Capacity() == 20);
@@ -297,15 +487,21 @@ TEST_CASE("Change size/capacity") {
     str.Reserve(100);
     REQUIRE(str.Capacity() > str.Size());
     str.ShrinkToFit();
-    REQUIRE(str.Capacity() == str.Size());
+    REQUIRE(str.Capacity() == String::InlineCapacity);
     RequireEqual(str, TEST_STRING);
 
-    str.Resize(0, 'a');
-    RequireEqual(str, "");
-    REQUIRE(str.Capacity() > 0);
-    str.ShrinkToFit();
-    REQUIRE(str.Size() == 0);
-    REQUIRE(str.Capacity() == 0);
+    String large(100, 'a');
+    large.Reserve(200);
+    large.ShrinkToFit();
+    REQUIRE(large.Capacity() == large.Size());
+    RequireEqual(large, std::string(100, 'a'));
+
+    large.Resize(0, 'a');
+    RequireEqual(large, "");
+    REQUIRE(large.Capacity() > String::InlineCapacity);
+    large.ShrinkToFit();
+    REQUIRE(large.Size() == 0);
+    REQUIRE(large.Capacity() == String::InlineCapacity);
   }
 }
 
@@ -317,8 +513,9 @@ TEST_CASE("Comparisons", "[String]") {
 
     const String lhs = std::get<0>(test_data);
     const String rhs = std::get<1>(test_data);
-    // REQUIRE((lhs <=> rhs) < 0);
-    // REQUIRE((rhs <=> lhs) > 0);
+    REQUIRE((lhs <=> rhs) < 0);
+    REQUIRE((rhs <=> lhs) > 0);
+    REQUIRE_FALSE(lhs == rhs);
     /*The same as:
       REQUIRE_FALSE(lhs == rhs);
       REQUIRE(lhs <= rhs);
@@ -336,7 +533,8 @@ TEST_CASE("Comparisons", "[String]") {
 
     const String lhs = std::get<0>(test_data);
     const String rhs = std::get<1>(test_data);
-    // REQUIRE((lhs <=> rhs) == 0);
+    REQUIRE((lhs <=> rhs) == 0);
+    REQUIRE(lhs == rhs);
     /*The same as:
       REQUIRE(lhs == rhs);
       REQUIRE(lhs <= rhs);
@@ -348,8 +546,1560 @@ TEST_CASE("Comparisons", "[String]") {
   }
 }
 
+TEST_CASE("Comparisons with views and literals", "[String]") {
+  const char* literal = "a literal longer than the inline capacity";
+  const PmrString same(literal);
+  const PmrString greater("b literal");
+  // A PmrString made from the literal would allocate from the default resource and throw.
+  std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+  bool equal = same == literal && literal == same && same == StringView(literal) && StringView(literal) == same;
+  bool ordered = greater > literal && literal < greater && (same <=> literal) == 0 &&
+                 (greater <=> StringView(literal)) > 0 && StringView(literal) < greater && greater != literal;
+  std::pmr::set_default_resource(previous);
+  REQUIRE(equal);
+  REQUIRE(ordered);
+
+  const String str = "abc";
+  REQUIRE(str == "abc");
+  REQUIRE(str != "abd");
+  REQUIRE(str < "abd");
+  REQUIRE("abb" < str);
+  REQUIRE(str == StringView("abc"));
+  REQUIRE(str == String("abc"));
+  REQUIRE((str <=> StringView("ab")) > 0);
+}
+
+TEST_CASE("Comparisons of long and binary strings", "[String]") {
+  SECTION("Embedded NUL") {
+    const String lhs("ab\0cd", 5);
+    const String rhs("ab\0ce", 5);
+    REQUIRE_FALSE(lhs == rhs);
+    REQUIRE((lhs <=> rhs) < 0);
+    REQUIRE(lhs == String("ab\0cd", 5));
+  }
+
+  SECTION("Bytes compare as unsigned") {
+    const String lhs = "a";
+    const String rhs = "\xff";
+    REQUIRE((lhs <=> rhs) < 0);
+  }
+
+  SECTION("Mismatch at every position of every length") {
+    for (std::size_t size = 1; size <= 100; ++size) {
+      const String base(size, 'm');
+      REQUIRE(base == String(size, 'm'));
+      REQUIRE((base <=> String(size, 'm')) == 0);
+      for (std::size_t i = 0; i < size; ++i) {
+        String other = base;
+        other[i] = 'n';
+        REQUIRE_FALSE(base == other);
+        REQUIRE((base <=> other) < 0);
+        REQUIRE((other <=> base) > 0);
+      }
+    }
+  }
+
+  SECTION("Prefix orders first") {
+    const String prefix(40, 'p');
+    const String longer(41, 'p');
+    REQUIRE((prefix <=> longer) < 0);
+    REQUIRE((longer <=> prefix) > 0);
+  }
+}
+
+TEST_CASE("Search", "[String]") {
+  const String s = "hello world, hello string";
+
+  SECTION("Find") {
+    REQUIRE(s.Find("hello") == 0);
+    REQUIRE(s.Find("hello", 1) == 13);
+    REQUIRE(s.Find("missing") == String::NPos);
+    REQUIRE(s.Find('o') == 4);
+    REQUIRE(s.Find('o', 5) == 7);
+    REQUIRE(s.Find("") == 0);
+    REQUIRE(s.Find("", s.Size()) == s.Size());
+    REQUIRE(s.Find("x", s.Size() + 1) == String::NPos);
+  }
+
+  SECTION("RFind") {
+    REQUIRE(s.RFind("hello") == 13);
+    REQUIRE(s.RFind("hello", 12) == 0);
+    REQUIRE(s.RFind('o') == 17);
+    REQUIRE(s.RFind('o', 16) == 7);
+    REQUIRE(s.RFind("missing") == String::NPos);
+    REQUIRE(s.RFind("") == s.Size());
+    REQUIRE(String().RFind('a') == String::NPos);
+  }
+
+  SECTION("FindFirstOf") {
+    REQUIRE(s.FindFirstOf(",w") == 6);
+    REQUIRE(s.FindFirstOf(",w", 7) == 11);
+    REQUIRE(s.FindFirstOf("xyz") == String::NPos);
+    REQUIRE(s.FindFirstOf("") == String::NPos);
+  }
+
+  SECTION("Contains, StartsWith, EndsWith") {
+    REQUIRE(s.Contains("world"));
+    REQUIRE(s.Contains(','));
+    REQUIRE_FALSE(s.Contains("World"));
+    REQUIRE(s.StartsWith("hello"));
+    REQUIRE(s.StartsWith(""));
+    REQUIRE_FALSE(s.StartsWith("world"));
+    REQUIRE(s.EndsWith("string"));
+    REQUIRE_FALSE(s.EndsWith("hello"));
+    REQUIRE_FALSE(String("ab").EndsWith("abc"));
+  }
+
+  SECTION("Embedded NUL") {
+    const String binary("a\0b\0c", 5);
+    REQUIRE(binary.Find(String("\0c", 2)) == 3);
+    REQUIRE(binary.RFind('\0') == 3);
+  }
+}
+
+TEST_CASE("Search agrees with std::string", "[String]") {
+  std::mt19937 rng(7);
+  auto random_text = [&](std::size_t size, char last_letter) {
+    std::string text(size, 'a');
+    for (auto& symbol : text) symbol = static_cast<char>('a' + rng() % (last_letter - 'a' + 1));
+    return text;
+  };
+
+  for (int round = 0; round < 300; ++round) {
+    // A two-letter alphabet makes partial and periodic matches common; long needles take the Two-Way path.
+    const std::string haystack = random_text(rng() % 600, 'b');
+    const std::size_t needle_size = 1 + rng() % (round % 3 == 0 ? 150 : 12);
+    std::string needle = random_text(needle_size, 'b');
+    if (round % 5 == 0 && haystack.size() >= needle_size) {
+      needle = haystack.substr(rng() % (haystack.size() - needle_size + 1), needle_size);
+    }
+    const String str(haystack.data(), haystack.size());
+    const String pattern(needle.data(), needle.size());
+    const std::size_t pos = rng() % (haystack.size() + 2);
+
+    REQUIRE(str.Find(pattern) == haystack.find(needle));
+    REQUIRE(str.Find(pattern, pos) == haystack.find(needle, pos));
+    REQUIRE(str.RFind(pattern) == haystack.rfind(needle));
+    REQUIRE(str.RFind(pattern, pos) == haystack.rfind(needle, pos));
+    REQUIRE(str.Find(needle[0], pos) == haystack.find(needle[0], pos));
+    REQUIRE(str.RFind(needle[0], pos) == haystack.rfind(needle[0], pos));
+  }
+
+  for (int round = 0; round < 100; ++round) {
+    const std::string haystack = random_text(rng() % 300, 'z');
+    const std::string symbols = random_text(1 + rng() % 24, 'z');
+    const String str(haystack.data(), haystack.size());
+    const std::size_t pos = rng() % (haystack.size() + 2);
+    REQUIRE(str.FindFirstOf(String(symbols.data(), symbols.size()), pos) == haystack.find_first_of(symbols, pos));
+  }
+}
+
+TEST_CASE("PatternMatcher", "[PatternMatcher]") {
+  SECTION("Overlapping patterns") {
+    const PatternMatcher matcher(Vector<String>{"he", "she", "his", "hers"});
+    const Vector<PatternMatcher::Match> matches = matcher.FindAll("ushers");
+    REQUIRE(matches.Size() == 3);
+    REQUIRE(matches[0].Pattern == 1);
+    REQUIRE(matches[0].Position == 1);
+    REQUIRE(matches[1].Pattern == 0);
+    REQUIRE(matches[1].Position == 2);
+    REQUIRE(matches[2].Pattern == 3);
+    REQUIRE(matches[2].Position == 2);
+    REQUIRE(matcher.ContainsAny("ushers"));
+    REQUIRE_FALSE(matcher.ContainsAny("xyz"));
+  }
+
+  SECTION("Empty inputs") {
+    const PatternMatcher none(Vector<String>{});
+    REQUIRE(none.FindAll("anything").Empty());
+    const PatternMatcher empty_pattern(Vector<String>{"", "a"});
+    REQUIRE(empty_pattern.FindAll("aa").Size() == 2);
+    REQUIRE(empty_pattern.FindAll("").Empty());
+  }
+
+  SECTION("Agrees with repeated Find") {
+    std::mt19937 rng(11);
+    auto random_text = [&](std::size_t size) {
+      std::string text(size, 'a');
+      for (auto& symbol : text) symbol = static_cast<char>('a' + rng() % 3);
+      return text;
+    };
+    for (int round = 0; round < 50; ++round) {
+      Vector<String> patterns;
+      std::vector<std::string> std_patterns;
+      for (int p = 0; p < 1 + round % 10; ++p) {
+        std_patterns.push_back(random_text(1 + rng() % 5));
+        patterns.PushBack(String(std_patterns.back().data(), std_patterns.back().size()));
+      }
+      const std::string text = random_text(rng() % 200);
+      const PatternMatcher matcher(patterns);
+
+      std::size_t expected = 0;
+      for (const auto& pattern : std_patterns)
+        for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) ++expected;
+
+      std::size_t found = 0;
+      matcher.Scan(String(text.data(), text.size()), [&](const PatternMatcher::Match& match) {
+        REQUIRE(text.compare(match.Position, std_patterns[match.Pattern].size(), std_patterns[match.Pattern]) == 0);
+        ++found;
+      });
+      REQUIRE(found == expected);
+      REQUIRE(matcher.ContainsAny(String(text.data(), text.size())) == (expected != 0));
+    }
+  }
+}
+
+TEST_CASE("StringView", "[StringView]") {
+  const String str(TEST_STRING);
+  const StringView view = str;
+  REQUIRE(view.Data() == str.Data());
+  REQUIRE(view.Size() == str.Size());
+  REQUIRE(view == StringView(TEST_STRING));
+  REQUIRE(StringView().Empty());
+
+  REQUIRE(view.Substr(5) == "string");
+  REQUIRE(view.Substr(0, 4) == "test");
+  REQUIRE(view.Substr(5, 100) == "string");
+  REQUIRE(view.Substr(11).Empty());
+  REQUIRE_THROWS_AS(view.Substr(12), std::out_of_range);
+
+  StringView trimmed = view;
+  trimmed.RemovePrefix(1);
+  trimmed.RemoveSuffix(1);
+  REQUIRE(trimmed == "est strin");
+  REQUIRE(trimmed.Find("str") == 4);
+  REQUIRE(trimmed.RFind('t') == 5);
+  REQUIRE(trimmed.FindFirstOf(" n") == 3);
+  REQUIRE(trimmed.StartsWith("est"));
+  REQUIRE(trimmed.EndsWith("rin"));
+  REQUIRE_FALSE(trimmed.Contains("string"));
+
+  REQUIRE((StringView("abc") <=> StringView("abd")) < 0);
+  REQUIRE((StringView("abc") <=> StringView("ab")) > 0);
+  REQUIRE(StringView("ab\0c", 4) != StringView("ab"));
+
+  RequireEqual(String(view.Substr(0, 4)), "test");
+  RequireEqual(String(StringView()), "");
+}
+
+TEST_CASE("Append", "[String]") {
+  String str("abc");
+  str.Append(StringView("def"));
+  RequireEqual(str, "abcdef");
+  str.Append(StringView());
+  RequireEqual(str, "abcdef");
+
+  // The view may point into the string itself, also when appending reallocates.
+  str.Append(str);
+  RequireEqual(str, "abcdefabcdef");
+  str.Append(StringView(str).Substr(3, 6));
+  RequireEqual(str, "abcdefabcdefdefabc");
+  str.ShrinkToFit();
+  str.Append(str);
+  RequireEqual(str, "abcdefabcdefdefabcabcdefabcdefdefabc");
+}
+
+TEST_CASE("Split", "[Split]") {
+  auto fields = [](const SplitRange& range) {
+    std::vector<std::string> result;
+    for (StringView field : range) result.emplace_back(field.Data(), field.Size());
+    return result;
+  };
+  using Fields = std::vector<std::string>;
+
+  REQUIRE(fields(Split("a,b,,c", ',')) == Fields{"a", "b", "", "c"});
+  REQUIRE(fields(Split(",a,", ',')) == Fields{"", "a", ""});
+  REQUIRE(fields(Split("", ',')) == Fields{""});
+  REQUIRE(fields(Split("abc", ',')) == Fields{"abc"});
+  REQUIRE(fields(Split("a::b:c::", "::")) == Fields{"a", "b:c", ""});
+  REQUIRE(fields(Split("abc", "")) == Fields{"abc"});
+  REQUIRE(fields(Split(StringView("a\0b", 3), '\0')) == Fields{"a", "b"});
+
+  REQUIRE(fields(Tokenize("  a b\t\tcd \n", " \t\n")) == Fields{"a", "b", "cd"});
+  REQUIRE(fields(Tokenize(" \t ", " \t")).empty());
+  REQUIRE(fields(Tokenize("", " ")).empty());
+  REQUIRE(fields(Tokenize("abc", "")) == Fields{"abc"});
+
+  // Fields point into the text, nothing is copied.
+  const String line("key=value");
+  Vector<StringView> parts = Split(line, '=').ToVector();
+  REQUIRE(parts.Size() == 2);
+  REQUIRE(parts[0].Data() == line.Data());
+  REQUIRE(parts[1].Data() == line.Data() + 4);
+}
+
+TEST_CASE("Join", "[Split]") {
+  Vector<String> parts;
+  RequireEqual(Join(parts, ", "), "");
+  parts.PushBack(String("one"));
+  RequireEqual(Join(parts, ", "), "one");
+  parts.PushBack(String());
+  parts.PushBack(String("a rather long third part"));
+  const String joined = Join(parts, ", ");
+  RequireEqual(joined, "one, , a rather long third part");
+  // The size is computed up front, so the buffer is allocated once and exactly.
+  REQUIRE(joined.Capacity() == joined.Size());
+
+  const String csv("x,yy,,zzz");
+  RequireEqual(Join(Split(csv, ',').ToVector(), ";"), "x;yy;;zzz");
+  RequireEqual(Join(Split(csv, ',').ToVector(), ""), "xyyzzz");
+}
+
+TEST_CASE("StringPool", "[StringPool]") {
+  StringPool pool;
+  REQUIRE(pool.Size() == 0);
+  REQUIRE(pool.Find("host").Empty());
+  REQUIRE_FALSE(pool.Contains("host"));
+
+  const String host("backend-01.example.com");
+  InternedString a = pool.Intern(host);
+  InternedString b = pool.Intern(StringView("backend-01.example.com"));
+  InternedString c = pool.Intern("backend-02.example.com");
+  REQUIRE(pool.Size() == 2);
+  REQUIRE(sizeof(InternedString) == sizeof(void *));
+  REQUIRE(a == b);
+  REQUIRE(a.Data() == b.Data());
+  REQUIRE(a != c);
+  REQUIRE(a.Hash() == b.Hash());
+  REQUIRE(a.Hash() == host.Hash());
+  REQUIRE(StringView(a) == StringView(host));
+  REQUIRE(a.Data() != host.Data());
+  REQUIRE(a.CStr()[a.Size()] == '\0');
+  REQUIRE(pool.Find(host) == a);
+  REQUIRE(pool.Contains(host));
+
+  // The empty string is the default handle whatever pool it comes from.
+  InternedString empty;
+  REQUIRE(empty.Empty());
+  REQUIRE(empty.Size() == 0);
+  REQUIRE(std::strcmp(empty.CStr(), "") == 0);
+  REQUIRE(pool.Intern("") == empty);
+  REQUIRE(empty.Hash() == String().Hash());
+  REQUIRE(pool.Contains(""));
+  REQUIRE(pool.Size() == 2);
+
+  // Embedded zeros and strings larger than an arena block.
+  const std::string binary("a\0b", 3);
+  InternedString zero = pool.Intern(StringView(binary.data(), binary.size()));
+  REQUIRE(zero != pool.Intern("a"));
+  REQUIRE(zero.Size() == 3);
+  const std::string huge(200000, 'x');
+  InternedString big = pool.Intern(StringView(huge.data(), huge.size()));
+  REQUIRE(big == pool.Intern(StringView(huge.data(), huge.size())));
+  REQUIRE(std::string(big.Data(), big.Size()) == huge);
+
+  // Many distinct strings: handles stay valid while the table grows.
+  std::vector<std::string> names;
+  std::vector<InternedString> handles;
+  for (int i = 0; i < 20000; ++i) {
+    names.push_back("metric." + std::to_string(i));
+    handles.push_back(pool.Intern(StringView(names.back().data(), names.back().size())));
+  }
+  REQUIRE(pool.Size() == 20000 + 5);
+  for (int i = 0; i < 20000; ++i) {
+    REQUIRE(std::string(handles[i].Data(), handles[i].Size()) == names[i]);
+    REQUIRE(pool.Intern(StringView(names[i].data(), names[i].size())) == handles[i]);
+  }
+  REQUIRE(pool.MemoryUsage() > 20000 * 16);
+
+  std::unordered_map<InternedString, int> counts;
+  ++counts[a];
+  ++counts[b];
+  ++counts[c];
+  REQUIRE(counts.size() == 2);
+  REQUIRE(counts[a] == 2);
+}
+
+TEST_CASE("Hash", "[Hash]") {
+  const String str(TEST_STRING);
+  REQUIRE(str.Hash() == HashBytes(TEST_STRING, std::strlen(TEST_STRING)));
+  REQUIRE(str.Hash() == StringView(str).Hash());
+  REQUIRE(str.Hash() == String(str).Hash());
+  REQUIRE(std::hash<String>()(str) == str.Hash());
+  REQUIRE(std::hash<StringView>()(str) == str.Hash());
+  REQUIRE(str.Hash(1) != str.Hash());
+  static_assert(HashEmpty() != HashEmpty(1));
+  REQUIRE(HashEmpty() == HashBytes("", 0));
+  REQUIRE(HashEmpty(7) == HashBytes("", 0, 7));
+  REQUIRE(str.Hash(1) == HashBytes(str.Data(), str.Size(), 1));
+  REQUIRE(String().Hash() == HashBytes(nullptr, 0));
+  REQUIRE(String().Hash() != String("\0", 1).Hash());
+
+  // Every length takes its own path through the short, medium and bulk loops: prefixes of one
+  // buffer, and every single-bit change of it, have to hash differently.
+  std::mt19937_64 rng(7);
+  std::string buffer(300, ' ');
+  for (auto& symbol : buffer) symbol = static_cast<char>(rng());
+  std::unordered_set<uint64_t> hashes;
+  for (std::size_t size = 0; size <= buffer.size(); ++size) {
+    const uint64_t hash = HashBytes(buffer.data(), size);
+    REQUIRE(hashes.insert(hash).second);
+    for (std::size_t i = 0; i < size; i += 1 + size / 16) {
+      std::string changed = buffer.substr(0, size);
+      changed[i] ^= static_cast<char>(1 << (i % 8));
+      REQUIRE(HashBytes(changed.data(), size) != hash);
+    }
+  }
+  // Only the bytes in range are read.
+  REQUIRE(HashBytes(buffer.data() + 1, 40) == HashBytes(buffer.substr(1, 40).data(), 40));
+
+  std::unordered_map<String, int> counts;
+  for (const char* word : {"alpha", "beta", "alpha", "a rather long key that is stored on the heap", "alpha"})
+    ++counts[String(word)];
+  REQUIRE(counts.size() == 3);
+  REQUIRE(counts[String("alpha")] == 3);
+}
+
+TEST_CASE("Append grows geometrically", "[String]") {
+  String str;
+  std::size_t reallocations = 0;
+  const char* data = str.Data();
+  for (int i = 0; i < 100000; ++i) {
+    str += String("0123456789", 1 + i % 10);
+    if (str.Data() != data) ++reallocations, data = str.Data();
+  }
+  REQUIRE(str.Size() == 550000);
+  REQUIRE(reallocations < 20);
+}
+
+TEST_CASE("StringBuilder", "[StringBuilder]") {
+  StringBuilder builder;
+  REQUIRE(builder.Empty());
+  builder.Append(StringView());
+  REQUIRE(builder.Chunks().Empty());
+  RequireEqual(builder.ToString(), "");
+
+  std::string expected;
+  std::mt19937_64 rng(3);
+  for (int i = 0; i < 5000; ++i) {
+    if (i % 7 == 0) {
+      builder += static_cast<char>('a' + i % 26);
+      expected += static_cast<char>('a' + i % 26);
+      continue;
+    }
+    // Mostly small pieces with an occasional one larger than a whole chunk.
+    std::string piece(i % 1000 == 999 ? 100000 : rng() % 40, static_cast<char>('A' + i % 26));
+    builder.Append(StringView(piece.data(), piece.size()));
+    expected += piece;
+  }
+  REQUIRE(builder.Size() == expected.size());
+
+  Vector<StringView> chunks = builder.Chunks();
+  REQUIRE(chunks.Size() < 20);
+  std::string joined;
+  for (std::size_t i = 0; i < chunks.Size(); ++i) {
+    REQUIRE_FALSE(chunks[i].Empty());
+    joined.append(chunks[i].Data(), chunks[i].Size());
+  }
+  REQUIRE(joined == expected);
+
+  const String str = builder.ToString();
+  RequireEqual(str, expected);
+  REQUIRE(str.Capacity() == str.Size());
+
+  std::string copied(builder.Size(), ' ');
+  REQUIRE(builder.CopyTo(copied.data()) == copied.data() + copied.size());
+  REQUIRE(copied == expected);
+
+  auto oss = std::ostringstream();
+  oss << builder;
+  REQUIRE(oss.str() == expected);
+
+  builder.Clear();
+  REQUIRE(builder.Empty());
+  REQUIRE(builder.Chunks().Empty());
+  builder.Append("abc").Append('d');
+  RequireEqual(builder.ToString(), "abcd");
+  REQUIRE(builder.Chunks().Size() == 1);
+
+  StringBuilder moved = std::move(builder);
+  RequireEqual(moved.ToString(), "abcd");
+}
+
 TEST_CASE("Output", "[String]") {
   auto oss = std::ostringstream();
   oss << String(TEST_STRING) << ' ' << String() << ' ' << String(TEST_STRING, 4);
   REQUIRE(oss.str() == "test string  test");
+
+  oss.str("");
+  oss << String("a\0b", 3);
+  REQUIRE(oss.str() == std::string("a\0b", 3));
+}
+
+// Forwards to the default resource and keeps count of what went through it.
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t Allocations = 0;
+  std::size_t Deallocations = 0;
+  std::size_t BytesInUse = 0;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++Allocations;
+    BytesInUse += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+    ++Deallocations;
+    BytesInUse -= bytes;
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+TEST_CASE("PmrString", "[String]") {
+  REQUIRE(std::is_nothrow_move_assignable_v<String>);
+
+  CountingResource resource;
+  {
+    PmrString str(&resource);
+    REQUIRE(str.GetAllocator().resource() == &resource);
+    str.PushBack('a');
+    REQUIRE(resource.Allocations == 0);
+
+    // Every way of growing goes through the resource.
+    for (int i = 0; i < 100; ++i) str.PushBack('b');
+    const std::size_t after_push = resource.Allocations;
+    REQUIRE(after_push > 0);
+    str.Reserve(1000);
+    REQUIRE(resource.Allocations == after_push + 1);
+    str.Resize(5000, 'c');
+    REQUIRE(resource.Allocations == after_push + 2);
+    str += PmrString(std::string(10000, 'd').c_str(), &resource);
+    str.Append(StringView("tail"));
+    str += PmrString("x", &resource) + PmrString("y", &resource);
+    str.ShrinkToFit();
+    REQUIRE(str.Capacity() == str.Size());
+    str.Resize(3, ' ');
+    str.ShrinkToFit();
+    REQUIRE(str.Capacity() == PmrString::InlineCapacity);
+    REQUIRE(resource.BytesInUse == 0);
+    REQUIRE(str == PmrString("abb"));
+    REQUIRE(resource.Allocations == resource.Deallocations);
+
+    PmrString long_str(std::string(100, 'l').c_str(), &resource);
+    REQUIRE(resource.BytesInUse == 101);
+
+    // A copy does not inherit the resource; a copy with an allocator uses the given one.
+    PmrString copy = long_str;
+    REQUIRE(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+    PmrString copy_here(long_str, &resource);
+    REQUIRE(resource.BytesInUse == 202);
+
+    // Moving between equal resources hands the buffer over, between different ones it copies.
+    const char* data = long_str.Data();
+    PmrString moved(std::move(long_str));
+    REQUIRE(moved.Data() == data);
+    REQUIRE(moved.GetAllocator().resource() == &resource);
+    PmrString other(&resource);
+    other = std::move(moved);
+    REQUIRE(other.Data() == data);
+    copy = std::move(other);
+    REQUIRE(copy.Data() != data);
+    REQUIRE(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(copy == PmrString(std::string(100, 'l').c_str()));
+    PmrString elsewhere(std::move(copy), &resource);
+    REQUIRE(elsewhere.GetAllocator().resource() == &resource);
+    REQUIRE(elsewhere.Size() == 100);
+
+    std::istringstream in("word " + std::string(50, 'w') + "\nline\n");
+    PmrString word(&resource);
+    in >> word;
+    REQUIRE(word == PmrString("word"));
+    GetLine(in, word);
+    REQUIRE(word.Size() == 51);
+    PmrString rest = ReadAll(in, std::pmr::polymorphic_allocator<char>(&resource));
+    REQUIRE(rest == PmrString("line\n"));
+  }
+  REQUIRE(resource.BytesInUse == 0);
+  REQUIRE(resource.Allocations == resource.Deallocations);
+
+  // Per-request strings on a monotonic arena: nothing is freed until the arena goes.
+  const std::size_t allocations = resource.Allocations;
+  char arena_buffer[4096];
+  std::pmr::monotonic_buffer_resource arena(arena_buffer, sizeof(arena_buffer), &resource);
+  PmrString request_line("GET /api/v1/items?id=42 HTTP/1.1", &arena);
+  REQUIRE(request_line.Data() >= arena_buffer);
+  REQUIRE(request_line.Data() < arena_buffer + sizeof(arena_buffer));
+  REQUIRE(resource.Allocations == allocations);
+}
+
+// Non-seekable input that hands out at most Chunk characters per refill, so that tokens and
+// lines straddle buffer boundaries.
+class ChunkedBuffer : public std::streambuf {
+public:
+  ChunkedBuffer(std::string text, std::size_t chunk) : Text_(std::move(text)), Chunk_(chunk) {}
+
+protected:
+  int_type underflow() override {
+    if (Position_ == Text_.size()) return traits_type::eof();
+    char* begin = Text_.data() + Position_;
+    Position_ = std::min(Text_.size(), Position_ + Chunk_);
+    setg(begin, begin, Text_.data() + Position_);
+    return traits_type::to_int_type(*begin);
+  }
+
+private:
+  std::string Text_;
+  std::size_t Chunk_;
+  std::size_t Position_ = 0;
+};
+
+// Input without a get area: every character goes through underflow() and uflow(), as with
+// std::cin synced with stdio.
+class UnbufferedBuffer : public std::streambuf {
+public:
+  explicit UnbufferedBuffer(std::string text) : Text_(std::move(text)) {}
+
+protected:
+  int_type underflow() override {
+    return Position_ == Text_.size() ? traits_type::eof() : traits_type::to_int_type(Text_[Position_]);
+  }
+  int_type uflow() override {
+    return Position_ == Text_.size() ? traits_type::eof() : traits_type::to_int_type(Text_[Position_++]);
+  }
+
+private:
+  std::string Text_;
+  std::size_t Position_ = 0;
+};
+
+TEST_CASE("Input", "[String]") {
+  const std::string long_word(100, 'w');
+  const std::string text = "  hello\tworld\n\n" + long_word + "  x ";
+  for (std::size_t chunk : {std::size_t(1), std::size_t(3), std::size_t(1000)}) {
+    ChunkedBuffer buffer(text, chunk);
+    std::istream in(&buffer);
+    String word("previous contents");
+    REQUIRE(in >> word);
+    RequireEqual(word, "hello");
+    REQUIRE(in >> word);
+    RequireEqual(word, "world");
+    REQUIRE(in >> word);
+    RequireEqual(word, long_word);
+    REQUIRE(in >> word);
+    RequireEqual(word, "x");
+    REQUIRE_FALSE(in >> word);
+    REQUIRE(in.eof());
+  }
+
+  std::istringstream in("abcdef ghi");
+  String word;
+  in.width(4);
+  in >> word;
+  RequireEqual(word, "abcd");
+  REQUIRE(in.width() == 0);
+  in >> word;
+  RequireEqual(word, "ef");
+  in >> word;
+  RequireEqual(word, "ghi");
+  REQUIRE(in.eof());
+  REQUIRE_FALSE(in.fail());
+
+  std::istringstream spaces("   ");
+  spaces.width(2);
+  REQUIRE_FALSE(spaces >> word);
+  // Like std::string, a failed read resets width() as well.
+  REQUIRE(spaces.width() == 0);
+
+  UnbufferedBuffer unbuffered(text);
+  std::istream slow(&unbuffered);
+  std::vector<std::string> read;
+  while (slow >> word) read.emplace_back(word.Data(), word.Size());
+  REQUIRE(read == std::vector<std::string>{"hello", "world", long_word, "x"});
+  REQUIRE(slow.eof());
+
+  UnbufferedBuffer limited("abcdef");
+  std::istream narrow(&limited);
+  narrow.width(4);
+  narrow >> word;
+  RequireEqual(word, "abcd");
+}
+
+TEST_CASE("GetLine", "[String]") {
+  const std::string long_line(300, 'l');
+  const std::string text = "first line\n\n" + long_line + "\nlast";
+  for (std::size_t chunk : {std::size_t(1), std::size_t(7), std::size_t(1000)}) {
+    ChunkedBuffer buffer(text, chunk);
+    std::istream in(&buffer);
+    String line;
+    REQUIRE(GetLine(in, line));
+    RequireEqual(line, "first line");
+    REQUIRE(GetLine(in, line));
+    RequireEqual(line, "");
+    REQUIRE(GetLine(in, line));
+    RequireEqual(line, long_line);
+    REQUIRE(GetLine(in, line));
+    RequireEqual(line, "last");
+    REQUIRE(in.eof());
+    REQUIRE_FALSE(GetLine(in, line));
+  }
+
+  std::istringstream fields("a;b;;c");
+  String field;
+  std::vector<std::string> read;
+  while (GetLine(fields, field, ';')) read.emplace_back(field.Data(), field.Size());
+  REQUIRE(read == std::vector<std::string>{"a", "b", "", "c"});
+
+  // A trailing delimiter ends the last line, no empty line follows it.
+  std::istringstream lines("x\n");
+  REQUIRE(GetLine(lines, field));
+  REQUIRE_FALSE(GetLine(lines, field));
+
+  // Lines that exactly fill the free capacity of the string, with and without a delimiter.
+  const std::string full(String::InlineCapacity, 'f');
+  std::istringstream exact(full + "\n" + full);
+  String fresh;
+  REQUIRE(GetLine(exact, fresh));
+  RequireEqual(fresh, full);
+  String other;
+  REQUIRE(GetLine(exact, other));
+  RequireEqual(other, full);
+  REQUIRE(exact.eof());
+  REQUIRE_FALSE(GetLine(exact, other));
+
+  UnbufferedBuffer unbuffered(text);
+  std::istream slow(&unbuffered);
+  REQUIRE(GetLine(slow, field));
+  RequireEqual(field, "first line");
+  REQUIRE(GetLine(slow, field));
+  RequireEqual(field, "");
+  REQUIRE(GetLine(slow, field));
+  RequireEqual(field, long_line);
+  REQUIRE(GetLine(slow, field));
+  RequireEqual(field, "last");
+  REQUIRE(slow.eof());
+  REQUIRE_FALSE(GetLine(slow, field));
+}
+
+TEST_CASE("ReadAll", "[String]") {
+  std::string text;
+  for (int i = 0; i < 10000; ++i) text += std::to_string(i) + (i % 10 == 0 ? "\n" : " ");
+
+  std::istringstream seekable(text);
+  std::string head;
+  seekable >> head;
+  String rest = ReadAll(seekable);
+  RequireEqual(rest, text.substr(head.size()));
+  // The remaining length was known up front, so the buffer was allocated once and exactly.
+  REQUIRE(rest.Capacity() == rest.Size());
+  REQUIRE(seekable.eof());
+
+  ChunkedBuffer buffer(text, 100);
+  std::istream in(&buffer);
+  RequireEqual(ReadAll(in), text);
+
+  std::istringstream empty("");
+  RequireEqual(ReadAll(empty), "");
+}
+
+// A file with the given contents in the temporary directory, removed at the end of the test.
+class TemporaryFile {
+public:
+  TemporaryFile(const std::string& name, const std::string& contents)
+      : Path_((std::filesystem::temp_directory_path() / name).string()) {
+    std::ofstream(Path_, std::ios::binary) << contents;
+  }
+  ~TemporaryFile() { std::filesystem::remove(Path_); }
+  const char* Path() const { return Path_.c_str(); }
+
+private:
+  std::string Path_;
+};
+
+TEST_CASE("MappedFile", "[MappedFile]") {
+  std::string text;
+  for (int i = 0; i < 100000; ++i) text += "word" + std::to_string(i) + '\n';
+  const TemporaryFile file("test_str_mapped.txt", text);
+
+  MappedFile mapped(file.Path());
+  REQUIRE(mapped.Size() == text.size());
+  REQUIRE(std::string(mapped.begin(), mapped.end()) == text);
+  const StringView view = mapped;
+  REQUIRE(view.Find("word99999\n") == text.find("word99999\n"));
+  REQUIRE(Split(mapped, '\n').ToVector().Size() == 100001);
+  mapped.Advise(MappedFile::Advice::WillNeed, 5000, 100000);
+  mapped.Advise(MappedFile::Advice::Random, text.size() - 1, 100);
+  mapped.Advise(MappedFile::Advice::Normal, text.size() + 1);
+
+  MappedFile moved = std::move(mapped);
+  REQUIRE(mapped.Empty());
+  REQUIRE(moved.Size() == text.size());
+  MappedFile assigned;
+  assigned = std::move(moved);
+  REQUIRE(StringView(assigned) == StringView(text.data(), text.size()));
+
+  const TemporaryFile empty("test_str_mapped_empty.txt", "");
+  REQUIRE(MappedFile(empty.Path()).Empty());
+  REQUIRE_THROWS_AS(MappedFile("/nonexistent/test_str_file"), std::system_error);
+  REQUIRE_THROWS_AS(MappedFile(std::filesystem::temp_directory_path().c_str()), std::system_error);
+}
+
+TEST_CASE("String::FromFile", "[String]") {
+  const std::string text = "first line\n" + std::string(100000, 'x') + std::string("\0tail", 5);
+  const TemporaryFile file("test_str_from_file.txt", text);
+  const String str = String::FromFile(file.Path());
+  RequireEqual(str, text);
+  REQUIRE(str.Capacity() == str.Size());
+  REQUIRE(str.CStr()[str.Size()] == '\0');
+
+  const TemporaryFile small("test_str_from_file_small.txt", "abc");
+  RequireEqual(String::FromFile(small.Path()), "abc");
+  const TemporaryFile empty("test_str_from_file_empty.txt", "");
+  RequireEqual(String::FromFile(empty.Path()), "");
+  REQUIRE_THROWS_AS(String::FromFile("/nonexistent/test_str_file"), std::system_error);
+
+  // Files that report size 0 but have contents.
+  const String status = String::FromFile("/proc/self/status");
+  REQUIRE(status.StartsWith("Name:"));
+
+  SECTION("Errors close the file") {
+    auto open_files = [] {
+      auto files = std::filesystem::directory_iterator("/proc/self/fd");
+      return std::distance(std::filesystem::begin(files), std::filesystem::end(files));
+    };
+    const auto before = open_files();
+    // read() fails on a directory.
+    REQUIRE_THROWS_AS(String::FromFile(std::filesystem::temp_directory_path().c_str()), std::system_error);
+    // So does the allocation of the buffer.
+    REQUIRE_THROWS_AS(PmrString::FromFile(file.Path(), std::pmr::null_memory_resource()), std::bad_alloc);
+    REQUIRE_THROWS_AS(MappedFile(std::filesystem::temp_directory_path().c_str()), std::system_error);
+    REQUIRE(open_files() == before);
+  }
+}
+
+// Validity by decoding one sequence at a time, to check the SIMD validator against.
+bool ValidByDecoding(const std::string& text) {
+  const auto *p = reinterpret_cast<const unsigned char *>(text.data());
+  for (std::size_t i = 0, length; i < text.size(); i += length) {
+    if ((length = Utf8SequenceLength(p + i, text.size() - i)) == 0) return false;
+  }
+  return true;
+}
+
+TEST_CASE("UTF-8 validation", "[Utf8]") {
+  SECTION("Well-formed") {
+    for (const char *text : {"", "ascii", "\x7F", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF",
+                             "\xEE\x80\x80", "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+                             "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xE4\xB8\x96\xE7\x95\x8C \xF0\x9F\x98\x80"}) {
+      INFO(text);
+      REQUIRE(StringView(text).IsValidUtf8());
+      REQUIRE(String(text).IsValidUtf8());
+    }
+  }
+
+  SECTION("Ill-formed") {
+    for (const char *text : {"\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xC2", "\xC2\x41", "\xE0\x80\x80",
+                             "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF", "\xE1\x80", "\xF0\x80\x80\x80",
+                             "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xF0\x90\x80",
+                             "\xC2\x80\x80", "\xE1\x80\x80\x80"}) {
+      INFO(text);
+      REQUIRE_FALSE(StringView(text).IsValidUtf8());
+    }
+  }
+
+  SECTION("Errors at every position around block boundaries") {
+    const std::string sequences[] = {"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"};
+    for (std::size_t size = 0; size < 100; ++size) {
+      for (const std::string& sequence : sequences) {
+        std::string text(size, 'a');
+        text += sequence;
+        text += std::string(size % 7, 'b');
+        REQUIRE(StringView(text.data(), text.size()).IsValidUtf8());
+        // Cut the sequence short, once at the very end and once in the middle of the text.
+        std::string cut = text.substr(0, size + sequence.size() - 1);
+        REQUIRE_FALSE(StringView(cut.data(), cut.size()).IsValidUtf8());
+        cut += std::string(size % 7, 'b');
+        REQUIRE_FALSE(StringView(cut.data(), cut.size()).IsValidUtf8());
+        // A stray continuation byte.
+        text.insert(size, 1, '\x80');
+        REQUIRE_FALSE(StringView(text.data(), text.size()).IsValidUtf8());
+      }
+    }
+  }
+
+  SECTION("Long text") {
+    std::string text;
+    while (text.size() < 10000) text += "\xD0\x9F\xD1\x80\xD0\xB8 \xE4\xB8\x96\xF0\x9F\x98\x80 ascii ";
+    REQUIRE(StringView(text.data(), text.size()).IsValidUtf8());
+    for (std::size_t pos : {std::size_t(0), std::size_t(1500), text.size() / 2, text.size() - 1}) {
+      std::string broken = text;
+      broken[pos] = '\xFF';
+      REQUIRE_FALSE(StringView(broken.data(), broken.size()).IsValidUtf8());
+    }
+  }
+
+  SECTION("Agrees with decoding") {
+    std::mt19937 rng(13);
+    const std::string pieces[] = {"a", "z", " ", "\xC3\xA9", "\xD0\xB6", "\xE2\x82\xAC", "\xE4\xB8\x96",
+                                  "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF"};
+    for (int round = 0; round < 3000; ++round) {
+      std::string text;
+      const std::size_t count = rng() % 80;
+      for (std::size_t i = 0; i < count; ++i) text += pieces[rng() % std::size(pieces)];
+      if (round % 2 == 1 && !text.empty()) {
+        // Corrupt one byte; the result may or may not stay valid.
+        text[rng() % text.size()] = static_cast<char>(rng() % 256);
+      }
+      INFO(round);
+      const bool valid = ValidByDecoding(text);
+      REQUIRE(StringView(text.data(), text.size()).IsValidUtf8() == valid);
+#if defined(__x86_64__)
+      // Whichever one the dispatch picked, the other lookup kernel runs too where the CPU has it.
+      if (__builtin_cpu_supports("ssse3")) REQUIRE(ValidUtf8Ssse3(text.data(), text.size()) == valid);
+      if (__builtin_cpu_supports("avx2")) REQUIRE(ValidUtf8Avx2(text.data(), text.size()) == valid);
+#endif
+    }
+  }
+}
+
+TEST_CASE("UTF-8 code points", "[Utf8]") {
+  const String text("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80z");
+  REQUIRE(text.CodePointCount() == 5);
+  REQUIRE(StringView("").CodePointCount() == 0);
+  const std::string long_text = std::string(1000, 'x') + "\xD0\xB6\xD0\xB8\xD0\xB2" + std::string(77, 'y');
+  REQUIRE(StringView(long_text.data(), long_text.size()).CodePointCount() == 1080);
+
+  std::vector<char32_t> decoded;
+  for (char32_t code_point : text.CodePoints()) decoded.push_back(code_point);
+  REQUIRE(decoded == std::vector<char32_t>{U'a', 0xE9, 0x20AC, 0x1F600, U'z'});
+
+  auto it = StringView(text).CodePoints().begin();
+  ++it;
+  REQUIRE(it.Position() == text.CStr() + 1);
+  REQUIRE(it.Length() == 2);
+
+  // Every byte that does not start a sequence reads as U+FFFD on its own.
+  decoded.clear();
+  for (char32_t code_point : StringView("\x80" "a\xE2\x82" "b\xF4\x90\x80\x80").CodePoints()) decoded.push_back(code_point);
+  REQUIRE(decoded == std::vector<char32_t>{0xFFFD, U'a', 0xFFFD, 0xFFFD, U'b', 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD});
+  REQUIRE(std::distance(StringView("").CodePoints().begin(), StringView("").CodePoints().end()) == 0);
+}
+
+TEST_CASE("UTF-8 transcoding", "[Utf8]") {
+  const std::string text = std::string(40, 'x') + "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xEF\xBF\xBF" + std::string(9, 'y');
+  const std::u16string utf16 = std::u16string(40, u'x') + u"aé€\U0001F600￿" + std::u16string(9, u'y');
+  const std::u32string utf32 = std::u32string(40, U'x') + U"aé€\U0001F600￿" + std::u32string(9, U'y');
+
+  std::vector<char16_t> units16(text.size());
+  REQUIRE(Utf8ToUtf16(text.data(), text.size(), units16.data()) == utf16.size());
+  REQUIRE(std::u16string(units16.data(), utf16.size()) == utf16);
+  std::vector<char32_t> units32(text.size());
+  REQUIRE(Utf8ToUtf32(text.data(), text.size(), units32.data()) == utf32.size());
+  REQUIRE(std::u32string(units32.data(), utf32.size()) == utf32);
+
+  std::vector<char> bytes(4 * utf32.size());
+  REQUIRE(Utf16ToUtf8(utf16.data(), utf16.size(), bytes.data()) == text.size());
+  REQUIRE(std::string(bytes.data(), text.size()) == text);
+  REQUIRE(Utf32ToUtf8(utf32.data(), utf32.size(), bytes.data()) == text.size());
+  REQUIRE(std::string(bytes.data(), text.size()) == text);
+
+  REQUIRE(Utf8ToUtf16("", 0, units16.data()) == 0);
+  REQUIRE(Utf8ToUtf16("a\xC0\x80", 3, units16.data()) == TranscodeError);
+  REQUIRE(Utf8ToUtf32("\xF0\x9F\x98", 3, units32.data()) == TranscodeError);
+  const char16_t lone_high[] = {u'a', 0xD83D}, lone_low[] = {0xDE00, u'a'}, swapped[] = {0xDE00, 0xD83D};
+  REQUIRE(Utf16ToUtf8(lone_high, 2, bytes.data()) == TranscodeError);
+  REQUIRE(Utf16ToUtf8(lone_low, 2, bytes.data()) == TranscodeError);
+  REQUIRE(Utf16ToUtf8(swapped, 2, bytes.data()) == TranscodeError);
+  const char32_t surrogate[] = {0xD800}, too_large[] = {0x110000};
+  REQUIRE(Utf32ToUtf8(surrogate, 1, bytes.data()) == TranscodeError);
+  REQUIRE(Utf32ToUtf8(too_large, 1, bytes.data()) == TranscodeError);
+}
+
+TEST_CASE("Append numbers", "[String]") {
+  String str;
+  str.AppendInt(0).PushBack(' ');
+  str.AppendInt(-42).PushBack(' ');
+  str.AppendInt(INT64_MIN).PushBack(' ');
+  str.AppendUInt(UINT64_MAX).PushBack(' ');
+  str.AppendHex(0xDEADBEEF).PushBack(' ');
+  str.AppendHex(0).PushBack(' ');
+  str.AppendDouble(0.1).PushBack(' ');
+  str.AppendDouble(-1.5e300).PushBack(' ');
+  str.AppendDouble(1.0 / 0.0);
+  RequireEqual(str, "0 -42 -9223372036854775808 18446744073709551615 deadbeef 0 0.1 -1.5e+300 inf");
+
+  // Short numbers stay inline; longer ones grow the string like any other append.
+  String small;
+  small.AppendInt(123456789);
+  REQUIRE(small.Capacity() == String::InlineCapacity);
+  RequireEqual(small, "123456789");
+  small.AppendInt(INT64_MAX);
+  RequireEqual(small, "1234567899223372036854775807");
+
+  std::mt19937_64 rng(5);
+  std::string expected;
+  String appended;
+  for (int i = 0; i < 2000; ++i) {
+    const auto bits = rng();
+    const double number = std::ldexp(static_cast<double>(bits % 1000003) - 500000, static_cast<int>(bits % 200) - 100);
+    appended.AppendInt(static_cast<int64_t>(bits)).AppendDouble(number).PushBack(',');
+    expected += std::to_string(static_cast<int64_t>(bits));
+    char buffer[32];
+    expected.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), number).ptr);
+    expected += ',';
+  }
+  RequireEqual(appended, expected);
+}
+
+TEST_CASE("Parse numbers", "[String]") {
+  int64_t integer = 7;
+  REQUIRE(ParseInt("-9223372036854775808", integer));
+  REQUIRE(integer == INT64_MIN);
+  REQUIRE(ParseInt(String("42"), integer));
+  REQUIRE(integer == 42);
+  REQUIRE(ParseInt("ff", integer, 16));
+  REQUIRE(integer == 255);
+  for (const char *bad : {"", "-", "+1", " 1", "1 ", "1x", "9223372036854775808", "0x10"}) {
+    INFO(bad);
+    REQUIRE_FALSE(ParseInt(bad, integer));
+    REQUIRE(integer == 255);
+  }
+
+  uint64_t unsigned_integer = 0;
+  REQUIRE(ParseUInt("18446744073709551615", unsigned_integer));
+  REQUIRE(unsigned_integer == UINT64_MAX);
+  REQUIRE_FALSE(ParseUInt("-1", unsigned_integer));
+  REQUIRE_FALSE(ParseUInt("18446744073709551616", unsigned_integer));
+
+  // A view into the middle of a larger text.
+  const StringView line = "latency=1.25e-3 ms";
+  double number = 0;
+  REQUIRE(ParseDouble(line.Substr(8, 7), number));
+  REQUIRE(number == 1.25e-3);
+  REQUIRE_FALSE(ParseDouble(line.Substr(8), number));
+  REQUIRE(ParseDouble("inf", number));
+  REQUIRE(std::isinf(number));
+  REQUIRE_FALSE(ParseDouble("1e999", number));
+  REQUIRE_FALSE(ParseDouble(StringView(), number));
+
+  // Round trip of the shortest form.
+  std::mt19937_64 rng(11);
+  for (int i = 0; i < 1000; ++i) {
+    double value;
+    const uint64_t bits = rng();
+    std::memcpy(&value, &bits, sizeof(value));
+    if (!std::isfinite(value)) continue;
+    String text;
+    text.AppendDouble(value);
+    double parsed;
+    REQUIRE(ParseDouble(text, parsed));
+    REQUIRE(parsed == value);
+  }
+}
+
+TEST_CASE("Format", "[Format]") {
+  RequireEqual(Format<"">(), "");
+  RequireEqual(Format<"plain text">(), "plain text");
+  RequireEqual(Format<"{}">(0), "0");
+  RequireEqual(Format<"{{}} {{{}}} }}{{">(1), "{} {1} }{");
+  RequireEqual(Format<"{} {} {} {} {}">(-7, 42u, INT64_MIN, UINT64_MAX, static_cast<short>(-3)),
+               "-7 42 -9223372036854775808 18446744073709551615 -3");
+  RequireEqual(Format<"{:x} {:x} {:x} {:x} {:x}">(0, 255, UINT64_MAX, int64_t{-1}, int8_t{-1}),
+               "0 ff ffffffffffffffff ffffffffffffffff ff");
+  RequireEqual(Format<"{} {} {} {}">(0.1, -2.5e-300, 1.0f / 3, 1e100), "0.1 -2.5e-300 0.33333334 1e+100");
+  RequireEqual(Format<"[{}|{}|{}]">('c', true, false), "[c|true|false]");
+
+  const String name("request.latency");
+  const std::string std_name = "std";
+  const char *null_text = nullptr;
+  RequireEqual(Format<"{}={} {} {} {} {}.">(name, StringView("view"), "literal", std_name, std::string_view("sv"), null_text),
+               "request.latency=view literal std sv .");
+
+  // Every digit count, both signs.
+  for (uint64_t power = 1, digits = 1; digits <= 19; power *= 10, ++digits) {
+    for (uint64_t value : {power - 1, power, power + 1, 2 * power, 9 * power}) {
+      char expected[64];
+      std::snprintf(expected, sizeof(expected), "%llu|%lld|%llx", static_cast<unsigned long long>(value),
+                    -static_cast<long long>(value), static_cast<unsigned long long>(value));
+      RequireEqual(Format<"{}|{}|{:x}">(value, -static_cast<int64_t>(value), value), expected);
+    }
+  }
+
+  SECTION("FormatTo appends") {
+    String line("metric ");
+    FormatTo<"{} {}\n">(line, 12, 0.5);
+    RequireEqual(line, "metric 12 0.5\n");
+    // Arguments may point into the string that grows.
+    FormatTo<"[{}]">(line, line);
+    RequireEqual(line, "metric 12 0.5\n[metric 12 0.5\n]");
+    std::string expected = line.CStr();
+    for (int i = 0; i < 1000; ++i) {
+      FormatTo<"{},">(line, i);
+      expected += std::to_string(i) + ",";
+    }
+    RequireEqual(line, expected);
+
+    std::pmr::monotonic_buffer_resource arena;
+    PmrString pmr(&arena);
+    FormatTo<"{}-{}">(pmr, "arena", 1);
+    REQUIRE(StringView(pmr) == "arena-1");
+  }
+}
+
+TEST_CASE("ASCII case and whitespace", "[String]") {
+  SECTION("ToLower and ToUpper") {
+    String header("Content-Type: Text/HTML; charset=UTF-8 \xC3\x84@[`{");
+    REQUIRE(&header.ToLower() == &header);
+    RequireEqual(header, "content-type: text/html; charset=utf-8 \xC3\x84@[`{");
+    header.ToUpper();
+    RequireEqual(header, "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8 \xC3\x84@[`{");
+    RequireEqual(ToLower("MiXeD"), "mixed");
+    RequireEqual(ToUpper(String("MiXeD")), "MIXED");
+    RequireEqual(ToLower(""), "");
+    std::pmr::monotonic_buffer_resource arena;
+    REQUIRE(StringView(ToLower("ARENA", std::pmr::polymorphic_allocator<char>(&arena))) == "arena");
+  }
+
+  SECTION("Agree with the C library at every length and byte") {
+    std::string bytes;
+    for (int i = 0; i < 256; ++i) bytes += static_cast<char>(i);
+    for (std::size_t size = 0; size <= bytes.size(); size += (size < 70 ? 1 : 31)) {
+      for (std::size_t offset : {std::size_t(0), std::size_t(1), std::size_t(37)}) {
+        std::string text = bytes.substr(offset) + bytes.substr(0, offset);
+        text.resize(size);
+        std::string lower = text, upper = text;
+        for (auto& symbol : lower) symbol = (symbol >= 'A' && symbol <= 'Z') ? symbol + 32 : symbol;
+        for (auto& symbol : upper) symbol = (symbol >= 'a' && symbol <= 'z') ? symbol - 32 : symbol;
+        String str(text.data(), text.size());
+        RequireEqual(ToLower(str), lower);
+        RequireEqual(ToUpper(str), upper);
+        RequireEqual(str.ToLower(), lower);
+        REQUIRE(str.EqualsIgnoreCase(StringView(upper.data(), upper.size())));
+        if (size > 0) {
+          // One byte that differs after folding, at the start, middle and end.
+          for (std::size_t pos : {std::size_t(0), size / 2, size - 1}) {
+            std::string other = upper;
+            other[pos] = other[pos] == '0' ? '1' : '0';
+            REQUIRE(str.EqualsIgnoreCase(StringView(other.data(), other.size())) == (lower[pos] == other[pos]));
+          }
+        }
+      }
+    }
+    REQUIRE(StringView("Keep-Alive").EqualsIgnoreCase("keep-alive"));
+    REQUIRE_FALSE(StringView("Keep-Alive").EqualsIgnoreCase("keep-alive "));
+    REQUIRE_FALSE(StringView("@").EqualsIgnoreCase("`"));
+    REQUIRE_FALSE(StringView("[").EqualsIgnoreCase("{"));
+  }
+
+  SECTION("Trim") {
+    REQUIRE(StringView("  \t value \r\n").Trim() == "value");
+    REQUIRE(StringView("  \t value \r\n").LTrim() == "value \r\n");
+    REQUIRE(StringView("  \t value \r\n").RTrim() == "  \t value");
+    REQUIRE(StringView(" \t\n\v\f\r").Trim().Empty());
+    REQUIRE(StringView("").Trim().Empty());
+    REQUIRE(StringView("a b").Trim() == "a b");
+    // Bytes next to the whitespace range are not whitespace.
+    REQUIRE(StringView("\x08x\x0E").Trim() == "\x08x\x0E");
+    REQUIRE(StringView("\xA0x\x85").Trim() == "\xA0x\x85");
+
+    for (std::size_t left = 0; left < 80; left += 7) {
+      for (std::size_t right = 0; right < 80; right += 5) {
+        const std::string core = "x" + std::string(left % 40, 'y') + " z";
+        const std::string text = std::string(left, ' ') + core + std::string(right, '\t');
+        REQUIRE(StringView(text.data(), text.size()).Trim() == StringView(core.data(), core.size()));
+        String str(text.data(), text.size());
+        const std::size_t capacity = str.Capacity();
+        RequireEqual(str.Trim(), core);
+        REQUIRE(str.Capacity() == capacity);
+        str = String(text.data(), text.size());
+        RequireEqual(str.LTrim(), core + std::string(right, '\t'));
+        str = String(text.data(), text.size());
+        RequireEqual(str.RTrim(), std::string(left, ' ') + core);
+        const std::string spaces(left + right, '\n');
+        RequireEqual(String(spaces.data(), spaces.size()).Trim(), "");
+      }
+    }
+  }
+
+  SECTION("Word fallback at every alignment") {
+    // SkipSpaceWords and RSkipSpaceWords are the whole scan where there is no SIMD kernel, and the
+    // tail of the SIMD ones; called directly here, since x86 never dispatches to them alone.
+    const char pattern[] = " \t\n\v\f\r x\x80\0\x1F!";
+    alignas(8) char buffer[64];
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+      for (std::size_t size = 0; offset + size <= 40; ++size) {
+        for (std::size_t text = 0; text <= size; ++text) {
+          // Whitespace around one non-space byte at text (none when text == size); the bytes
+          // around the range are text, so a scan that reads past it would stop there.
+          std::memset(buffer, 'q', sizeof(buffer));
+          char* data = buffer + offset;
+          for (std::size_t i = 0; i < size; ++i) data[i] = pattern[(i + offset) % 6];
+          if (text < size) data[text] = pattern[7 + (text + offset) % 5];
+          const char* first = data;
+          while (first != data + size && std::isspace(static_cast<unsigned char>(*first))) ++first;
+          const char* last = data + size;
+          while (last != data && std::isspace(static_cast<unsigned char>(last[-1]))) --last;
+          REQUIRE(SkipSpaceWords(data, size) == first);
+          REQUIRE(RSkipSpaceWords(data, size) == last);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("SharedString", "[SharedString]") {
+  SECTION("Copies share the buffer") {
+    const SharedString original("a string longer than the inline capacity");
+    SharedString copy = original;
+    REQUIRE(copy.Data() == original.Data());
+    REQUIRE(original.UseCount() == 2);
+    SharedString assigned;
+    assigned = copy;
+    REQUIRE(original.UseCount() == 3);
+    SharedString moved = std::move(assigned);
+    REQUIRE(assigned.Empty());
+    REQUIRE(original.UseCount() == 3);
+    moved.Clear();
+    REQUIRE(original.UseCount() == 2);
+    REQUIRE(copy == original);
+    REQUIRE(std::hash<SharedString>()(copy) == StringView("a string longer than the inline capacity").Hash());
+  }
+
+  SECTION("Mutators detach") {
+    const SharedString original("shared text");
+    auto mutate = [&](auto change, std::string_view expected) {
+      SharedString copy = original;
+      change(copy);
+      REQUIRE(copy.Data() != original.Data());
+      REQUIRE(copy.UseCount() == 1);
+      REQUIRE(original.UseCount() == 1);
+      REQUIRE(std::string_view(copy.CStr()) == expected);
+      REQUIRE(std::string_view(original.CStr()) == "shared text");
+    };
+    mutate([](SharedString& s) { s[0] = 'S'; }, "Shared text");
+    mutate([](SharedString& s) { s.PushBack('!'); }, "shared text!");
+    mutate([](SharedString& s) { s.PopBack(); }, "shared tex");
+    mutate([](SharedString& s) { s.Append(" and more"); }, "shared text and more");
+    mutate([](SharedString& s) { s += StringView("?"); }, "shared text?");
+    mutate([](SharedString& s) { s.Resize(6, ' '); }, "shared");
+    mutate([](SharedString& s) { s.Resize(13, '.'); }, "shared text..");
+    mutate([](SharedString& s) { s.Reserve(100); }, "shared text");
+  }
+
+  SECTION("A unique buffer is changed in place") {
+    SharedString str("abc");
+    str.Reserve(64);
+    const char *data = str.Data();
+    str.PushBack('d');
+    str[0] = 'A';
+    str.Append("efg");
+    str.Resize(5, ' ');
+    REQUIRE(str.Data() == data);
+    REQUIRE(str.View() == "Abcde");
+    REQUIRE(str.CStr()[5] == '\0');
+  }
+
+  SECTION("A handed out reference keeps later copies apart") {
+    SharedString str("abc");
+    char& first = str[0];
+    SharedString copy = str;
+    SharedString assigned;
+    assigned = str;
+    first = 'X';
+    REQUIRE(str.View() == "Xbc");
+    REQUIRE(copy.View() == "abc");
+    REQUIRE(assigned.View() == "abc");
+    REQUIRE(str.UseCount() == 1);
+    // The copies themselves share as usual.
+    SharedString again = copy;
+    REQUIRE(again.Data() == copy.Data());
+    // So does a string that has been given a new buffer since.
+    str.Reserve(100);
+    SharedString later = str;
+    REQUIRE(later.Data() == str.Data());
+    // Appending a string's own characters after it became unshareable.
+    SharedString self("0123456789");
+    self[0] = '-';
+    self.Append(self.View());
+    REQUIRE(self.View() == "-123456789-123456789");
+  }
+
+  SECTION("Growth and aliasing") {
+    SharedString str;
+    REQUIRE(str.Empty());
+    REQUIRE(str.UseCount() == 0);
+    REQUIRE(std::string_view(str.CStr()).empty());
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+      str.PushBack(static_cast<char>('a' + i % 26));
+      expected += static_cast<char>('a' + i % 26);
+    }
+    REQUIRE(str.Capacity() < 4 * expected.size());
+    str.Append(str);
+    expected += expected;
+    REQUIRE(str.View() == StringView(expected.data(), expected.size()));
+    SharedString copy = str;
+    copy.Append(copy.View().Substr(0, 10));
+    REQUIRE(copy.View().EndsWith("abcdefghij"));
+    REQUIRE(copy.Size() == str.Size() + 10);
+    REQUIRE(copy.ToString().Size() == copy.Size());
+    std::ostringstream stream;
+    stream << SharedString("out");
+    REQUIRE(stream.str() == "out");
+  }
+
+  SECTION("Copies cross threads") {
+    const SharedString original(std::string(1000, 'x').c_str());
+    std::vector<std::thread> threads;
+    std::atomic<size_t> total {0};
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&total, copy = original]() mutable {
+        std::vector<SharedString> copies;
+        for (int i = 0; i < 10000; ++i) copies.push_back(copy);
+        copies.back().PushBack('y');
+        for (const auto& kept : copies) total += kept.Size();
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    REQUIRE(total == 4 * (10000 * 1000 + 1));
+    REQUIRE(original.UseCount() == 1);
+  }
+}
+
+TEST_CASE("StringColumn", "[StringColumn]") {
+  SECTION("PushBack and access") {
+    StringColumn column;
+    REQUIRE(column.Empty());
+    REQUIRE(column.Size() == 0);
+    REQUIRE(column.ByteSize() == 0);
+    REQUIRE(column.Offsets()[0] == 0);
+    REQUIRE(column.begin() == column.end());
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+      expected.push_back(std::string(i % 37, static_cast<char>('a' + i % 26)));
+      column.PushBack(StringView(expected.back().data(), expected.back().size()));
+    }
+    REQUIRE(column.Size() == expected.size());
+    size_t bytes = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      REQUIRE(column[i] == StringView(expected[i].data(), expected[i].size()));
+      REQUIRE(column.Offsets()[i] == bytes);
+      bytes += expected[i].size();
+    }
+    REQUIRE(column.ByteSize() == bytes);
+    REQUIRE(column.Offsets()[column.Size()] == bytes);
+    REQUIRE(column.Front().Empty());
+    REQUIRE(column.Back() == column[999]);
+    REQUIRE_THROWS_AS(column.At(1000), std::out_of_range);
+    size_t index = 0;
+    for (StringView str : column) REQUIRE(str == column[index++]);
+    REQUIRE(index == column.Size());
+
+    column.Clear();
+    REQUIRE(column.Empty());
+    column.PushBack("again");
+    REQUIRE(column.Size() == 1);
+    REQUIRE(column[0] == "again");
+  }
+
+  SECTION("PushBack of its own string") {
+    StringColumn column {"first", "second"};
+    for (int i = 0; i < 100; ++i) column.PushBack(column[i % 2]);
+    REQUIRE(column.Size() == 102);
+    REQUIRE(column[100] == "first");
+    REQUIRE(column[101] == "second");
+  }
+
+  SECTION("Slices") {
+    const LargeStringColumn column {"zero", "one", "", "three", "four"};
+    LargeStringColumnSlice middle = column.Slice(1, 3);
+    REQUIRE(middle.Size() == 3);
+    REQUIRE(middle[0] == "one");
+    REQUIRE(middle[1].Empty());
+    REQUIRE(middle.Back() == "three");
+    REQUIRE(middle.ByteSize() == 8);
+    REQUIRE(middle.Bytes() == column.Bytes());
+    REQUIRE(middle.Offsets() == column.Offsets() + 1);
+    REQUIRE(middle.Slice(2)[0] == "three");
+    REQUIRE(column.Slice(3, 100).Size() == 2);
+    REQUIRE(column.Slice(5).Empty());
+    REQUIRE_THROWS_AS(column.Slice(6), std::out_of_range);
+    REQUIRE(std::count(middle.begin(), middle.end(), StringView("one")) == 1);
+  }
+
+  SECTION("Append") {
+    StringColumn column {"a", "bc"};
+    const StringColumn other {"def", "", "ghij"};
+    column.Append(other);
+    REQUIRE(column.Size() == 5);
+    REQUIRE(column.ByteSize() == 10);
+    REQUIRE(column[2] == "def");
+    REQUIRE(column[3].Empty());
+    REQUIRE(column[4] == "ghij");
+
+    column.Append(other.Slice(2));
+    REQUIRE(column.Size() == 6);
+    REQUIRE(column[5] == "ghij");
+    REQUIRE(column.Offsets()[6] == 14);
+
+    StringColumn empty;
+    empty.Append(other.Slice(1, 1));
+    REQUIRE(empty.Size() == 1);
+    REQUIRE(empty[0].Empty());
+    empty.Append(StringColumn());
+    REQUIRE(empty.Size() == 1);
+
+    // A slice of the column itself.
+    column.Append(column.Slice(1, 2));
+    column.Append(column);
+    REQUIRE(column.Size() == 16);
+    REQUIRE(column[6] == "bc");
+    REQUIRE(column[7] == "def");
+    REQUIRE(column[15] == "def");
+    StringColumn blanks {"", ""};
+    blanks.Append(blanks);
+    REQUIRE(blanks.Size() == 4);
+    REQUIRE(blanks.ByteSize() == 0);
+  }
+
+  SECTION("Copy, move and swap") {
+    StringColumn column {"x", "yy"};
+    column.Reserve(10, 100);
+    StringColumn copy = column;
+    copy.PushBack("zzz");
+    REQUIRE(column.Size() == 2);
+    REQUIRE(copy.Size() == 3);
+    StringColumn moved = std::move(copy);
+    REQUIRE(moved[2] == "zzz");
+    moved.Swap(column);
+    REQUIRE(column.Size() == 3);
+    REQUIRE(moved.Size() == 2);
+    moved.Reserve(100, 1000);
+    REQUIRE(moved[1] == "yy");
+  }
+}
+
+namespace {
+
+// Sorts with SortStrings or ParallelSortStrings and checks the order against std::sort.
+void CheckSort(const std::vector<std::string>& source, size_t threads) {
+  std::vector<std::string> expected = source;
+  std::sort(expected.begin(), expected.end());
+  Vector<String> strings;
+  Vector<StringView> views;
+  for (const auto& str : source) {
+    strings.PushBack(String(str.data(), str.size()));
+    views.PushBack(StringView(str.data(), str.size()));
+  }
+  if (threads == 1) {
+    SortStrings(strings);
+    SortStrings(views);
+  } else {
+    ThreadPool pool(threads);
+    ParallelSortStrings(strings, pool);
+    ParallelSortStrings(views, pool);
+  }
+  REQUIRE(strings.Size() == expected.size());
+  REQUIRE(views.Size() == expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const StringView want(expected[i].data(), expected[i].size());
+    REQUIRE(strings[i] == want);
+    REQUIRE(views[i] == want);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("SortStrings", "[Sort]") {
+  std::mt19937_64 rng(7);
+
+  SECTION("Small and edge cases") {
+    CheckSort({}, 1);
+    CheckSort({"one"}, 1);
+    CheckSort({"b", "a"}, 1);
+    CheckSort({"", "a", "", "ab", "a", std::string("a\0", 2), std::string("a\0\0", 3), "aaaaaaaa", "aaaaaaaa",
+               "aaaaaaaab", "aaaaaaaa\xff", "\x80", "\x7f", "zzzzzzzzzzzzzzzzzzzzz", "zzzzzzzzzzzzzzzzzzzzy"}, 1);
+  }
+
+  for (size_t threads : {size_t(1), size_t(4)}) {
+    SECTION("Random strings, " + std::to_string(threads) + " threads") {
+      // Over the thresholds of the radix pass and of the threads.
+      std::vector<std::string> source(200000);
+      for (auto& str : source) {
+        str.resize(rng() % 24);
+        for (auto& symbol : str) symbol = static_cast<char>(rng() % 256);
+      }
+      CheckSort(source, threads);
+    }
+
+    SECTION("Long common prefixes and duplicates, " + std::to_string(threads) + " threads") {
+      std::vector<std::string> source;
+      const std::string prefix = "https://example.com/a/long/shared/path/";
+      for (int i = 0; i < 100000; ++i) {
+        std::string str = prefix.substr(0, rng() % prefix.size());
+        for (size_t n = rng() % 5; n > 0; --n) str += static_cast<char>('a' + rng() % 3);
+        if (rng() % 7 == 0) str += '\0';
+        source.push_back(str);
+      }
+      CheckSort(source, threads);
+    }
+  }
+
+  SECTION("All equal") {
+    CheckSort(std::vector<std::string>(70000, "the same string, longer than eight bytes"), 2);
+  }
+
+  SECTION("PmrVector and strings without a default constructor") {
+    // Moved, not relocated as bytes, and never default-constructed.
+    struct Name {
+      explicit Name(std::string text) : Text(std::move(text)) {}
+      operator StringView() const { return StringView(Text.data(), Text.size()); }
+      std::string Text;
+    };
+    static_assert(!std::is_default_constructible_v<Name> && !IsTriviallyRelocatable<Name>::value);
+    std::vector<std::string> expected;
+    Vector<Name> names;
+    std::pmr::monotonic_buffer_resource arena;
+    PmrVector<PmrString> pmr_strings(&arena);
+    for (int i = 0; i < 100000; ++i) {
+      expected.push_back(std::to_string(rng() % 50000) + std::string(rng() % 20, 'x'));
+      names.EmplaceBack(expected.back());
+      pmr_strings.EmplaceBack(expected.back().data(), expected.back().size(), &arena);
+    }
+    std::sort(expected.begin(), expected.end());
+    ThreadPool pool(4);
+    ParallelSortStrings(names, pool);
+    SortStrings(pmr_strings);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      REQUIRE(names[i].Text == expected[i]);
+      REQUIRE(pmr_strings[i] == StringView(expected[i].data(), expected[i].size()));
+    }
+    REQUIRE(pmr_strings.GetAllocator().resource() == &arena);
+  }
+}
+
+TEST_CASE("Strings in a Vector", "[String]") {
+  // String and SharedString opt in to IsTriviallyRelocatable, so Vector moves them with memcpy.
+  static_assert(IsTriviallyRelocatable<String>::value);
+  static_assert(IsTriviallyRelocatable<PmrString>::value);
+  static_assert(IsTriviallyRelocatable<SharedString>::value);
+
+  SECTION("Strings keep their characters") {
+    Vector<String> strings;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+      expected.push_back(std::string(i % 40, static_cast<char>('a' + i % 26)));
+      strings.PushBack(String(expected.back().c_str()));
+    }
+    strings.Reserve(5000);
+    strings.ShrinkToFit();
+    strings.Resize(1200, String("filler, longer than the inline buffer"));
+    strings.Insert(strings.begin(), strings.begin() + 1, strings.begin() + 3);
+    strings.Erase(strings.begin(), strings.begin() + 2);
+    REQUIRE(strings.Size() == 1200);
+    for (size_t i = 0; i < expected.size(); ++i) REQUIRE(strings[i] == StringView(expected[i].data(), expected[i].size()));
+    REQUIRE(strings[1199] == "filler, longer than the inline buffer");
+  }
+
+  SECTION("Pushing an element of the vector while it grows") {
+    Vector<String> strings;
+    strings.PushBack(String("an element on the heap, not inline"));
+    for (int i = 0; i < 100; ++i) {
+      strings.ShrinkToFit();
+      strings.PushBack(strings[0]);
+    }
+    REQUIRE(strings.Size() == 101);
+    REQUIRE(strings[100] == strings[0]);
+  }
 }
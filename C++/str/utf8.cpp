@@ -0,0 +1,128 @@
+#include "utf8.hpp"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Runs of ASCII are widened a block at a time: 16 bytes with SSE2 unpacks on x86-64, otherwise
+// 8 bytes behind a single test of their high bits.
+template <typename Unit>
+size_t WidenAscii(const char *data, size_t size, Unit *out) {
+	size_t i = 0;
+#if defined(__x86_64__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= size; i += 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+		if (_mm_movemask_epi8(block) != 0) break;
+		__m128i low = _mm_unpacklo_epi8(block, zero), high = _mm_unpackhi_epi8(block, zero);
+		__m128i *target = reinterpret_cast<__m128i *>(out + i);
+		if constexpr (sizeof(Unit) == 2) {
+			_mm_storeu_si128(target, low);
+			_mm_storeu_si128(target + 1, high);
+		} else {
+			_mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
+		}
+	}
+#endif
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		if ((word & 0x8080808080808080ull) != 0) break;
+		for (size_t k = 0; k < 8; ++k) out[i + k] = static_cast<Unit>(data[i + k]);
+	}
+	return i;
+}
+
+template <typename Unit>
+size_t Utf8ToWide(const char *data, size_t size, Unit *out) {
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+	size_t i = 0, written = 0;
+	while (i < size) {
+		if (p[i] < 0x80) {
+			size_t ascii = WidenAscii(data + i, size - i, out + written);
+			if (ascii == 0) ascii = 1, out[written] = static_cast<Unit>(p[i]);
+			i += ascii;
+			written += ascii;
+			continue;
+		}
+		size_t length = Utf8SequenceLength(p + i, size - i);
+		if (length == 0) return TranscodeError;
+		char32_t code_point = Utf8Decode(p + i, length);
+		i += length;
+		if constexpr (sizeof(Unit) == 2) {
+			if (code_point >= 0x10000) {
+				code_point -= 0x10000;
+				out[written++] = static_cast<Unit>(0xD800 + (code_point >> 10));
+				out[written++] = static_cast<Unit>(0xDC00 + (code_point & 0x3FF));
+				continue;
+			}
+		}
+		out[written++] = static_cast<Unit>(code_point);
+	}
+	return written;
+}
+
+// Writes the UTF-8 form of a valid code point and returns the end of it.
+char *Encode(char32_t code_point, char *out) {
+	if (code_point < 0x80) {
+		*out++ = static_cast<char>(code_point);
+	} else if (code_point < 0x800) {
+		*out++ = static_cast<char>(0xC0 | (code_point >> 6));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	} else if (code_point < 0x10000) {
+		*out++ = static_cast<char>(0xE0 | (code_point >> 12));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	} else {
+		*out++ = static_cast<char>(0xF0 | (code_point >> 18));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+	return out;
+}
+
+bool IsSurrogate(char32_t unit) { return unit >= 0xD800 && unit <= 0xDFFF; }
+
+}  // namespace
+
+size_t Utf8ToUtf16(const char *data, size_t size, char16_t *out) {
+	return Utf8ToWide(data, size, out);
+}
+
+size_t Utf8ToUtf32(const char *data, size_t size, char32_t *out) {
+	return Utf8ToWide(data, size, out);
+}
+
+size_t Utf16ToUtf8(const char16_t *data, size_t size, char *out) {
+	char *start = out;
+	for (size_t i = 0; i < size; ++i) {
+		char32_t unit = data[i];
+		if (unit < 0x80) {
+			*out++ = static_cast<char>(unit);
+			continue;
+		}
+		if (IsSurrogate(unit)) {
+			if (unit >= 0xDC00 || i + 1 == size || data[i + 1] < 0xDC00 || data[i + 1] > 0xDFFF)
+				return TranscodeError;
+			unit = 0x10000 + ((unit - 0xD800) << 10) + (data[++i] - 0xDC00);
+		}
+		out = Encode(unit, out);
+	}
+	return out - start;
+}
+
+size_t Utf32ToUtf8(const char32_t *data, size_t size, char *out) {
+	char *start = out;
+	for (size_t i = 0; i < size; ++i) {
+		if (data[i] > 0x10FFFF || IsSurrogate(data[i])) return TranscodeError;
+		out = Encode(data[i], out);
+	}
+	return out - start;
+}
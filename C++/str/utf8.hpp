@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "string_view.hpp"
+
+// UTF-8 helpers for String and StringView: decoding, a code-point iterator and transcoding
+// to and from UTF-16 and UTF-32. Validation and counting are SIMD kernels, see simd.hpp.
+//
+// Well-formed UTF-8 follows table 3-7 of the Unicode standard: no overlong encodings,
+// no surrogates (U+D800..U+DFFF) and nothing above U+10FFFF.
+
+// Length of the well-formed sequence at p, which has left bytes after it (at least one),
+// or 0 if the bytes there are not one.
+inline size_t Utf8SequenceLength(const unsigned char *p, size_t left) {
+	unsigned char lead = p[0];
+	if (lead < 0x80) return 1;
+	if (lead < 0xC2) return 0;
+	if (lead < 0xE0) return left >= 2 && (p[1] & 0xC0) == 0x80 ? 2 : 0;
+	if (lead < 0xF0) {
+		if (left < 3 || (p[2] & 0xC0) != 0x80) return 0;
+		unsigned char low = lead == 0xE0 ? 0xA0 : 0x80, high = lead == 0xED ? 0x9F : 0xBF;
+		return p[1] >= low && p[1] <= high ? 3 : 0;
+	}
+	if (lead < 0xF5) {
+		if (left < 4 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80) return 0;
+		unsigned char low = lead == 0xF0 ? 0x90 : 0x80, high = lead == 0xF4 ? 0x8F : 0xBF;
+		return p[1] >= low && p[1] <= high ? 4 : 0;
+	}
+	return 0;
+}
+
+// Code point of the well-formed sequence of length bytes at p.
+inline char32_t Utf8Decode(const unsigned char *p, size_t length) {
+	switch (length) {
+		case 1: return p[0];
+		case 2: return (char32_t(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+		case 3: return (char32_t(p[0] & 0x0F) << 12) | (char32_t(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+		default:
+			return (char32_t(p[0] & 0x07) << 18) | (char32_t(p[1] & 0x3F) << 12) | (char32_t(p[2] & 0x3F) << 6) |
+				(p[3] & 0x3F);
+	}
+}
+
+// Walks the code points of UTF-8 text. A byte that does not start a well-formed sequence
+// reads as U+FFFD and is skipped on its own, so iteration never fails and always ends.
+class Utf8Iterator {
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = char32_t;
+	using difference_type = ptrdiff_t;
+	using pointer = void;
+	using reference = char32_t;
+
+	static constexpr char32_t Replacement = 0xFFFD;
+
+	Utf8Iterator() {};
+	Utf8Iterator(const char *position, const char *end) : Position_(position), End_(end) { Decode(); };
+
+	char32_t operator*() const { return Current_; };
+	Utf8Iterator& operator++() {
+		Position_ += Length_;
+		Decode();
+		return *this;
+	};
+	Utf8Iterator operator++(int) {
+		Utf8Iterator copy = *this;
+		++*this;
+		return copy;
+	};
+	bool operator==(const Utf8Iterator& other) const { return Position_ == other.Position_; };
+
+	// The bytes of the current code point.
+	const char *Position() const { return Position_; };
+	size_t Length() const { return Length_; };
+
+private:
+	const char *Position_ = nullptr;
+	const char *End_ = nullptr;
+	char32_t Current_ = 0;
+	size_t Length_ = 0;
+
+	void Decode() {
+		if (Position_ == End_) return;
+		const unsigned char *p = reinterpret_cast<const unsigned char *>(Position_);
+		Length_ = Utf8SequenceLength(p, End_ - Position_);
+		if (Length_ == 0) {
+			Length_ = 1;
+			Current_ = Replacement;
+		} else {
+			Current_ = Utf8Decode(p, Length_);
+		}
+	};
+};
+
+// The code points of a text, for range-for: for (char32_t c : view.CodePoints()) ...
+class Utf8Range {
+public:
+	explicit Utf8Range(StringView text) : Text_(text) {};
+	Utf8Iterator begin() const { return Utf8Iterator(Text_.begin(), Text_.end()); };
+	Utf8Iterator end() const { return Utf8Iterator(Text_.end(), Text_.end()); };
+
+private:
+	StringView Text_;
+};
+
+inline Utf8Range StringView::CodePoints() const { return Utf8Range(*this); }
+
+// Transcoding into a buffer the caller allocates. Each function returns the number of code
+// units written, or TranscodeError if the input is not well-formed, in which case the contents
+// of out are unspecified. out needs room for at most:
+//   Utf8ToUtf16, Utf8ToUtf32: size units (one per input byte),
+//   Utf16ToUtf8: 3 * size bytes, Utf32ToUtf8: 4 * size bytes.
+constexpr size_t TranscodeError = ~size_t(0);
+
+size_t Utf8ToUtf16(const char *data, size_t size, char16_t *out);
+size_t Utf8ToUtf32(const char *data, size_t size, char32_t *out);
+// Surrogates have to come in high-low pairs.
+size_t Utf16ToUtf8(const char16_t *data, size_t size, char *out);
+// Surrogates and values above U+10FFFF are rejected.
+size_t Utf32ToUtf8(const char32_t *data, size_t size, char *out);
@@ -0,0 +1,276 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <iterator>
+#include <sstream>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "small_vector.cpp"
+
+namespace {
+
+// Counts live objects and how they were made; moves may be declared to throw.
+template <bool NothrowMove>
+struct Tracked {
+  static inline int alive = 0;
+  static inline int copies = 0;
+  static inline int moves = 0;
+  int value;
+
+  explicit Tracked(int v) : value(v) { ++alive; }
+  Tracked(const Tracked& other) : value(other.value) {
+    ++alive;
+    ++copies;
+  }
+  Tracked(Tracked&& other) noexcept(NothrowMove) : value(other.value) {
+    other.value = -1;
+    ++alive;
+    ++moves;
+  }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { --alive; }
+};
+
+// Copies throw once countdown reaches zero; a negative countdown never throws.
+struct Fragile {
+  static inline int countdown = -1;
+  static inline int alive = 0;
+  int value;
+
+  explicit Fragile(int v) : value(v) { ++alive; }
+  Fragile(const Fragile& other) : value(other.value) {
+    if (countdown == 0) throw std::runtime_error("copy failed");
+    if (countdown > 0) --countdown;
+    ++alive;
+  }
+  Fragile& operator=(const Fragile&) = default;
+  ~Fragile() { --alive; }
+};
+
+template <typename Container>
+std::vector<int> Values(const Container& container) {
+  std::vector<int> values;
+  for (const auto& item : container) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(item)>, int>)
+      values.push_back(item);
+    else
+      values.push_back(item.value);
+  }
+  return values;
+}
+
+// Every copy in turn throws, while the vector has room inline and when it has to spill to the
+// heap: the vector is unchanged.
+template <size_t N>
+void CheckStrongGuarantee() {
+  {
+    SmallVector<Fragile, N> values;
+    for (int i = 0; i < 5; ++i) values.EmplaceBack(i);
+    const std::vector<int> before = Values(values);
+    std::vector<Fragile> source;
+    for (int i = 10; i < 14; ++i) source.emplace_back(i);
+    auto check = [&](auto insert) {
+      for (int countdown = 0;; ++countdown) {
+        Fragile::countdown = countdown;
+        try {
+          insert();
+        } catch (const std::runtime_error&) {
+          Fragile::countdown = -1;
+          REQUIRE(Values(values) == before);
+          continue;
+        }
+        Fragile::countdown = -1;
+        values.Erase(values.begin() + 2, values.begin() + 2 + source.size());
+        REQUIRE(Values(values) == before);
+        return;
+      }
+    };
+    check([&] { values.Insert(values.begin() + 2, source.begin(), source.end()); });
+    check([&] { values.Insert(values.begin() + 2, source.size(), values[0]); });
+  }
+  REQUIRE(Fragile::alive == 0);
+}
+
+}  // namespace
+
+TEST_CASE("SmallVector", "[SmallVector]") {
+  static_assert(std::ranges::contiguous_range<SmallVector<int, 4>>);
+
+  SECTION("Inline until it grows past N") {
+    SmallVector<std::string, 4> strings;
+    REQUIRE(strings.IsInline());
+    REQUIRE(strings.Capacity() == 4);
+    for (int i = 0; i < 4; ++i) strings.PushBack("a heap string, longer than inline");
+    REQUIRE(strings.IsInline());
+    strings.EmplaceBack("fifth");
+    REQUIRE_FALSE(strings.IsInline());
+    REQUIRE(strings.Size() == 5);
+    REQUIRE(strings.Capacity() >= 5);
+    REQUIRE(strings[0] == "a heap string, longer than inline");
+    REQUIRE(strings.Back() == "fifth");
+    strings.PopBack();
+    strings.ShrinkToFit();
+    REQUIRE(strings.IsInline());
+    REQUIRE(strings[3] == "a heap string, longer than inline");
+    REQUIRE_THROWS_AS(strings.At(4), std::out_of_range);
+    strings.Resize(10, "x");
+    REQUIRE(strings.Size() == 10);
+    REQUIRE(strings[9] == "x");
+    strings.Resize(2);
+    REQUIRE(strings.Size() == 2);
+    strings.Clear();
+    REQUIRE(strings.Empty());
+  }
+
+  SECTION("Copy, move and swap, inline and on the heap") {
+    for (size_t count : {size_t(2), size_t(10)}) {
+      SmallVector<std::string, 4> original;
+      for (size_t i = 0; i < count; ++i) original.PushBack(std::to_string(i));
+      SmallVector<std::string, 4> copy = original;
+      REQUIRE(copy.Size() == count);
+      REQUIRE(std::equal(copy.begin(), copy.end(), original.begin(), original.end()));
+      SmallVector<std::string, 4> moved = std::move(copy);
+      REQUIRE(copy.Empty());
+      REQUIRE(copy.IsInline());
+      REQUIRE(moved.Size() == count);
+      SmallVector<std::string, 4> other {"only"};
+      other.Swap(moved);
+      REQUIRE(other.Size() == count);
+      REQUIRE(moved.Size() == 1);
+      REQUIRE(moved[0] == "only");
+      moved = other;
+      REQUIRE(moved.Size() == count);
+      REQUIRE(moved[count - 1] == other[count - 1]);
+      other = std::move(moved);
+      REQUIRE(other.Size() == count);
+      moved = other;
+      moved = std::move(moved);
+      REQUIRE(moved.Size() == count);
+    }
+  }
+
+  SECTION("Constructors, algorithms and elements of itself") {
+    SmallVector<int, 8> numbers(5, 7);
+    REQUIRE(numbers.Size() == 5);
+    SmallVector<int, 8> sized(3);
+    REQUIRE(sized[2] == 0);
+    std::vector<int> source {5, 3, 9, 1};
+    SmallVector<int, 2> sorted(source.begin(), source.end());
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(sorted[0] == 1);
+    REQUIRE(*sorted.rbegin() == 9);
+    for (int i = 0; i < 20; ++i) sorted.PushBack(sorted.Back());
+    REQUIRE(sorted.Size() == 24);
+    REQUIRE(sorted[23] == 9);
+    SmallVector<Tracked<false>, 2> tracked;
+    for (int i = 0; i < 10; ++i) tracked.EmplaceBack(i);
+    REQUIRE(tracked[9].value == 9);
+  }
+
+  SECTION("Heap buffers are aligned and sized safely") {
+    struct alignas(64) Wide {
+      explicit Wide(int v) : value(v) {}
+      int value;
+    };
+    SmallVector<Wide, 2> wide;
+    for (int i = 0; i < 5; ++i) {
+      wide.EmplaceBack(i);
+      REQUIRE(reinterpret_cast<std::uintptr_t>(wide.Data()) % 64 == 0);
+    }
+    REQUIRE_FALSE(wide.IsInline());
+    wide.ShrinkToFit();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(wide.Data()) % 64 == 0);
+    REQUIRE(wide[4].value == 4);
+
+    SmallVector<int, 4> numbers {1, 2};
+    REQUIRE_THROWS_AS(numbers.Reserve(std::numeric_limits<size_t>::max() / 2), std::bad_alloc);
+    REQUIRE(numbers.Size() == 2);
+    REQUIRE(numbers.IsInline());
+  }
+}
+
+TEST_CASE("SmallVector ranges", "[SmallVector]") {
+  SECTION("Insert, Erase, Append and Assign, inline and on the heap") {
+    SmallVector<int, 6> numbers {1, 2};
+    std::vector<int> source {7, 8, 9};
+    REQUIRE(*numbers.Insert(numbers.begin() + 1, source.begin(), source.end()) == 7);
+    REQUIRE(Values(numbers) == std::vector<int> {1, 7, 8, 9, 2});
+    REQUIRE(numbers.IsInline());
+    numbers.Insert(numbers.begin(), 3, 0);
+    REQUIRE_FALSE(numbers.IsInline());
+    REQUIRE(numbers.Capacity() == 12);
+    REQUIRE(Values(numbers) == std::vector<int> {0, 0, 0, 1, 7, 8, 9, 2});
+    REQUIRE(*numbers.Erase(numbers.begin() + 1, numbers.begin() + 5) == 8);
+    REQUIRE(Values(numbers) == std::vector<int> {0, 8, 9, 2});
+    numbers.Erase(numbers.end() - 1);
+    numbers.Append(std::views::iota(0, 3));
+    // Forward only in the C++20 sense: its iterator_category is input_iterator_tag.
+    numbers.Append(std::views::iota(0, 2) | std::views::transform([](int i) { return i * 10; }));
+    REQUIRE(numbers.Back() == 10);
+    numbers.Erase(numbers.end() - 2, numbers.end());
+    REQUIRE(Values(numbers) == std::vector<int> {0, 8, 9, 0, 1, 2});
+    numbers.ShrinkToFit();
+    REQUIRE(numbers.IsInline());
+    numbers.Assign(source);
+    REQUIRE(Values(numbers) == source);
+    REQUIRE(numbers.IsInline());
+    numbers.Assign(std::vector<int>(100, 4));
+    REQUIRE(numbers.Size() == 100);
+    REQUIRE(numbers[99] == 4);
+    numbers.Assign(std::vector<int> {5});
+    REQUIRE(Values(numbers) == std::vector<int> {5});
+    numbers.Insert(numbers.end(), 0, 1);
+    numbers.Erase(numbers.begin(), numbers.begin());
+    REQUIRE(numbers.Size() == 1);
+  }
+
+  SECTION("Elements of the vector itself") {
+    SmallVector<int, 4> numbers {1, 2, 3};
+    numbers.Insert(numbers.begin() + 1, numbers.begin(), numbers.end());
+    REQUIRE(Values(numbers) == std::vector<int> {1, 1, 2, 3, 2, 3});
+    numbers.Insert(numbers.begin(), 2, numbers[3]);
+    REQUIRE(Values(numbers) == std::vector<int> {3, 3, 1, 1, 2, 3, 2, 3});
+    numbers.Assign(numbers);
+    REQUIRE(numbers.Size() == 8);
+
+    SmallVector<std::string, 4> strings;
+    strings.PushBack("a string long enough for the heap");
+    strings.PushBack("b");
+    strings.Insert(strings.begin(), strings.begin(), strings.end());
+    REQUIRE(strings.IsInline());
+    strings.Insert(strings.begin() + 1, 3, strings[3]);
+    REQUIRE(strings.Size() == 7);
+    REQUIRE(strings[0] == "a string long enough for the heap");
+    REQUIRE(strings[1] == "b");
+    REQUIRE(strings[3] == "b");
+    REQUIRE(strings[5] == "a string long enough for the heap");
+    strings.Erase(strings.begin(), strings.begin() + 4);
+    REQUIRE(strings.Size() == 3);
+    REQUIRE(strings[1] == "a string long enough for the heap");
+    strings.Assign(std::vector<std::string> {"x", "y"});
+    REQUIRE(strings.Size() == 2);
+    REQUIRE(strings[1] == "y");
+  }
+
+  SECTION("Single-pass input") {
+    std::istringstream input("4 5 6");
+    SmallVector<int, 2> numbers {1, 2};
+    numbers.Insert(numbers.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+    REQUIRE(Values(numbers) == std::vector<int> {1, 4, 5, 6, 2});
+  }
+
+  SECTION("Strong exception guarantee") {
+    CheckStrongGuarantee<16>();
+    CheckStrongGuarantee<5>();
+    SmallVector<Tracked<false>, 8> tracked;
+    for (int i = 0; i < 4; ++i) tracked.EmplaceBack(i);
+    tracked.Insert(tracked.begin() + 1, 2, Tracked<false>(9));
+    tracked.Erase(tracked.begin());
+    REQUIRE(Values(tracked) == std::vector<int> {9, 9, 1, 2, 3});
+  }
+}
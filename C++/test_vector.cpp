@@ -0,0 +1,460 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "vector.cpp"
+
+namespace {
+
+// Owns its text through a pointer, so moving it by copying its bytes is fine: it opts in to
+// IsTriviallyRelocatable below, and Vector moves it with memcpy.
+struct Boxed {
+  explicit Boxed(std::string text) : Text(std::make_unique<std::string>(std::move(text))) {}
+  Boxed(const Boxed& other) : Text(std::make_unique<std::string>(*other.Text)) {}
+  Boxed(Boxed&&) noexcept = default;
+
+  std::unique_ptr<std::string> Text;
+};
+
+// Counts live objects and how they were made; moves may be declared to throw.
+template <bool NothrowMove>
+struct Tracked {
+  static inline int alive = 0;
+  static inline int copies = 0;
+  static inline int moves = 0;
+  int value;
+
+  explicit Tracked(int v) : value(v) { ++alive; }
+  Tracked(const Tracked& other) : value(other.value) {
+    ++alive;
+    ++copies;
+  }
+  Tracked(Tracked&& other) noexcept(NothrowMove) : value(other.value) {
+    other.value = -1;
+    ++alive;
+    ++moves;
+  }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { --alive; }
+};
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Boxed> : std::true_type {};
+
+TEST_CASE("Vector relocation", "[Vector]") {
+  static_assert(IsTriviallyRelocatable<int>::value);
+  static_assert(IsTriviallyRelocatable<Boxed>::value);
+  static_assert(!IsTriviallyRelocatable<std::string>::value);
+  static_assert(!IsTriviallyRelocatable<Tracked<true>>::value);
+
+  SECTION("Elements keep their contents, moved and relocated") {
+    Vector<std::string> strings;
+    Vector<Boxed> boxes;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+      expected.push_back(std::string(i % 40, static_cast<char>('a' + i % 26)));
+      strings.PushBack(expected.back());
+      boxes.EmplaceBack(expected.back());
+    }
+    strings.Reserve(5000);
+    strings.ShrinkToFit();
+    strings.Resize(1200, "filler, longer than the inline buffer");
+    boxes.Reserve(5000);
+    boxes.ShrinkToFit();
+    boxes.Resize(1200, Boxed("filler"));
+    REQUIRE(strings.Size() == 1200);
+    REQUIRE(boxes.Size() == 1200);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      REQUIRE(strings[i] == expected[i]);
+      REQUIRE(*boxes[i].Text == expected[i]);
+    }
+    REQUIRE(strings[1199] == "filler, longer than the inline buffer");
+    REQUIRE(*boxes[1199].Text == "filler");
+  }
+
+  SECTION("Nothrow moves move, throwing ones copy") {
+    {
+      Vector<Tracked<true>> moved;
+      for (int i = 0; i < 100; ++i) moved.EmplaceBack(i);
+      REQUIRE(Tracked<true>::copies == 0);
+      REQUIRE(Tracked<true>::moves > 0);
+      REQUIRE(Tracked<true>::alive == 100);
+      for (int i = 0; i < 100; ++i) REQUIRE(moved[i].value == i);
+      Vector<Tracked<false>> copied;
+      for (int i = 0; i < 100; ++i) copied.EmplaceBack(i);
+      REQUIRE(Tracked<false>::moves == 0);
+      REQUIRE(Tracked<false>::copies > 0);
+      REQUIRE(Tracked<false>::alive == 100);
+    }
+    REQUIRE(Tracked<true>::alive == 0);
+    REQUIRE(Tracked<false>::alive == 0);
+  }
+
+  SECTION("No default constructor needed") {
+    Vector<Tracked<true>> values;
+    values.Reserve(10);
+    values.EmplaceBack(1);
+    values.Reserve(100);
+    values.ShrinkToFit();
+    REQUIRE(values.Capacity() == 1);
+    REQUIRE(values[0].value == 1);
+  }
+
+  SECTION("Pushing an element of the vector while it grows") {
+    Vector<std::string> strings;
+    strings.PushBack("an element on the heap, not inline");
+    for (int i = 0; i < 100; ++i) {
+      strings.ShrinkToFit();
+      strings.PushBack(strings[0]);
+    }
+    REQUIRE(strings.Size() == 101);
+    REQUIRE(strings[100] == strings[0]);
+    Vector<int> numbers {7};
+    for (int i = 0; i < 20; ++i) numbers.PushBack(numbers.Back());
+    REQUIRE(numbers[20] == 7);
+  }
+}
+
+TEST_CASE("Vector iterators", "[Vector]") {
+  static_assert(std::contiguous_iterator<Vector<int>::Iterator>);
+  static_assert(std::contiguous_iterator<Vector<std::string>::ConstIterator>);
+  static_assert(std::ranges::contiguous_range<Vector<int>>);
+  static_assert(std::ranges::contiguous_range<const Vector<std::string>>);
+
+  Vector<int> numbers;
+  for (int i = 0; i < 1000; ++i) numbers.PushBack((i * 7919) % 1000);
+  std::sort(numbers.begin(), numbers.end());
+  for (int i = 0; i < 1000; ++i) REQUIRE(numbers[i] == i);
+  REQUIRE(*std::lower_bound(numbers.begin(), numbers.end(), 500) == 500);
+  REQUIRE(std::ranges::find(numbers, 42) - numbers.begin() == 42);
+  REQUIRE(std::to_address(numbers.begin()) == numbers.Data());
+  REQUIRE(std::ranges::data(numbers) == numbers.Data());
+
+  auto it = numbers.begin();
+  REQUIRE(it[10] == 10);
+  REQUIRE(*(it + 5) == 5);
+  REQUIRE(*(5 + it) == 5);
+  REQUIRE(*it == 0);  // + does not move it
+  REQUIRE(*it++ == 0);
+  REQUIRE(*it == 1);
+  it += 10;
+  REQUIRE(*it-- == 11);
+  REQUIRE(numbers.end() - numbers.begin() == 1000);
+  REQUIRE(numbers.begin() < numbers.end());
+  Vector<int>::ConstIterator first = numbers.begin();
+  REQUIRE(first == numbers.cbegin());
+  REQUIRE(numbers.cend() - first == 1000);
+
+  std::ranges::reverse(numbers);
+  REQUIRE(numbers.Front() == 999);
+  REQUIRE(*numbers.rbegin() == 0);
+  Vector<int> copy(numbers.begin(), numbers.end());
+  REQUIRE(std::equal(copy.begin(), copy.end(), numbers.cbegin(), numbers.cend()));
+  std::copy(numbers.begin(), numbers.begin() + 10, copy.begin() + 500);
+  REQUIRE(copy[505] == 994);
+
+  Vector<std::string> words {"pear", "apple", "fig"};
+  std::ranges::sort(words);
+  REQUIRE(words[0] == "apple");
+  REQUIRE(words[2] == "pear");
+}
+
+namespace {
+
+// Copies throw once countdown reaches zero; a negative countdown never throws. Fragile<true> is
+// declared trivially relocatable below, so that Vector moves it with memmove.
+template <bool Relocatable>
+struct Fragile {
+  static inline int countdown = -1;
+  static inline int alive = 0;
+  int value;
+
+  explicit Fragile(int v) : value(v) { ++alive; }
+  Fragile(const Fragile& other) : value(other.value) {
+    if (countdown == 0) throw std::runtime_error("copy failed");
+    if (countdown > 0) --countdown;
+    ++alive;
+  }
+  Fragile& operator=(const Fragile&) = default;
+  ~Fragile() { --alive; }
+};
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Fragile<true>> : std::true_type {};
+
+namespace {
+
+template <typename T>
+std::vector<int> Values(const Vector<T>& vector) {
+  std::vector<int> values;
+  for (const T& item : vector) {
+    if constexpr (std::is_same_v<T, int>)
+      values.push_back(item);
+    else
+      values.push_back(item.value);
+  }
+  return values;
+}
+
+// Every copy in turn throws, inserting in place and into a new buffer: the vector is unchanged.
+template <bool Relocatable>
+void CheckStrongGuarantee() {
+  using Item = Fragile<Relocatable>;
+  {
+    Vector<Item> values;
+    values.Reserve(10);
+    for (int i = 0; i < 5; ++i) values.EmplaceBack(i);
+    std::vector<Item> source;
+    for (int i = 10; i < 14; ++i) source.emplace_back(i);
+    std::vector<int> before = Values(values);
+    for (int extra : {0, 6}) {
+      for (int i = 0; i < extra; ++i) source.emplace_back(20 + i);
+      // Fails at each copy in turn until one that makes no more copies than countdown succeeds.
+      auto check = [&](auto insert) {
+        for (int countdown = 0;; ++countdown) {
+          Item::countdown = countdown;
+          try {
+            insert();
+          } catch (const std::runtime_error&) {
+            Item::countdown = -1;
+            REQUIRE(Values(values) == before);
+            continue;
+          }
+          Item::countdown = -1;
+          REQUIRE(countdown >= static_cast<int>(source.size()));
+          values.Erase(values.begin() + 2, values.begin() + 2 + source.size());
+          REQUIRE(Values(values) == before);
+          return;
+        }
+      };
+      check([&] { values.Insert(values.begin() + 2, source.begin(), source.end()); });
+      check([&] { values.Insert(values.begin() + 2, source.size(), values[0]); });
+      source.resize(4, Item(0));
+    }
+    values.Insert(values.begin() + 2, source.begin(), source.end());
+    REQUIRE(Values(values) == std::vector<int> {0, 1, 10, 11, 12, 13, 2, 3, 4});
+    Item::countdown = 0;
+    REQUIRE_THROWS_AS(values.Assign(source), std::runtime_error);
+    Item::countdown = -1;
+    REQUIRE(values.Size() == 9);
+  }
+  REQUIRE(Item::alive == 0);
+}
+
+}  // namespace
+
+TEST_CASE("Vector ranges", "[Vector]") {
+  SECTION("Insert, Erase, Append and Assign of ints") {
+    Vector<int> numbers {1, 2, 3};
+    std::vector<int> source {7, 8, 9};
+    REQUIRE(*numbers.Insert(numbers.begin() + 1, source.begin(), source.end()) == 7);
+    REQUIRE(Values(numbers) == std::vector<int> {1, 7, 8, 9, 2, 3});
+    numbers.Reserve(100);
+    numbers.Insert(numbers.begin(), 2, 0);
+    REQUIRE(Values(numbers) == std::vector<int> {0, 0, 1, 7, 8, 9, 2, 3});
+    REQUIRE(*numbers.Erase(numbers.begin() + 1, numbers.begin() + 4) == 8);
+    REQUIRE(Values(numbers) == std::vector<int> {0, 8, 9, 2, 3});
+    numbers.Erase(numbers.end() - 1);
+    numbers.Append(source);
+    REQUIRE(Values(numbers) == std::vector<int> {0, 8, 9, 2, 7, 8, 9});
+    numbers.Append(std::views::iota(0, 3));
+    // Forward only in the C++20 sense: its iterator_category is input_iterator_tag.
+    numbers.Append(std::views::iota(0, 2) | std::views::transform([](int i) { return i * 10; }));
+    REQUIRE(numbers.Back() == 10);
+    numbers.Erase(numbers.end() - 2, numbers.end());
+    REQUIRE(numbers.Size() == 10);
+    REQUIRE(numbers.Back() == 2);
+    size_t capacity = numbers.Capacity();
+    numbers.Assign(source);
+    REQUIRE(Values(numbers) == source);
+    REQUIRE(numbers.Capacity() == capacity);
+    numbers.Assign(std::vector<int>(1000, 4));
+    REQUIRE(numbers.Size() == 1000);
+    REQUIRE(numbers[999] == 4);
+    numbers.Insert(numbers.end(), 0, 1);
+    numbers.Erase(numbers.begin(), numbers.begin());
+    REQUIRE(numbers.Size() == 1000);
+  }
+
+  SECTION("Grows once") {
+    Vector<int> numbers {1};
+    std::vector<int> source(1000, 5);
+    numbers.Insert(numbers.begin(), source.begin(), source.end());
+    REQUIRE(numbers.Capacity() == 1001);
+    REQUIRE(numbers.Back() == 1);
+    numbers.Insert(numbers.begin() + 1, 1, 6);
+    REQUIRE(numbers.Capacity() == 2003);
+    REQUIRE(numbers[1] == 6);
+  }
+
+  SECTION("Elements of the vector itself") {
+    Vector<int> numbers {1, 2, 3};
+    numbers.Insert(numbers.begin() + 1, numbers.begin(), numbers.end());
+    REQUIRE(Values(numbers) == std::vector<int> {1, 1, 2, 3, 2, 3});
+    numbers.Reserve(100);
+    numbers.Insert(numbers.begin(), numbers.begin() + 3, numbers.end());
+    REQUIRE(Values(numbers) == std::vector<int> {3, 2, 3, 1, 1, 2, 3, 2, 3});
+    numbers.Insert(numbers.begin(), 2, numbers[3]);
+    REQUIRE(Values(numbers) == std::vector<int> {1, 1, 3, 2, 3, 1, 1, 2, 3, 2, 3});
+    numbers.Insert(numbers.begin(), numbers.rbegin(), numbers.rbegin() + 2);
+    REQUIRE(numbers[0] == 3);
+    REQUIRE(numbers[1] == 2);
+    numbers.Assign(numbers);
+    REQUIRE(numbers.Size() == 13);
+    numbers.Assign(std::span<const int>(numbers.Data() + 1, 2));
+    REQUIRE(Values(numbers) == std::vector<int> {2, 1});
+
+    Vector<std::string> strings;
+    strings.PushBack("a string long enough for the heap");
+    strings.PushBack("b");
+    strings.Insert(strings.begin(), strings.begin(), strings.end());
+    strings.Insert(strings.begin() + 1, 3, strings[3]);
+    REQUIRE(strings.Size() == 7);
+    REQUIRE(strings[0] == "a string long enough for the heap");
+    REQUIRE(strings[1] == "b");
+    REQUIRE(strings[3] == "b");
+    REQUIRE(strings[5] == "a string long enough for the heap");
+    strings.Erase(strings.begin(), strings.begin() + 4);
+    REQUIRE(strings.Size() == 3);
+    REQUIRE(strings[1] == "a string long enough for the heap");
+  }
+
+  SECTION("Single-pass input") {
+    std::istringstream input("4 5 6");
+    Vector<int> numbers {1, 2};
+    numbers.Insert(numbers.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+    REQUIRE(Values(numbers) == std::vector<int> {1, 4, 5, 6, 2});
+  }
+
+  SECTION("Strong exception guarantee") {
+    CheckStrongGuarantee<false>();
+    CheckStrongGuarantee<true>();
+    Vector<Tracked<false>> tracked;
+    for (int i = 0; i < 4; ++i) tracked.EmplaceBack(i);
+    tracked.Insert(tracked.begin() + 1, 2, Tracked<false>(9));
+    tracked.Erase(tracked.begin());
+    REQUIRE(Values(tracked) == std::vector<int> {9, 9, 1, 2, 3});
+  }
+}
+
+namespace {
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t Allocations = 0;
+  std::size_t Deallocations = 0;
+  std::size_t BytesInUse = 0;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++Allocations;
+    BytesInUse += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+    ++Deallocations;
+    BytesInUse -= bytes;
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+}  // namespace
+
+TEST_CASE("PmrVector", "[Vector]") {
+  static_assert(sizeof(Vector<int>) == 3 * sizeof(void*));
+  static_assert(std::is_same_v<Vector<int>::AllocatorType, std::allocator<int>>);
+
+  CountingResource resource;
+  {
+    PmrVector<int> numbers(&resource);
+    REQUIRE(numbers.GetAllocator().resource() == &resource);
+    REQUIRE(resource.Allocations == 0);
+
+    // Every way of growing goes through the resource, with the sizes it was given.
+    for (int i = 0; i < 100; ++i) numbers.PushBack(i);
+    const std::size_t after_push = resource.Allocations;
+    REQUIRE(after_push > 0);
+    numbers.Reserve(1000);
+    REQUIRE(resource.Allocations == after_push + 1);
+    numbers.Resize(2000, 7);
+    numbers.Insert(numbers.begin(), 5000, 1);
+    numbers.Erase(numbers.begin(), numbers.begin() + 6000);
+    numbers.ShrinkToFit();
+    REQUIRE(resource.BytesInUse == numbers.Size() * sizeof(int));
+    numbers.Clear();
+    numbers.ShrinkToFit();
+    REQUIRE(resource.BytesInUse == 0);
+    numbers.Assign(std::vector<int> {1, 2, 3});
+    REQUIRE(resource.BytesInUse == 3 * sizeof(int));
+
+    // A copy does not inherit the resource; a copy with an allocator uses the given one.
+    PmrVector<int> copy = numbers;
+    REQUIRE(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+    PmrVector<int> copy_here(numbers, &resource);
+    REQUIRE(resource.BytesInUse == 6 * sizeof(int));
+    copy_here = copy;
+    REQUIRE(copy_here.GetAllocator().resource() == &resource);
+
+    // Moving between equal resources hands the buffer over, between different ones it moves
+    // the elements.
+    const int* data = numbers.Data();
+    PmrVector<int> moved(std::move(numbers));
+    REQUIRE(moved.Data() == data);
+    REQUIRE(moved.GetAllocator().resource() == &resource);
+    PmrVector<int> other(&resource);
+    other = std::move(moved);
+    REQUIRE(other.Data() == data);
+    copy = std::move(other);
+    REQUIRE(copy.Data() != data);
+    REQUIRE(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(copy.Size() == 3);
+    PmrVector<int> elsewhere(std::move(copy), &resource);
+    REQUIRE(elsewhere.GetAllocator().resource() == &resource);
+    REQUIRE(elsewhere[2] == 3);
+    elsewhere.Swap(copy_here);
+    REQUIRE(elsewhere.Size() == 3);
+
+    // Into a different resource each element is moved once, straight into an exact buffer.
+    PmrVector<Tracked<true>> tracked(&resource);
+    for (int i = 0; i < 5; ++i) tracked.EmplaceBack(i);
+    Tracked<true>::moves = 0;
+    Tracked<true>::copies = 0;
+    CountingResource target;
+    PmrVector<Tracked<true>> relocated(std::move(tracked), &target);
+    REQUIRE(Tracked<true>::moves == 5);
+    REQUIRE(Tracked<true>::copies == 0);
+    REQUIRE(target.Allocations == 1);
+    REQUIRE(relocated.Capacity() == 5);
+    REQUIRE(relocated[4].value == 4);
+    REQUIRE(tracked.Empty());
+    REQUIRE(Tracked<true>::alive == 5);
+
+    PmrVector<std::string> strings(&resource);
+    strings.PushBack(std::string(100, 's'));
+    strings.Insert(strings.begin(), 3, strings[0]);
+    REQUIRE(strings.Size() == 4);
+    REQUIRE(strings[3].size() == 100);
+  }
+  REQUIRE(resource.BytesInUse == 0);
+  REQUIRE(resource.Allocations == resource.Deallocations);
+
+  // Dropping the arena frees everything at once.
+  std::pmr::monotonic_buffer_resource arena;
+  PmrVector<std::string> words(&arena);
+  for (int i = 0; i < 1000; ++i) words.EmplaceBack("word");
+  REQUIRE(words.Size() == 1000);
+  REQUIRE(words[999] == "word");
+}
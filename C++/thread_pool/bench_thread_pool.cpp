@@ -0,0 +1,86 @@
+// Benchmarks for ThreadPool and the parallel algorithms. Build with optimizations, for example
+//   g++ -std=c++20 -O2 bench_thread_pool.cpp thread_pool.cpp -o bench_thread_pool
+// and run ./bench_thread_pool.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include "thread_pool.hpp"
+#include "parallel.hpp"
+
+namespace {
+
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+std::mt19937_64& Rng() {
+  static std::mt19937_64 rng(42);
+  return rng;
+}
+
+// Best of three runs of run() after prepare(), which is not timed; prints the time per element
+// and the speedup over baseline seconds (the first thread count's when baseline is 0).
+template <typename Prepare, typename Run>
+double MeasureScaling(const char* name, size_t size, double baseline, Prepare prepare, Run run) {
+  double best = 0;
+  for (int attempt = 0; attempt < 3; ++attempt) {
+    prepare();
+    auto start = std::chrono::steady_clock::now();
+    run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (attempt == 0 || seconds < best) best = seconds;
+  }
+  std::printf("%-48s %12.2f ns/op %10.1f ms %6.2fx\n", name, best * 1e9 / size, best * 1e3,
+              baseline == 0 ? 1.0 : baseline / best);
+  return best;
+}
+
+// 10 million elements on 1, 2, 4, ... threads, up to the hardware threads and at least 4; beyond
+// the hardware threads they share cores, which shows the overhead rather than a speedup.
+void BenchParallel() {
+  const size_t kSize = 10'000'000;
+  Vector<int> source(kSize);
+  for (auto& value : source) value = static_cast<int>(Rng()());
+  Vector<int> values;
+  Vector<int64_t> wide;
+  const size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  std::printf("hardware threads: %zu\n", hardware);
+
+  double sort_baseline = MeasureScaling("parallel/sort/std::sort", kSize, 0, [&] { values = source; },
+                                        [&] { std::sort(values.begin(), values.end()); });
+  double baselines[4] = {0, 0, 0, sort_baseline};
+  for (size_t threads = 1; threads <= std::max<size_t>(hardware, 4); threads *= 2) {
+    ThreadPool pool(threads);
+    char name[64];
+    std::snprintf(name, sizeof(name), "parallel/for/%zu-threads", threads);
+    double seconds = MeasureScaling(name, kSize, baselines[0], [&] { values = source; }, [&] {
+      ParallelFor(values, [](int& value) { value = value * 3 + 1; }, 0, pool);
+    });
+    if (baselines[0] == 0) baselines[0] = seconds;
+    std::snprintf(name, sizeof(name), "parallel/transform/%zu-threads", threads);
+    seconds = MeasureScaling(name, kSize, baselines[1], [] {}, [&] {
+      ParallelTransform(source, wide, [](int value) { return int64_t(value) * value; }, pool);
+    });
+    if (baselines[1] == 0) baselines[1] = seconds;
+    std::snprintf(name, sizeof(name), "parallel/reduce/%zu-threads", threads);
+    seconds = MeasureScaling(name, kSize, baselines[2], [] {}, [&] {
+      DoNotOptimize(ParallelReduce(wide, int64_t(0), std::plus<>(), pool));
+    });
+    if (baselines[2] == 0) baselines[2] = seconds;
+    std::snprintf(name, sizeof(name), "parallel/sort/%zu-threads", threads);
+    MeasureScaling(name, kSize, baselines[3], [&] { values = source; }, [&] {
+      ParallelSort(values, std::less<>(), pool);
+    });
+  }
+}
+
+}  // namespace
+
+int main() {
+  BenchParallel();
+  return 0;
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "../vector.cpp"
+#include "thread_pool.hpp"
+
+namespace parallel_detail {
+
+// Fewer elements per step than this cost more in task overhead than a cheap body saves.
+inline constexpr size_t MinGrain = 1024;
+// Below this many elements ParallelSort is std::sort.
+inline constexpr size_t ParallelSortMin = size_t(1) << 15;
+// Each merge round is cut into this many pieces per thread, so that stealing can even them out.
+inline constexpr size_t PiecesPerThread = 4;
+
+// grain, or about eight steps per thread and at least MinGrain elements each for 0.
+inline size_t Grain(size_t size, size_t grain, const ThreadPool& pool) {
+	return grain != 0 ? grain : std::max(size / (8 * pool.Threads()), MinGrain);
+}
+
+// Output positions [Begin, End) of the merge of the sorted runs [First, Middle) and [Middle, Last),
+// of which the elements [ABegin, AEnd) of the first run are a part.
+struct MergePiece {
+	size_t First, Middle, Last;
+	size_t Begin, End;
+	size_t ABegin, AEnd;
+};
+
+// How many of the first k elements of merge(a, b) come from a; a goes first among equal ones, as
+// in std::merge. Binary search over the split of k between the two runs (merge path).
+template <typename T, typename Compare>
+size_t CoRank(size_t k, const T *a, size_t na, const T *b, size_t nb, Compare& comp) {
+	size_t low = k > nb ? k - nb : 0, high = std::min(k, na);
+	while (low < high) {
+		size_t i = low + (high - low) / 2;
+		// i < high <= k, so b[k - i - 1] exists; a[i] goes before it unless b's element is smaller.
+		if (comp(b[k - i - 1], a[i]))
+			high = i;
+		else
+			low = i + 1;
+	}
+	return low;
+}
+
+template <typename T, typename Compare>
+void Split(const T *from, MergePiece& piece, Compare& comp) {
+	const T *a = from + piece.First, *b = from + piece.Middle;
+	size_t na = piece.Middle - piece.First, nb = piece.Last - piece.Middle;
+	piece.ABegin = CoRank(piece.Begin - piece.First, a, na, b, nb, comp);
+	piece.AEnd = CoRank(piece.End - piece.First, a, na, b, nb, comp);
+}
+
+// Construct = true for the first round, whose output is raw memory: the elements are
+// move-constructed there, and those of the piece are destroyed again if one throws.
+template <bool Construct, typename T, typename Compare>
+void Merge(T *from, T *to, const MergePiece& piece, Compare& comp) {
+	T *a = from + piece.First, *b = from + piece.Middle;
+	size_t begin = piece.Begin - piece.First, end = piece.End - piece.First;
+	if constexpr (!Construct) {
+		std::merge(std::make_move_iterator(a + piece.ABegin), std::make_move_iterator(a + piece.AEnd),
+			std::make_move_iterator(b + begin - piece.ABegin), std::make_move_iterator(b + end - piece.AEnd), to + piece.Begin, comp);
+	} else {
+		T *a_end = a + piece.AEnd, *b_end = b + end - piece.AEnd;
+		a += piece.ABegin;
+		b += begin - piece.ABegin;
+		T *out = to + piece.Begin;
+		try {
+			for (; a != a_end && b != b_end; ++out) new(out) T(std::move(comp(*b, *a) ? *b++ : *a++));
+			for (; a != a_end; ++out) new(out) T(std::move(*a++));
+			for (; b != b_end; ++out) new(out) T(std::move(*b++));
+		} catch (...) {
+			std::destroy(to + piece.Begin, out);
+			throw;
+		}
+	}
+}
+
+// Merge scratch space of size elements of allocator, left raw until the first round builds it.
+template <typename T, typename Allocator>
+struct MergeBuffer {
+	using Traits = std::allocator_traits<Allocator>;
+
+	Allocator Alloc;
+	size_t Size;
+	T *Data;
+	bool Built = false;
+
+	MergeBuffer(const Allocator& alloc, size_t size) : Alloc(alloc), Size(size), Data(Traits::allocate(Alloc, size)) {};
+	MergeBuffer(const MergeBuffer&) = delete;
+	MergeBuffer& operator= (const MergeBuffer&) = delete;
+	~MergeBuffer() {
+		if (Built) std::destroy(Data, Data + Size);
+		Traits::deallocate(Alloc, Data, Size);
+	};
+};
+
+}  // namespace parallel_detail
+
+// The algorithms below split their range over a ThreadPool, ThreadPool::Default() unless one is
+// given, and return when it is done; an exception from the body or the operation is rethrown.
+// grain = 0 picks the number of elements per step from the size and the number of threads, at
+// least 1024, which suits cheap bodies; expensive ones can pass a smaller grain down to 1.
+
+// Calls body(i) for every i in [0, size).
+template <typename Body>
+void ParallelFor(size_t size, Body body, size_t grain = 0, ThreadPool& pool = ThreadPool::Default()) {
+	pool.ForRange(size, parallel_detail::Grain(size, grain, pool), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) body(i);
+	});
+}
+
+// Calls body(value) for every element.
+template <typename T, typename Allocator, typename Body>
+void ParallelFor(Vector<T, Allocator>& values, Body body, size_t grain = 0, ThreadPool& pool = ThreadPool::Default()) {
+	T *data = values.Data();
+	pool.ForRange(values.Size(), parallel_detail::Grain(values.Size(), grain, pool), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) body(data[i]);
+	});
+}
+
+// output[i] = op(input[i]); output is replaced by input.Size() elements, each constructed from
+// op's result in place, and may be input itself (it is then assigned element by element). If op
+// throws, output is left empty.
+template <typename T, typename A, typename U, typename B, typename Op>
+void ParallelTransform(const Vector<T, A>& input, Vector<U, B>& output, Op op, ThreadPool& pool = ThreadPool::Default()) {
+	size_t size = input.Size(), grain = parallel_detail::Grain(size, 0, pool);
+	const T *in = input.Data();
+	if (static_cast<const void*>(&input) == static_cast<const void*>(&output)) {
+		U *out = output.Data();
+		pool.ForRange(size, grain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) out[i] = op(in[i]);
+		});
+		return;
+	}
+	output.Clear();
+	output.AppendWith(size, [&](U *out) {
+		// Each range destroys its own elements if op throws; the finished ones are undone here.
+		Vector<std::pair<size_t, size_t>> built;
+		std::mutex mutex;
+		try {
+			pool.ForRange(size, grain, [&](size_t begin, size_t end) {
+				size_t i = begin;
+				try {
+					for (; i < end; ++i) new(out + i) U(op(in[i]));
+				} catch (...) {
+					std::destroy(out + begin, out + i);
+					throw;
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				built.PushBack({begin, end});
+			});
+		} catch (...) {
+			for (auto [begin, end] : built) std::destroy(out + begin, out + end);
+			throw;
+		}
+	});
+}
+
+// init combined with every element by op, as std::reduce does: op has to be associative and
+// commutative, since each thread folds the ranges it runs and the partial results are combined
+// in the order they finish. That order, and where the ranges are cut, changes from run to run,
+// so a floating-point sum can differ in its last bits between two calls on the same values.
+template <typename T, typename Allocator, typename U, typename Op = std::plus<>>
+U ParallelReduce(const Vector<T, Allocator>& values, U init, Op op = Op(), ThreadPool& pool = ThreadPool::Default()) {
+	const T *data = values.Data();
+	std::mutex mutex;
+	U total = std::move(init);
+	pool.ForRange(values.Size(), parallel_detail::Grain(values.Size(), 0, pool), [&](size_t begin, size_t end) {
+		U partial = data[begin];
+		for (size_t i = begin + 1; i < end; ++i) partial = op(std::move(partial), data[i]);
+		std::lock_guard<std::mutex> lock(mutex);
+		total = op(std::move(total), std::move(partial));
+	});
+	return total;
+}
+
+// Sorts values by comp, as std::sort does (not stable). Merge sort: one run per thread is sorted
+// with std::sort, then pairs of runs are merged into a buffer of the same size and back, each
+// round cut into pieces of equal output size by binary search (merge path), so that even the
+// last merge of two halves runs on every thread. The buffer is raw memory that the first round
+// move-constructs the elements into; they are destroyed once the sort is done.
+template <typename T, typename Allocator, typename Compare = std::less<>>
+void ParallelSort(Vector<T, Allocator>& values, Compare comp = Compare(), ThreadPool& pool = ThreadPool::Default()) {
+	using parallel_detail::MergePiece;
+	size_t size = values.Size(), threads = pool.Threads();
+	if (threads == 1 || size < parallel_detail::ParallelSortMin) {
+		std::sort(values.begin(), values.end(), comp);
+		return;
+	}
+
+	size_t runs = threads;
+	Vector<size_t> bounds(runs + 1);
+	for (size_t run = 0; run <= runs; ++run) bounds[run] = size / runs * run + std::min(size % runs, run);
+	T *from = values.Data();
+	pool.ForRange(runs, 1, [&](size_t begin, size_t end) {
+		for (size_t run = begin; run < end; ++run) std::sort(from + bounds[run], from + bounds[run + 1], comp);
+	});
+
+	parallel_detail::MergeBuffer<T, Allocator> buffer(values.GetAllocator(), size);
+	T *to = buffer.Data;
+	Vector<MergePiece> pieces;
+	while (runs > 1) {
+		pieces.Clear();
+		// An odd run out is merged with nothing, that is, moved over.
+		for (size_t run = 0; run < runs; run += 2) {
+			size_t first = bounds[run], middle = bounds[std::min(run + 1, runs)], last = bounds[std::min(run + 2, runs)];
+			size_t parts = std::max<size_t>((last - first) * parallel_detail::PiecesPerThread * threads / size, 1);
+			for (size_t part = 0; part < parts; ++part)
+				pieces.PushBack(MergePiece {first, middle, last,
+					first + (last - first) * part / parts, first + (last - first) * (part + 1) / parts, 0, 0});
+		}
+		// All the splits are found before any piece moves the elements the searches compare.
+		pool.ForRange(pieces.Size(), 1, [&](size_t begin, size_t end) {
+			for (size_t piece = begin; piece < end; ++piece) parallel_detail::Split(from, pieces[piece], comp);
+		});
+		if (buffer.Built) {
+			pool.ForRange(pieces.Size(), 1, [&](size_t begin, size_t end) {
+				for (size_t piece = begin; piece < end; ++piece) parallel_detail::Merge<false>(from, to, pieces[piece], comp);
+			});
+		} else {
+			// Every piece writes its own flag; ForRange returns only after all of them have run.
+			Vector<char> done(pieces.Size());
+			try {
+				pool.ForRange(pieces.Size(), 1, [&](size_t begin, size_t end) {
+					for (size_t piece = begin; piece < end; ++piece) {
+						parallel_detail::Merge<true>(from, to, pieces[piece], comp);
+						done[piece] = 1;
+					}
+				});
+			} catch (...) {
+				for (size_t piece = 0; piece < pieces.Size(); ++piece)
+					if (done[piece]) std::destroy(to + pieces[piece].Begin, to + pieces[piece].End);
+				throw;
+			}
+			buffer.Built = true;
+		}
+		size_t merged = (runs + 1) / 2;
+		for (size_t run = 0; run < merged; ++run) bounds[run] = bounds[2 * run];
+		bounds[merged] = size;
+		runs = merged;
+		std::swap(from, to);
+	}
+	if (from != values.Data()) {
+		T *out = values.Data();
+		pool.ForRange(size, parallel_detail::Grain(size, 0, pool), [&](size_t begin, size_t end) {
+			std::move(from + begin, from + end, out + begin);
+		});
+	}
+}
@@ -0,0 +1,182 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "thread_pool.hpp"
+#include "parallel.hpp"
+
+TEST_CASE("ThreadPool", "[Parallel]") {
+  ThreadPool pool(4);
+  REQUIRE(pool.Threads() == 4);
+
+  SECTION("Every index runs once") {
+    for (size_t grain : {size_t(0), size_t(1), size_t(7), size_t(100000)}) {
+      // Catch assertions are for the test's thread only: the workers count instead.
+      std::vector<std::atomic<int>> hits(100000);
+      std::atomic<int> empty {0};
+      pool.ForRange(hits.size(), grain, [&](size_t begin, size_t end) {
+        empty += begin >= end;
+        for (size_t i = begin; i < end; ++i) ++hits[i];
+      });
+      REQUIRE(empty == 0);
+      for (auto& hit : hits) REQUIRE(hit == 1);
+    }
+    bool ran = false;
+    pool.ForRange(0, 0, [&](size_t, size_t) { ran = true; });
+    REQUIRE(!ran);
+  }
+
+  SECTION("Uneven work and nested calls") {
+    std::atomic<size_t> total {0};
+    pool.ForRange(64, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        // Later indices carry more work, each split again on the same pool.
+        pool.ForRange(i * 100, 10, [&](size_t b, size_t e) { total += e - b; });
+      }
+    });
+    REQUIRE(total == 100 * 64 * 63 / 2);
+  }
+
+  SECTION("Exceptions reach the caller") {
+    std::atomic<size_t> done {0};
+    REQUIRE_THROWS_AS(pool.ForRange(1000, 1, [&](size_t begin, size_t end) {
+      if (begin <= 500 && 500 < end) throw std::runtime_error("failed");
+      done += end - begin;
+    }), std::runtime_error);
+    REQUIRE(done < 1000);
+    // The pool is still usable.
+    std::atomic<size_t> count {0};
+    pool.ForRange(1000, 1, [&](size_t begin, size_t end) { count += end - begin; });
+    REQUIRE(count == 1000);
+  }
+
+  SECTION("One thread runs on the caller") {
+    ThreadPool single(1);
+    std::thread::id caller = std::this_thread::get_id();
+    single.ForRange(1000, 1, [&](size_t begin, size_t end) {
+      REQUIRE(begin == 0);
+      REQUIRE(end == 1000);
+      REQUIRE(std::this_thread::get_id() == caller);
+    });
+  }
+}
+
+TEST_CASE("Parallel algorithms", "[Parallel]") {
+  std::mt19937 random(7);
+  for (size_t threads : {size_t(1), size_t(3), size_t(4)}) {
+    ThreadPool pool(threads);
+    for (size_t size : {size_t(0), size_t(1), size_t(1000), size_t(40000), size_t(300001)}) {
+      Vector<int> values(size);
+      for (auto& value : values) value = static_cast<int>(random() % 1000) - 500;
+
+      Vector<int64_t> squares;
+      ParallelTransform(values, squares, [](int value) { return int64_t(value) * value; }, pool);
+      REQUIRE(squares.Size() == size);
+      int64_t expected = 0;
+      for (size_t i = 0; i < size; ++i) {
+        REQUIRE(squares[i] == int64_t(values[i]) * values[i]);
+        expected += squares[i];
+      }
+      REQUIRE(ParallelReduce(squares, int64_t(0), std::plus<>(), pool) == expected);
+      REQUIRE(ParallelReduce(values, 7, [](int lhs, int rhs) { return std::max(lhs, rhs); }, pool) ==
+              std::max(7, size == 0 ? 7 : *std::max_element(values.begin(), values.end())));
+
+      Vector<int> doubled = values;
+      ParallelFor(doubled, [](int& value) { value *= 2; }, 0, pool);
+      ParallelFor(size, [&](size_t i) { doubled[i] -= values[i]; }, 1, pool);
+      REQUIRE(std::equal(doubled.begin(), doubled.end(), values.begin(), values.end()));
+
+      std::vector<int> sorted(values.begin(), values.end());
+      std::sort(sorted.begin(), sorted.end());
+      ParallelSort(values, std::less<>(), pool);
+      REQUIRE(std::equal(values.begin(), values.end(), sorted.begin(), sorted.end()));
+      ParallelSort(values, std::greater<>(), pool);
+      REQUIRE(std::is_sorted(values.begin(), values.end(), std::greater<>()));
+    }
+  }
+
+  Vector<std::string> words;
+  for (int i = 0; i < 50000; ++i) words.PushBack(std::to_string((i * 7919) % 50000));
+  ThreadPool pool(4);
+  ParallelSort(words, std::less<>(), pool);
+  REQUIRE(std::is_sorted(words.begin(), words.end()));
+  REQUIRE(words[0] == "0");
+  REQUIRE(words[49999] == "9999");
+}
+
+namespace {
+
+std::atomic<int> live {0};
+
+// No default constructor; counts the objects alive, so that a leak or a double destroy shows.
+struct Boxed {
+  explicit Boxed(int value): value(value) { ++live; }
+  Boxed(const Boxed& other): value(other.value) { ++live; }
+  Boxed(Boxed&& other) noexcept: value(other.value) { ++live; }
+  Boxed& operator=(const Boxed&) = default;
+  Boxed& operator=(Boxed&&) = default;
+  ~Boxed() { --live; }
+  int value;
+};
+
+}  // namespace
+
+TEST_CASE("Parallel algorithms construct in place", "[Parallel]") {
+  ThreadPool pool(4);
+  Vector<int> values(100000);
+  for (size_t i = 0; i < values.Size(); ++i) values[i] = static_cast<int>((i * 7919) % values.Size());
+
+  {
+    Vector<Boxed> boxed;
+    boxed.PushBack(Boxed(-1));
+    ParallelTransform(values, boxed, [](int value) { return Boxed(value); }, pool);
+    REQUIRE(boxed.Size() == values.Size());
+    REQUIRE(live == int(values.Size()));
+    for (size_t i = 0; i < values.Size(); ++i) REQUIRE(boxed[i].value == values[i]);
+
+    ParallelSort(boxed, [](const Boxed& lhs, const Boxed& rhs) { return lhs.value < rhs.value; }, pool);
+    REQUIRE(live == int(values.Size()));
+    for (size_t i = 0; i < boxed.Size(); ++i) REQUIRE(boxed[i].value == int(i));
+
+    REQUIRE_THROWS_AS(ParallelTransform(values, boxed, [](int value) {
+      if (value == 77777) throw std::runtime_error("op");
+      return Boxed(value);
+    }, pool), std::runtime_error);
+    REQUIRE(boxed.Empty());
+    REQUIRE(live == 0);
+
+    // The number of comparisons does not depend on the schedule, so a throw after calls - skip
+    // of them lands in a merge round for the larger skips: the first, whose output is raw memory,
+    // or the last.
+    std::atomic<size_t> calls {0}, limit {SIZE_MAX};
+    auto comp = [&](const Boxed& lhs, const Boxed& rhs) {
+      if (++calls > limit) throw std::runtime_error("comp");
+      return lhs.value > rhs.value;
+    };
+    ParallelTransform(values, boxed, [](int value) { return Boxed(value); }, pool);
+    ParallelSort(boxed, comp, pool);
+    size_t total = calls;
+    for (size_t skip : {size_t(1000), size_t(60000), size_t(120000), size_t(180000), total / 2}) {
+      ParallelTransform(values, boxed, [](int value) { return Boxed(value); }, pool);
+      calls = 0;
+      limit = total - skip;
+      REQUIRE_THROWS_AS(ParallelSort(boxed, comp, pool), std::runtime_error);
+      limit = SIZE_MAX;
+      REQUIRE(live == int(boxed.Size()));
+    }
+    std::sort(boxed.begin(), boxed.end(), [](const Boxed& lhs, const Boxed& rhs) { return lhs.value < rhs.value; });
+    for (size_t i = 0; i < boxed.Size(); ++i) REQUIRE(boxed[i].value == int(i));
+  }
+  REQUIRE(live == 0);
+
+  Vector<int> copy = values;
+  ParallelTransform(copy, copy, [](int value) { return value + 1; }, pool);
+  for (size_t i = 0; i < values.Size(); ++i) REQUIRE(copy[i] == values[i] + 1);
+}
@@ -0,0 +1,130 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace {
+
+// The pool whose worker runs on this thread, and the worker's slot.
+thread_local const ThreadPool *CurrentPool = nullptr;
+thread_local size_t CurrentSlot = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads)
+	: Queues_(threads != 0 ? threads : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+	for (size_t self = 1; self < Queues_.size(); ++self)
+		Workers_.emplace_back([this, self] { WorkerLoop(self); });
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(SleepMutex_);
+		Stop_ = true;
+	}
+	Wake_.notify_all();
+	for (auto& worker : Workers_) worker.join();
+}
+
+ThreadPool& ThreadPool::Default() {
+	static ThreadPool pool;
+	return pool;
+}
+
+size_t ThreadPool::Self() const {
+	return CurrentPool == this ? CurrentSlot : 0;
+}
+
+void ThreadPool::Push(size_t self, Task task) {
+	{
+		std::lock_guard<std::mutex> lock(Queues_[self].Mutex);
+		Queues_[self].Tasks.push_back(std::move(task));
+	}
+	Queued_.fetch_add(1);
+	// A worker checks Queued_ under SleepMutex_ before it sleeps: taking the mutex here makes sure
+	// it either sees the new task or is already waiting for the notification.
+	{ std::lock_guard<std::mutex> lock(SleepMutex_); }
+	Wake_.notify_one();
+}
+
+bool ThreadPool::OwnQueueEmpty(size_t self) {
+	std::lock_guard<std::mutex> lock(Queues_[self].Mutex);
+	return Queues_[self].Tasks.empty();
+}
+
+bool ThreadPool::RunOne(size_t self) {
+	if (Queued_.load(std::memory_order_relaxed) == 0) return false;
+	Task task;
+	size_t threads = Threads();
+	for (size_t i = 0; i < threads && !task; ++i) {
+		Queue& queue = Queues_[(self + i) % threads];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (queue.Tasks.empty()) continue;
+		if (i == 0) {
+			task = std::move(queue.Tasks.back());
+			queue.Tasks.pop_back();
+		} else {
+			task = std::move(queue.Tasks.front());
+			queue.Tasks.pop_front();
+		}
+	}
+	if (!task) return false;
+	Queued_.fetch_sub(1);
+	task();
+	return true;
+}
+
+void ThreadPool::WorkerLoop(size_t self) {
+	CurrentPool = this;
+	CurrentSlot = self;
+	while (true) {
+		if (RunOne(self)) continue;
+		std::unique_lock<std::mutex> lock(SleepMutex_);
+		Wake_.wait(lock, [&] { return Stop_ || Queued_.load() != 0; });
+		if (Stop_) return;
+	}
+}
+
+void ThreadPool::RunRange(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body, Group& group) {
+	size_t self = Self();
+	try {
+		while (begin < end) {
+			if (end - begin > grain && OwnQueueEmpty(self)) {
+				size_t middle = begin + (end - begin) / 2;
+				group.Pending.fetch_add(1);
+				try {
+					Push(self, [this, middle, end, grain, &body, &group] {
+						RunRange(middle, end, grain, body, group);
+						group.Pending.fetch_sub(1, std::memory_order_release);
+					});
+				} catch (...) {
+					group.Pending.fetch_sub(1);
+					throw;
+				}
+				end = middle;
+				continue;
+			}
+			size_t step = end - begin > grain ? begin + grain : end;
+			body(begin, step);
+			begin = step;
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(group.Mutex);
+		if (!group.Error) group.Error = std::current_exception();
+	}
+}
+
+void ThreadPool::ForRange(size_t size, size_t grain, const std::function<void(size_t, size_t)>& body) {
+	if (size == 0) return;
+	if (grain == 0) grain = std::max<size_t>(size / (8 * Threads()), 1);
+	if (Threads() == 1 || size <= grain) {
+		body(0, size);
+		return;
+	}
+	Group group;
+	RunRange(0, size, grain, body, group);
+	// The ranges given away may still run elsewhere: help with any task meanwhile, which also
+	// keeps nested calls from waiting on each other.
+	size_t self = Self();
+	while (group.Pending.load(std::memory_order_acquire) != 0)
+		if (!RunOne(self)) std::this_thread::yield();
+	if (group.Error) std::rethrow_exception(group.Error);
+}
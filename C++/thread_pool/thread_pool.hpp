@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run tasks from per-thread deques with work stealing: a thread pushes
+// and pops its own tasks at the back (the most recent, still in its cache) and, when it has none,
+// steals the oldest task from the front of another thread's deque. Idle threads sleep.
+// A pool of N threads starts N - 1 workers: the thread that calls ForRange runs tasks too while
+// it waits, so a pool of one thread runs everything on the caller, and calls may nest.
+class ThreadPool {
+public:
+	// threads = 0 is one per hardware thread.
+	explicit ThreadPool(size_t threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator= (const ThreadPool&) = delete;
+
+	size_t Threads() const { return Queues_.size(); };
+
+	// Runs body(begin, end) on disjoint ranges that cover [0, size) and returns when all are
+	// done. The range is split lazily: a thread halves what it has left only while its own deque
+	// is empty, that is, while the halves it gave away have been stolen, and otherwise runs grain
+	// items at a time. So a balanced loop is cut into about as many pieces as there are threads,
+	// and an unbalanced one keeps being split where the work is. grain = 0 picks one from size.
+	// The first exception thrown by body is rethrown here, after the other ranges are done.
+	void ForRange(size_t size, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+	// Shared by the parallel algorithms; one thread per hardware thread.
+	static ThreadPool& Default();
+
+private:
+	using Task = std::function<void()>;
+
+	struct alignas(64) Queue {
+		std::mutex Mutex;
+		std::deque<Task> Tasks;
+	};
+
+	// One ForRange call: the tasks it has given away and not yet finished.
+	struct Group {
+		std::atomic<size_t> Pending {0};
+		std::mutex Mutex;
+		std::exception_ptr Error;
+	};
+
+	// Slot 0 is shared by the threads outside the pool, slot i > 0 belongs to worker i.
+	std::vector<Queue> Queues_;
+	std::vector<std::thread> Workers_;
+	std::atomic<size_t> Queued_ {0};
+	std::mutex SleepMutex_;
+	std::condition_variable Wake_;
+	bool Stop_ = false;
+
+	size_t Self() const;
+	void Push(size_t self, Task task);
+	bool OwnQueueEmpty(size_t self);
+	// Runs one task: the newest of self's deque, or the oldest one stolen from another.
+	bool RunOne(size_t self);
+	void WorkerLoop(size_t self);
+	void RunRange(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body, Group& group);
+};
@@ -1,16 +1,146 @@
 #pragma once
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
 #include <utility>
 #include <stdexcept>
 #include <iterator>
 #include <functional>
 #include <type_traits>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+// Types whose objects can be moved to another address by copying their bytes, after which the
+// old bytes are simply dropped: no move constructor and no destructor run. Trivially copyable
+// types are; a type that holds no pointers into itself (a handle to heap memory, for example)
+// can opt in with a specialization:
+//   template <> struct IsTriviallyRelocatable<Handle> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+namespace vector_detail {
+
+// A pointer with the interface of std::contiguous_iterator: the standard algorithms and ranges
+// see contiguous memory, so copies become memmove and loops vectorize as over raw pointers.
+template <typename T, bool IsConst>
+class ContiguousIterator {
+public:
+    using iterator_concept = std::contiguous_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using element_type = std::conditional_t<IsConst, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = element_type*;
+    using reference = element_type&;
+
+    ContiguousIterator() = default;
+    ContiguousIterator(pointer ptr): ptr(ptr) {}
+    // Iterator converts to ConstIterator.
+    template <bool OtherConst> requires (IsConst && !OtherConst)
+    ContiguousIterator(const ContiguousIterator<T, OtherConst>& other): ptr(other.ptr) {}
+
+    reference operator*() const { return *ptr; }
+    pointer operator->() const { return ptr; }
+    reference operator[](difference_type num) const { return ptr[num]; }
+
+    ContiguousIterator& operator++() {
+        ++ptr;
+        return *this;
+    }
+    ContiguousIterator operator++(int) {
+        ContiguousIterator copy = *this;
+        ++ptr;
+        return copy;
+    }
+    ContiguousIterator& operator--() {
+        --ptr;
+        return *this;
+    }
+    ContiguousIterator operator--(int) {
+        ContiguousIterator copy = *this;
+        --ptr;
+        return copy;
+    }
+    ContiguousIterator& operator+=(difference_type num) {
+        ptr += num;
+        return *this;
+    }
+    ContiguousIterator& operator-=(difference_type num) {
+        ptr -= num;
+        return *this;
+    }
+    friend ContiguousIterator operator+(ContiguousIterator it, difference_type num) { return it += num; }
+    friend ContiguousIterator operator+(difference_type num, ContiguousIterator it) { return it += num; }
+    friend ContiguousIterator operator-(ContiguousIterator it, difference_type num) { return it -= num; }
+    friend difference_type operator-(const ContiguousIterator& lhs, const ContiguousIterator& rhs) { return lhs.ptr - rhs.ptr; }
+
+    bool operator==(const ContiguousIterator& other) const = default;
+    auto operator<=>(const ContiguousIterator& other) const = default;
+
+private:
+    pointer ptr = nullptr;
+
+    friend class ContiguousIterator<T, true>;
+};
+
+// Constructs count elements in the raw buffer to from the ones of from, moved if that cannot throw
+// and copied otherwise. If a constructor throws, the elements built so far are destroyed and from
+// is untouched.
 template <typename T>
+void MoveIfNoexcept(T* from, size_t count, T* to) {
+    size_t index = 0;
+    try {
+        for (; index < count; ++index) new(to + index) T(std::move_if_noexcept(from[index]));
+    } catch (...) {
+        for (size_t i = 0; i < index; ++i) to[i].~T();
+        throw;
+    }
+}
+
+// Moves count elements from the buffer from to the raw buffer to and ends their lifetime in
+// from. One memcpy for trivially relocatable types; otherwise each element is move-constructed
+// and destroyed in the same pass when the move cannot throw, and copied when it can (as
+// std::move_if_noexcept does), so that a throw leaves from untouched.
+template <typename T>
+void Relocate(T* from, size_t count, T* to) {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (count != 0) std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), sizeof(T) * count);
+    } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+        for (size_t index = 0; index < count; ++index) {
+            new(to + index) T(std::move(from[index]));
+            from[index].~T();
+        }
+    } else {
+        MoveIfNoexcept(from, count, to);
+        for (size_t index = 0; index < count; ++index) from[index].~T();
+    }
+}
+
+}  // namespace vector_detail
+
+// Dynamic array whose buffer comes from Allocator. Vector uses the global heap; PmrVector takes
+// a std::pmr::memory_resource, so that the vectors of one request can live in an arena that is
+// dropped at once:
+//   std::pmr::monotonic_buffer_resource arena;
+//   PmrVector<int> ids(&arena);
+// The allocator provides memory only: elements are constructed in place without it, so the
+// elements of a PmrVector of PmrString take their own allocator.
+template <typename T, typename Allocator = std::allocator<T>>
 class Vector {
+    using Traits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename Traits::value_type, T>, "Vector needs an allocator of T");
+
     T* data = nullptr;
     size_t size = 0;
     size_t capacity = 0;
+    // Takes no space for stateless allocators, so Vector stays three words.
+    [[no_unique_address]] Allocator allocator;
 public: 
     using ValueType = T;
+    using AllocatorType = Allocator;
     using Pointer = T*;
     using ConstPointer = const T*;
     using Reference = T&;
@@ -18,52 +148,12 @@ public:
     using SizeType = size_t;
     
     template <bool IsConst>
-    struct UniversalIterator : public std::iterator<
-                        std::random_access_iterator_tag,   
-                        T,                     
-                        long,                      
-                        std::conditional_t<IsConst, const T*, T*>,               
-                        std::conditional_t<IsConst, const T&, T&> >
-    {
-    private:
-        std::conditional_t<IsConst, const T*, T*> ptr = nullptr;
-    public:
-        UniversalIterator(const std::conditional_t<IsConst, const T*, T*>& ptr): ptr(ptr) {}
-        UniversalIterator(std::conditional_t<IsConst, const T*, T*>&& ptr): ptr(std::move(ptr)) {}
-        UniversalIterator(std::move_iterator<UniversalIterator<IsConst>>&& other): ptr(std::move(other.ptr)) {}
-
-        std::conditional_t<IsConst, const T&, T&> operator*() const { return *ptr; }
-        std::conditional_t<IsConst, const T*, T*> operator->() const { return ptr; }
-        bool operator!=(const UniversalIterator& other) const { return other.ptr != ptr; }
-        bool operator==(const UniversalIterator& other) const { return other.ptr == ptr; }
-        UniversalIterator& operator+(long int num) { 
-            ptr += num;
-            return *this; 
-        }
-        UniversalIterator& operator-(long int num) { 
-            ptr -= num;
-            return *this; 
-        }
-        UniversalIterator operator-(long int num) const { 
-            UniversalIterator copy = *this;
-            copy.ptr -= num;
-            return copy; 
-        }
-        UniversalIterator& operator--() { 
-            --ptr;
-            return *this; 
-        }
-        UniversalIterator& operator++() {
-            ++ptr;
-            return *this;
-        } 
-        size_t distance(UniversalIterator& other) { return other.ptr - ptr; }
-    };
+    using UniversalIterator = vector_detail::ContiguousIterator<T, IsConst>;
 
     using Iterator = UniversalIterator<false>;
     using ConstIterator = UniversalIterator<true>;
-    using ReverseIterator = std::reverse_iterator<Vector<T>::Iterator>;
-    using ConstReverseIterator = std::reverse_iterator<Vector<T>::ConstIterator>;
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+    using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
 
     ConstIterator begin() const { return ConstIterator(data); }
     ConstIterator end() const { return ConstIterator(data + size); }
@@ -79,20 +169,12 @@ public:
     ConstReverseIterator crbegin() const { return ConstReverseIterator(data + size); }
     ConstReverseIterator crend() const { return ConstReverseIterator(data); }
     
-    Vector(ConstIterator start, ConstIterator end): size(start.distance(end)), capacity(size) {
-        if (start != end) {
-            data = static_cast<T*>(operator new(sizeof(T) * capacity));;
-            for (size_t index = 0; index < capacity; ++index) {
-                new(data + index) T(std::move(*(start)));
-                ++start;
-            }
-        }
-    }
-    template <typename Iter>
-    Vector(Iter start, Iter end): size(std::distance(start, end)), capacity(size) 
+    template <std::input_iterator Iter>
+    Vector(Iter start, Iter end, const Allocator& alloc = Allocator())
+        : size(std::distance(start, end)), capacity(size), allocator(alloc)
     { 
         if (start != end) {
-            data = static_cast<T*>(operator new(sizeof(T) * capacity));
+            data = Allocate(capacity);
             size_t index = 0;
             try {
                 for (; index < capacity; ++index) {
@@ -101,7 +183,7 @@ public:
                 } 
             } catch (...) {
                 for (size_t i = 0; i < index; ++i) data[i].~T();
-                operator delete(data);
+                Deallocate(data, capacity);
                 size = 0;
                 capacity = 0;
                 data = nullptr;
@@ -111,10 +193,11 @@ public:
     }
     template <typename U>
     Vector(std::move_iterator<U>&& start, 
-           std::move_iterator<U>&& end): size(std::distance(start, end)), capacity(size) 
+           std::move_iterator<U>&& end, const Allocator& alloc = Allocator())
+        : size(std::distance(start, end)), capacity(size), allocator(alloc)
     { 
         if (start != end) {
-            data = static_cast<T*>(operator new(sizeof(T) * capacity));
+            data = Allocate(capacity);
             for (size_t index = 0; index < capacity; ++index) {
                 new(data + index) T(std::move(*(start)));
                 ++start;
@@ -123,9 +206,10 @@ public:
     }
 
     Vector() = default;
-    Vector(size_t num): size(num), capacity(num) {
+    explicit Vector(const Allocator& alloc): allocator(alloc) {}
+    Vector(size_t num, const Allocator& alloc = Allocator()): size(num), capacity(num), allocator(alloc) {
         if (num == 0) return;
-        data = static_cast<T*>(operator new(sizeof(T) * num));
+        data = Allocate(num);
         size_t index = 0;
         try {
             for (; index < num; ++index) {
@@ -133,32 +217,34 @@ public:
             }
         } catch (...) {
             for (size_t i = 0; i < index; ++i) data[i].~T();
-            operator delete(data);
+            Deallocate(data, capacity);
             size = 0;
             capacity = 0;
             data = nullptr;
             throw;
         }
     }
-    Vector(int num, const T& object): size(num), capacity(num) {
+    Vector(int num, const T& object, const Allocator& alloc = Allocator())
+        : size(num), capacity(num), allocator(alloc) {
         if (num == 0) return;
-        data = static_cast<T*>(operator new(sizeof(T) * num));
+        data = Allocate(num);
         int index = 0;
         try {
             for (; index < num; ++index) 
-                new(data + index) T(std::move(object));
+                new(data + index) T(object);
         } catch (...) {
             for (int i = 0; i < index; ++i) data[i].~T();
-            operator delete(data);
+            Deallocate(data, capacity);
             size = 0;
             capacity = 0;
             data = nullptr;
             throw;
         }
     }
-    Vector(std::initializer_list<T> init_list): size(init_list.size()), capacity(init_list.size()) {
+    Vector(std::initializer_list<T> init_list, const Allocator& alloc = Allocator())
+        : size(init_list.size()), capacity(init_list.size()), allocator(alloc) {
         if (init_list.size() == 0) return;
-        data = static_cast<T*>(operator new(sizeof(T) * init_list.size()));
+        data = Allocate(init_list.size());
         size_t index = 0;
         auto it = init_list.begin();
         try {
@@ -166,7 +252,7 @@ public:
                 new(data + index) T(*it);
         } catch (...) {
             for (size_t i = 0; i < index; ++i) data[i].~T();
-                operator delete(data);
+                Deallocate(data, capacity);
                 size = 0;
                 capacity = 0;
                 data = nullptr;
@@ -174,42 +260,81 @@ public:
         }
 
     }
-    Vector(const Vector& other): size(other.size), capacity(other.capacity) {
+    Vector(const Vector& other): Vector(other, Traits::select_on_container_copy_construction(other.allocator)) {}
+    Vector(const Vector& other, const Allocator& alloc): size(other.size), capacity(other.size), allocator(alloc) {
         if (size == 0) return;
-        data = static_cast<T*>(operator new(sizeof(T) * size));
+        data = Allocate(size);
         size_t index = 0;
         try {
             for (; index < size; ++index) new(data + index) T(other[index]);
         } catch (...) {
             for (size_t i = 0; i < index; ++i) data[i].~T();
-                operator delete(data);
+                Deallocate(data, capacity);
                 size = 0;
                 capacity = 0;
                 data = nullptr;
                 throw;
         }
     }
-    Vector(Vector&& other): data(other.data), size(other.size), capacity(other.capacity) {
+    Vector(Vector&& other) noexcept
+        : data(other.data), size(other.size), capacity(other.capacity), allocator(std::move(other.allocator)) {
         other.size = 0;
         other.capacity = 0;
         other.data = nullptr;
     }
+    // Takes the buffer only if alloc can free it, and otherwise relocates the elements into a
+    // buffer of its own, which leaves other empty.
+    Vector(Vector&& other, const Allocator& alloc): allocator(alloc) {
+        if (allocator == other.allocator) {
+            SwapBuffers(other);
+        } else if (other.size != 0) {
+            data = Allocate(other.size);
+            try {
+                vector_detail::Relocate(other.data, other.size, data);
+            } catch (...) {
+                Deallocate(data, other.size);
+                data = nullptr;
+                throw;
+            }
+            size = capacity = other.size;
+            other.size = 0;
+        }
+    }
     Vector& operator=(const Vector& other) {
-        Vector copy = other;
-        this->Swap(copy);
+        if (this == &other) return *this;
+        if constexpr (Traits::propagate_on_container_copy_assignment::value) {
+            Vector copy(other, other.allocator);
+            SwapBuffers(copy);
+            std::swap(allocator, copy.allocator);
+        } else {
+            Vector copy(other, allocator);
+            SwapBuffers(copy);
+        }
         return *this;
     }
-    Vector& operator=(Vector&& other) {
-        Vector copy = std::move(other);
-        Swap(copy);
+    // Allocators that stay with the object (as the pmr one does) only let the buffer be taken
+    // over when they are equal; otherwise the elements are moved one by one.
+    Vector& operator=(Vector&& other) noexcept(
+        Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+        if (this == &other) return *this;
+        if constexpr (Traits::propagate_on_container_move_assignment::value) {
+            Vector moved = std::move(other);
+            SwapBuffers(moved);
+            std::swap(allocator, moved.allocator);
+        } else {
+            Vector moved(std::move(other), allocator);
+            SwapBuffers(moved);
+        }
         return *this;
     }
 
+    // Allocators are exchanged only if they propagate on swap; otherwise they have to be equal.
     void Swap(Vector &other) {
-        std::swap(other.size, size);
-        std::swap(other.capacity, capacity);
-        std::swap(other.data, data);
+        SwapBuffers(other);
+        if constexpr (Traits::propagate_on_container_swap::value)
+            std::swap(allocator, other.allocator);
     }
+    Allocator GetAllocator() const { return allocator; }
     size_t Size() const { return size; }
     size_t Capacity() const { return capacity; }
     T* Data() { return data; }
@@ -244,25 +369,23 @@ public:
             size = count;
         }
         else if (count <= capacity) {
+            // A local pointer: stores of a char T could otherwise alias data and reload it every step.
+            T* new_data = data;
             for (size_t index = size; index < count; ++index)
-                new(data + index) T(std::move(value));
+                new(new_data + index) T(value);
             size = count;
         } else {
-            T* new_data = static_cast<T*>(operator new(sizeof(T) * count));
-            size_t index = 0;
+            T* new_data = Allocate(count);
+            size_t index = size;
             try {
-                for (; index < size; ++index) new(new_data + index) T(); 
-                for (; index < count; ++index) new(new_data + index) T(std::move(value));
+                for (; index < count; ++index) new(new_data + index) T(value);
+                vector_detail::Relocate(data, size, new_data);
             } catch (...) {
-                for (size_t i = 0; i < index; ++i) new_data[i].~T();
-                operator delete(new_data);
+                for (size_t i = size; i < index; ++i) new_data[i].~T();
+                Deallocate(new_data, count);
                 throw;
             }
-            for (size_t index = 0; index < size; ++index) {
-                new_data[index] = std::move(data[index]);
-                data[index].~T();
-            }
-            operator delete(data);
+            Deallocate(data, capacity);
             data = new_data;
             size = count;
             capacity = count;
@@ -270,22 +393,14 @@ public:
     }
     void Reserve(size_t new_capacity) {
         if (new_capacity <= capacity) return;
-        T* new_data = static_cast<T*>(operator new(sizeof(T) * new_capacity));
-        size_t index = 0;
+        T* new_data = Allocate(new_capacity);
         try {
-            for (; index < size; ++index) {
-                new(new_data + index) T();
-            }
+            vector_detail::Relocate(data, size, new_data);
         } catch (...) {
-            for (size_t i = 0; i < index; ++i) new_data[i].~T();
-                operator delete(new_data);
+            Deallocate(new_data, new_capacity);
             throw;
         }
-        for (size_t index = 0; index < size; ++index) {
-                new_data[index] = std::move(data[index]);
-                data[index].~T();
-        }
-        operator delete(data);
+        Deallocate(data, capacity);
         data = new_data;
         capacity = new_capacity;
     }
@@ -294,48 +409,26 @@ public:
         if (size == 0) {
             for (size_t index = 0; index < size; ++index) 
             data[index].~T();
-            if (capacity != 0) operator delete(data);
+            Deallocate(data, capacity);
             data = nullptr;
             capacity = 0;
             size = 0;
             return;
         }
-        T* new_data = static_cast<T*>(operator new(sizeof(T) * size));
-        size_t index = 0;
+        T* new_data = Allocate(size);
         try {
-            for (; index < size; ++index)
-                new(new_data + index) T(std::move(data[index]));
+            vector_detail::Relocate(data, size, new_data);
         } catch (...) {
-            for (size_t i = 0; i < index; ++i) new_data[i].~T();
-                operator delete(new_data);
+            Deallocate(new_data, size);
             throw;
         }
-        for (size_t index = 0; index < size; ++index) 
-                data[index].~T();
-        operator delete(data);
+        Deallocate(data, capacity);
         data = new_data;
         capacity = size;
     }
 
-    void PushBack(const T& value) {
-        if (size >= capacity) {
-            this->Reserve(capacity * 2 + 1);
-        }
-        try {
-            new(data + size) T(value);
-            ++size;
-        } catch (...) {
-            data[size].~T();
-            throw;
-        }
-    }
-    void PushBack(T&& value) {
-        if (size >= capacity) {
-            this->Reserve(capacity * 2 + 1);
-        }
-        new(data + size) T(std::move(value));
-        ++size;
-    }
+    void PushBack(const T& value) { EmplaceBack(value); }
+    void PushBack(T&& value) { EmplaceBack(std::move(value)); }
     void PopBack() {
         data[size - 1].~T();
         --size;
@@ -343,15 +436,213 @@ public:
     template<typename ...Args>
     void EmplaceBack(Args&& ...args){
         if (size >= capacity) {
-            this->Reserve(capacity * 2 + 1);
+            GrowAndEmplace(std::forward<Args>(args)...);
+            return;
         }
         new(data + size) T(std::forward<Args>(args)...);
         ++size;
     }
 
+    // The range operations below grow the buffer at most once, move the elements with memmove
+    // when T is trivially relocatable, and give the strong exception guarantee: if an element
+    // constructor throws, the vector is left as it was. The inserted elements may come from this
+    // vector itself.
+    // Returns an iterator to the first inserted element.
+    template <std::input_iterator Iter>
+    Iterator Insert(ConstIterator pos, Iter first, Iter last) {
+        size_t index = pos - cbegin();
+        if constexpr (!std::forward_iterator<Iter>) {
+            // One pass only: the elements are collected first to learn how many there are.
+            Vector buffered(allocator);
+            for (; first != last; ++first) buffered.EmplaceBack(*first);
+            return InsertWith(index, buffered.size, false, [&](T* to) {
+                vector_detail::MoveIfNoexcept(buffered.data, buffered.size, to);
+            });
+        } else if constexpr (std::contiguous_iterator<Iter> && std::is_same_v<std::iter_value_t<Iter>, T>) {
+            // A pointer range: copied with memmove for trivially copyable T.
+            size_t count = std::ranges::distance(first, last);
+            const T* source = std::to_address(first);
+            return InsertWith(index, count, Overlaps(source, source + count), [&](T* to) {
+                std::uninitialized_copy(source, source + count, to);
+            });
+        } else {
+            return InsertWith(index, std::ranges::distance(first, last), true, [&](T* to) {
+                std::uninitialized_copy(first, last, to);
+            });
+        }
+    }
+    Iterator Insert(ConstIterator pos, size_t count, const T& value) {
+        return InsertWith(pos - cbegin(), count, Overlaps(&value, &value + 1), [&](T* to) {
+            std::uninitialized_fill_n(to, count, value);
+        });
+    }
+    Iterator Insert(ConstIterator pos, const T& value) { return Insert(pos, 1, value); }
+
+    // Returns an iterator to the element that followed the erased ones.
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        size_t from = first - cbegin(), to = last - cbegin();
+        if (from == to) return Iterator(data + from);
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            for (size_t index = from; index < to; ++index) data[index].~T();
+            if (to != size) std::memmove(static_cast<void*>(data + from), static_cast<const void*>(data + to), sizeof(T) * (size - to));
+        } else {
+            T* end = std::move(data + to, data + size, data + from);
+            for (; end != data + size; ++end) end->~T();
+        }
+        size -= to - from;
+        return Iterator(data + from);
+    }
+    Iterator Erase(ConstIterator pos) { return Erase(pos, pos + 1); }
+
+    template <std::ranges::input_range Range>
+    void Append(Range&& range) {
+        if constexpr (std::ranges::common_range<Range>) {
+            Insert(cend(), std::ranges::begin(range), std::ranges::end(range));
+        } else {
+            auto common = std::views::common(range);
+            Insert(cend(), common.begin(), common.end());
+        }
+    }
+    // Appends count elements that construct(to) builds in the raw memory at to, for a producer
+    // that is not a range: ParallelTransform fills them from several threads. construct has to
+    // destroy what it built before it throws; the vector is then left as it was.
+    template <typename Construct>
+    void AppendWith(size_t count, Construct construct) {
+        InsertWith(size, count, true, construct);
+    }
+    // Replaces the elements with the ones of range. A trivially copyable range that fits in the
+    // capacity is copied in place with one memmove; anything else is built in a new buffer.
+    template <std::ranges::input_range Range>
+    void Assign(Range&& range) {
+        // Measured through the iterators: inside Vector, std::ranges::size and std::ranges::data
+        // would find the private members size and data and trip over them.
+        using Iter = std::ranges::iterator_t<Range>;
+        if constexpr (std::is_trivially_copyable_v<T> && std::ranges::contiguous_range<Range> &&
+                      std::sized_sentinel_for<std::ranges::sentinel_t<Range>, Iter> &&
+                      std::is_same_v<std::ranges::range_value_t<Range>, T>) {
+            Iter first = std::ranges::begin(range);
+            size_t count = std::ranges::end(range) - first;
+            if (count <= capacity) {
+                if (count != 0) std::memmove(static_cast<void*>(data), static_cast<const void*>(std::to_address(first)), sizeof(T) * count);
+                size = count;
+                return;
+            }
+        }
+        Vector assigned(allocator);
+        assigned.Append(std::forward<Range>(range));
+        SwapBuffers(assigned);
+    }
+
     ~Vector() {
         for (size_t index = 0; index < size; ++index) 
             data[index].~T();
-        if (capacity != 0) operator delete(data);
+        Deallocate(data, capacity);
+    }
+
+private:
+    T* Allocate(size_t count) { return Traits::allocate(allocator, count); }
+    void Deallocate(T* buffer, size_t count) {
+        if (buffer != nullptr) Traits::deallocate(allocator, buffer, count);
+    }
+
+    void SwapBuffers(Vector& other) {
+        std::swap(other.size, size);
+        std::swap(other.capacity, capacity);
+        std::swap(other.data, data);
+    }
+
+    // Whether [first, last) shares memory with the elements.
+    bool Overlaps(const T* first, const T* last) const {
+        return first != last && std::less<const T*>()(first, data + size) && std::less<const T*>()(data, last);
+    }
+
+    // Opens a gap of count elements at index and has construct(to) build them in the raw memory at
+    // to; construct destroys what it built if it throws. Unless may_alias is false, construct may
+    // read the elements of this vector, so they only move once it has returned.
+    template <typename Construct>
+    Iterator InsertWith(size_t index, size_t count, bool may_alias, Construct construct) {
+        if (count == 0) return Iterator(data + index);
+        if (size + count <= capacity) {
+            if constexpr (IsTriviallyRelocatable<T>::value) {
+                if (!may_alias) {
+                    size_t tail = sizeof(T) * (size - index);
+                    std::memmove(static_cast<void*>(data + index + count), static_cast<const void*>(data + index), tail);
+                    try {
+                        construct(data + index);
+                    } catch (...) {
+                        std::memmove(static_cast<void*>(data + index), static_cast<const void*>(data + index + count), tail);
+                        throw;
+                    }
+                    size += count;
+                    return Iterator(data + index);
+                }
+            }
+            // Built past the end, then rotated into place: the rotation cannot throw.
+            if (index == size || (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)) {
+                construct(data + size);
+                size += count;
+                std::rotate(data + index, data + size - count, data + size);
+                return Iterator(data + index);
+            }
+        }
+        // A new buffer, also when moving the elements in place could throw halfway.
+        size_t new_capacity = size + count <= capacity ? capacity : std::max(size + count, capacity * 2 + 1);
+        T* new_data = Allocate(new_capacity);
+        try {
+            construct(new_data + index);
+        } catch (...) {
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        if constexpr (IsTriviallyRelocatable<T>::value || std::is_nothrow_move_constructible_v<T>) {
+            vector_detail::Relocate(data, index, new_data);
+            vector_detail::Relocate(data + index, size - index, new_data + index + count);
+        } else {
+            // Copied, both halves before any old element is destroyed.
+            size_t built = 0;
+            try {
+                vector_detail::MoveIfNoexcept(data, index, new_data);
+                built = index;
+                vector_detail::MoveIfNoexcept(data + index, size - index, new_data + index + count);
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) new_data[i].~T();
+                for (size_t i = index; i < index + count; ++i) new_data[i].~T();
+                Deallocate(new_data, new_capacity);
+                throw;
+            }
+            for (size_t i = 0; i < size; ++i) data[i].~T();
+        }
+        Deallocate(data, capacity);
+        data = new_data;
+        size += count;
+        capacity = new_capacity;
+        return Iterator(data + index);
+    }
+
+    // The new element is constructed before the old ones move, since args may refer to one of them.
+    template<typename ...Args>
+    void GrowAndEmplace(Args&& ...args) {
+        size_t new_capacity = capacity * 2 + 1;
+        T* new_data = Allocate(new_capacity);
+        try {
+            new(new_data + size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        try {
+            vector_detail::Relocate(data, size, new_data);
+        } catch (...) {
+            new_data[size].~T();
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        Deallocate(data, capacity);
+        data = new_data;
+        capacity = new_capacity;
+        ++size;
     }
 };
+
+template <typename T>
+using PmrVector = Vector<T, std::pmr::polymorphic_allocator<T>>;